@@ -22,7 +22,7 @@ static std::vector<int16_t> collected_audio;
 #define I2S_SPEAKER_DATA_PIN GPIO_NUM_13
 #define I2S_SPEAKER_BCLK_PIN GPIO_NUM_12
 #define I2S_SPEAKER_WCLK_PIN GPIO_NUM_11
-#define I2S_SPEAKER_SAMPLE_RATE 16000
+#define I2S_SPEAKER_SAMPLE_RATE PICOTTS_SAMPLE_RATE
 
 extern I2SSpeaker* i2sSpeaker;
 void setupSpeakers();
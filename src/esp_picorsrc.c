@@ -20,21 +20,28 @@
 
 static uint16_t esp_pico_load_pi_u16(const char *raw, unsigned offs)
 {
-  uint16_t a = raw[offs];
-  uint16_t b = raw[offs+1];
+  uint16_t a = (uint8_t)raw[offs];
+  uint16_t b = (uint8_t)raw[offs+1];
   return (b << 8 | a);
 }
 
 static uint32_t esp_pico_load_pi_u32(const char *raw, unsigned offs)
 {
-  uint32_t a = raw[offs];
-  uint32_t b = raw[offs+1];
-  uint32_t c = raw[offs+2];
-  uint32_t d = raw[offs+3];
-  return (d << 24 || c << 16 | b << 8 | a);
+  uint32_t a = (uint8_t)raw[offs];
+  uint32_t b = (uint8_t)raw[offs+1];
+  uint32_t c = (uint8_t)raw[offs+2];
+  uint32_t d = (uint8_t)raw[offs+3];
+  return (d << 24 | c << 16 | b << 8 | a);
 }
 
 
+enum {
+  SVOXHDR_OFFS = 0, // first 13 bytes = " (C) SVOX AG " downshifted by 0x20
+  HEADER_LEN_OFFS = 13, // header length read as le u16 after that
+  DATA_OFFS = HEADER_LEN_OFFS + 2,
+};
+
+
 pico_status_t verify_svox_header(const char *raw)
 {
   const char marker[] = " (C) SVOX AG ";
@@ -47,7 +54,41 @@ pico_status_t verify_svox_header(const char *raw)
 }
 
 
-pico_status_t esp_pico_loadResource(pico_System sys, const void *raw, pico_Resource *outResource)
+// Loads a resource in the native format (see picorsrc.h) in place; unless
+// built with PICORSRC_NATIVE_CHECK, that takes no more than reading the kb
+// directory.
+static pico_status_t esp_pico_loadNativeResource(
+  picorsrc_ResourceManager this, picorsrc_Resource res, const void *raw,
+  size_t size)
+{
+  picorsrc_native_header_t header;
+  pico_status_t status = picorsrc_parseNativeHeader(raw, &header);
+  if (status == PICO_OK &&
+      header.dataSize > size - PICORSRC_NATIVE_HEADER_SIZE)
+    status = PICO_EXC_FILE_CORRUPT;
+  if (status != PICO_OK)
+    return picoos_emRaiseException(this->common->em, status, NULL, NULL);
+
+  if (isResourceLoaded(this, header.name))
+    return PICO_WARN_RESOURCE_DOUBLE_LOAD;
+
+  // mapped read-only; the resource only keeps a non-const pointer
+  res->raw_mem = (picoos_uint8 *)raw + PICORSRC_NATIVE_HEADER_SIZE;
+  res->start = res->raw_mem;
+#if (PICORSRC_NATIVE_CHECK > 0)
+  if (picorsrc_nativeChecksum(res->start, header.dataSize) != header.checksum)
+    return picoos_emRaiseException(this->common->em, PICO_EXC_FILE_CORRUPT,
+      NULL, (picoos_char *)"checksum of %s", header.name);
+#endif
+
+  picoos_strlcpy(res->name, header.name, PICORSRC_MAX_RSRC_NAME_SIZ);
+  res->type = (picorsrc_resource_type_t)header.type;
+  return picorsrc_getNativeKbList(
+    this, res->start, header.dataSize, header.numKbs, &res->kbList);
+}
+
+
+pico_status_t esp_pico_loadResource(pico_System sys, const void *raw, size_t size, pico_Resource *outResource)
 {
   picorsrc_Resource *resource = (picorsrc_Resource *)outResource;
   picorsrc_ResourceManager this = sys->rm;
@@ -62,15 +103,40 @@ pico_status_t esp_pico_loadResource(pico_System sys, const void *raw, pico_Resou
       NULL, (picoos_char *)"no more than %i resources", PICO_MAX_NUM_RESOURCES);
   }
 
-  enum {
-    SVOXHDR_OFFS = 0, // first 13 bytes = " (C) SVOX AG " downshifted by 0x20
-    HEADER_LEN_OFFS = 13, // header length read as le u16 after that
-    DATA_OFFS = HEADER_LEN_OFFS + 2,
-  };
-  pico_status_t status = verify_svox_header(raw + SVOXHDR_OFFS);
+  picoos_uint32 pos = 0, magic = 0;
+  if (size >= PICORSRC_NATIVE_HEADER_SIZE)
+    picoos_read_mem_pi_uint32((picoos_uint8 *)raw, &pos, &magic);
+  if (magic == PICORSRC_NATIVE_MAGIC)
+  {
+    pico_status_t status = esp_pico_loadNativeResource(this, res, raw, size);
+    if (status == PICO_OK)
+    {
+      res->next = this->resources;
+      this->resources = res;
+      this->numResources++;
+      *resource = res;
+    }
+    else
+    {
+      res->raw_mem = NULL; // mapped, not allocated
+      picorsrc_disposeResource(this->common->mm, &res);
+    }
+    return status;
+  }
+
+  pico_status_t status = size < DATA_OFFS ?
+    PICO_EXC_FILE_CORRUPT : verify_svox_header(raw + SVOXHDR_OFFS);
+  unsigned hdrlen1 = 0;
+  if (status == PICO_OK)
+  {
+    hdrlen1 = esp_pico_load_pi_u16(raw, HEADER_LEN_OFFS);
+    if (size - DATA_OFFS < hdrlen1 + 4 ||
+        esp_pico_load_pi_u32(raw, DATA_OFFS + hdrlen1) >
+          size - DATA_OFFS - hdrlen1 - 4)
+      status = PICO_EXC_FILE_CORRUPT;
+  }
   if (status != PICO_OK)
     return picoos_emRaiseException(this->common->em, PICO_EXC_FILE_CORRUPT, NULL, NULL);
-  unsigned hdrlen1 = esp_pico_load_pi_u16(raw, HEADER_LEN_OFFS);
 
   const char *data = (const char *)raw + DATA_OFFS;
 
@@ -178,3 +244,31 @@ pico_status_t esp_pico_unloadResource(pico_System sys, pico_Resource *inResource
 
   return PICO_OK;
 }
+
+
+size_t esp_pico_resource_size(const void *raw, size_t *header)
+{
+  size_t dummy;
+  if (!header)
+    header = &dummy;
+  *header = 0;
+
+  picoos_uint32 pos = 0, magic;
+  picoos_read_mem_pi_uint32((picoos_uint8 *)raw, &pos, &magic);
+  if (magic == PICORSRC_NATIVE_MAGIC)
+  {
+    // the header holds the checksum of the data
+    picoos_uint32 dataSize;
+    pos = 12;
+    picoos_read_mem_pi_uint32((picoos_uint8 *)raw, &pos, &dataSize);
+    *header = PICORSRC_NATIVE_HEADER_SIZE;
+    return PICORSRC_NATIVE_HEADER_SIZE + (size_t)dataSize;
+  }
+
+  if (verify_svox_header((const char *)raw + SVOXHDR_OFFS) != PICO_OK)
+    return 0;
+  unsigned hdrlen1 = esp_pico_load_pi_u16(raw, HEADER_LEN_OFFS);
+  *header = DATA_OFFS + hdrlen1 + 4;
+  return *header +
+    (size_t)esp_pico_load_pi_u32((const char *)raw + DATA_OFFS + hdrlen1, 0);
+}
@@ -3,8 +3,13 @@
 
 #include "pico/picorsrc.h"
 
-pico_status_t esp_pico_loadResource(pico_System sys, const void *raw, pico_Resource *resource);
+// Loads the resource at raw, of which size bytes are mapped, in place.
+pico_status_t esp_pico_loadResource(pico_System sys, const void *raw, size_t size, pico_Resource *resource);
 
 pico_status_t esp_pico_unloadResource(pico_System sys, pico_Resource *inResource);
 
+// Returns the bytes of a resource in memory, from its header; 0 if it isn't one.
+// header, if not NULL, is set to the bytes of that header.
+size_t esp_pico_resource_size(const void *raw, size_t *header);
+
 #endif
@@ -4,32 +4,56 @@
  * @author J Mattsson <jmattsson@dius.com.au>
  */
 #include "picotts.h"
+#include "picotts_pack.h"
+#include "picotts_profile.h"
 #include "pico/picoapi.h"
 #include "pico/picoapid.h"
+#include "pico/picoctrl.h"
 #include "esp_picorsrc.h"
 #include "esp_log.h"
 #include "esp_partition.h"
+#if CONFIG_PICOTTS_SNAPSHOT
+#include "picotts_snapshot.h"
+#include "esp_app_desc.h"
+#if !defined(PICOOS_CLEAR_ALLOC)
+#error "CONFIG_PICOTTS_SNAPSHOT needs building with -DPICOOS_CLEAR_ALLOC"
+#endif
+#endif
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 #include <freertos/task.h>
 #include <freertos/semphr.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include <math.h>
 
 // Yep, that's 1.1MB needed by PicoTTS, not counting the resource files which
-// we access directly from flash.
-#define PICO_MEM_SIZE 1100000
+// we access directly from flash: the engine memory, which grows with the
+// optional caches, and about 100KB for the rest. Builds with
+// -DPICOKPDF_PREDECODE need about 2MB more (PSRAM) and set PICO_MEM_SIZE
+// accordingly.
+#if !defined(PICO_MEM_SIZE)
+#define PICO_MEM_SIZE (100000 + PICOCTRL_DEFAULT_ENGINE_SIZE)
+#endif
 
 #define PICOTASK_EXIT  0x0000001u
 
 #define IDLE_WAIT_COUNT 5
 
+// Bytes per line of the flash cache
+#define FLASH_CACHE_LINE 32
+
+// Starts a prompt in the text queue (see picotts_say()); never valid UTF8.
+#define PROMPT_MARK 0xff
+
 static picotts_output_fn outputCb;
 static picotts_error_notify_fn errorCb;
 static picotts_idle_notify_fn idleCb;
 
 static SemaphoreHandle_t exitLock;
+// Keeps the bytes of one picotts_add() or picotts_say() together in textQ
+static SemaphoreHandle_t addLock;
 static QueueHandle_t textQ;
 static TaskHandle_t picoTask;
 
@@ -40,22 +64,55 @@ static pico_Resource picoTaResource;
 static pico_Resource picoSgResource;
 static pico_Engine   picoEngine;
 
+// The resources in use, for picotts_prefetch()
+static const void *picoTaBin;
+static const void *picoSgBin;
+
 static const pico_Char voiceName[] = "PicoVoice";
 static const char tag[] = "picotts";
 
+// Pre-rendered prompts, see picotts_set_prompt_pack(). Held by the TTS task
+// while it plays from the pack, so that the pack isn't swapped or unmapped
+// under it.
+static const picotts_pack_header_t *promptPack;
+static esp_partition_mmap_handle_t packMmap;
+static SemaphoreHandle_t packLock;
+
+
+static const void *find_and_map_partition(
+    const char *name, esp_partition_mmap_handle_t *handle, size_t *size);
 
 #ifdef CONFIG_PICOTTS_RESOURCE_MODE_EMBED
 // Embedded resources
 extern const char ta_bin_start[] asm("_binary_picotts_ta_bin_start");
 extern const char sg_bin_start[] asm("_binary_picotts_sg_bin_start");
+extern const char ta_bin_end[] asm("_binary_picotts_ta_bin_end");
+extern const char sg_bin_end[] asm("_binary_picotts_sg_bin_end");
 
 #else
 
 static esp_partition_mmap_handle_t taMmap;
 static esp_partition_mmap_handle_t sgMmap;
 
+static void unmap_partitions(void)
+{
+  if (taMmap)
+  {
+    esp_partition_munmap(taMmap);
+    taMmap = 0;
+  }
+  if (sgMmap)
+  {
+    esp_partition_munmap(sgMmap);
+    sgMmap = 0;
+  }
+}
+#endif
+
+
+// Maps the whole partition; size, if not NULL, is set to its bytes.
 static const void *find_and_map_partition(
-    const char *name, esp_partition_mmap_handle_t *handle)
+    const char *name, esp_partition_mmap_handle_t *handle, size_t *size)
 {
   const esp_partition_t *part =
     esp_partition_find_first(
@@ -72,42 +129,31 @@ static const void *find_and_map_partition(
       part, 0, part->size, ESP_PARTITION_MMAP_DATA, &ptr, handle);
     ESP_ERROR_CHECK_WITHOUT_ABORT(ret);
     ESP_LOGI(tag, "Partition '%s' mmap'd to %p", name, ptr);
+    if (size)
+      *size = part->size;
     return (ret == ESP_OK) ? ptr : NULL;
   }
 }
 
-static void unmap_partitions(void)
-{
-  if (taMmap)
-  {
-    esp_partition_munmap(taMmap);
-    taMmap = 0;
-  }
-  if (sgMmap)
-  {
-    esp_partition_munmap(sgMmap);
-    sgMmap = 0;
-  }
-}
-#endif
-
 
-static const void *find_ta_bin_start()
+static const void *find_ta_bin_start(size_t *size)
 {
 #ifdef CONFIG_PICOTTS_RESOURCE_MODE_EMBED
+  *size = ta_bin_end - ta_bin_start;
   return ta_bin_start;
 #else
-  return find_and_map_partition(CONFIG_PICOTTS_TA_PARTITION, &taMmap);
+  return find_and_map_partition(CONFIG_PICOTTS_TA_PARTITION, &taMmap, size);
 #endif
 }
 
 
-static const void *find_sg_bin_start()
+static const void *find_sg_bin_start(size_t *size)
 {
 #ifdef CONFIG_PICOTTS_RESOURCE_MODE_EMBED
+  *size = sg_bin_end - sg_bin_start;
   return sg_bin_start;
 #else
-  return find_and_map_partition(CONFIG_PICOTTS_SG_PARTITION, &sgMmap);
+  return find_and_map_partition(CONFIG_PICOTTS_SG_PARTITION, &sgMmap, size);
 #endif
 }
 
@@ -119,11 +165,552 @@ picoos_double picoos_quick_exp(const picoos_double y)
 }
 
 
-static void esp_pico_err_print(const char *what, int code)
+// Logs an error of sys, or just its code without a system to describe it
+static void esp_pico_err_print(pico_System sys, const char *what, int code)
 {
   pico_Retstring msg;
-  pico_getSystemStatusMessage(picoSystem, code, msg);
-  ESP_LOGE(tag, "%s (%i): %s", what, code, msg);
+  if (sys && pico_getSystemStatusMessage(sys, code, msg) == PICO_OK)
+    ESP_LOGE(tag, "%s (%i): %s", what, code, msg);
+  else
+    ESP_LOGE(tag, "%s (%i)", what, code);
+}
+
+
+// Sets up the engine in mem, with the resources at ta and sg, which are
+// mapped for taSize and sgSize bytes
+static int esp_pico_setup(
+  void *mem, const void *ta, size_t taSize, const void *sg, size_t sgSize,
+  pico_System *sys, pico_Resource *taRes, pico_Resource *sgRes,
+  pico_Engine *engine)
+{
+  #define PICO_SETUP_CHECK(msg) \
+    if (ret != 0) \
+    { \
+      esp_pico_err_print(*sys, msg, ret); \
+      return ret; \
+    }
+
+  int ret = pico_initialize(mem, PICO_MEM_SIZE, sys);
+  if (ret != 0)
+  {
+    esp_pico_err_print(NULL, "init failed", ret);
+    return ret;
+  }
+
+  ESP_LOGI(tag, "Loading text analysis resource from %p", ta);
+  ret = esp_pico_loadResource(*sys, ta, taSize, taRes);
+  PICO_SETUP_CHECK("Text analysis load failed");
+
+  ESP_LOGI(tag, "Loading signal generator resource from %p", sg);
+  ret = esp_pico_loadResource(*sys, sg, sgSize, sgRes);
+  PICO_SETUP_CHECK("Signal generator load failed");
+
+  ret = pico_createVoiceDefinition(*sys, voiceName);
+  PICO_SETUP_CHECK("Voice creation failed");
+
+  pico_Retstring str;
+
+  ret = pico_getResourceName(*sys, *taRes, str);
+  PICO_SETUP_CHECK("TA resource name error");
+  ret = pico_addResourceToVoiceDefinition(
+    *sys, voiceName, (const pico_Char *)str);
+  PICO_SETUP_CHECK("TA resource add failed");
+
+  ret = pico_getResourceName(*sys, *sgRes, str);
+  PICO_SETUP_CHECK("SG resource name error");
+  ret = pico_addResourceToVoiceDefinition(
+    *sys, voiceName, (const pico_Char *)str);
+  PICO_SETUP_CHECK("SG resource add failed");
+
+  ret = pico_newEngine(*sys, voiceName, engine);
+  PICO_SETUP_CHECK("Engine creation failed");
+
+  #undef PICO_SETUP_CHECK
+  return PICO_OK;
+}
+
+
+#if CONFIG_PICOTTS_SNAPSHOT
+// Handles kept in the snapshot
+enum { ROOT_SYSTEM, ROOT_TA, ROOT_SG, ROOT_ENGINE };
+
+typedef struct
+{
+  const void *ta, *sg;
+  size_t taSize, sgSize;
+  size_t taHeader, sgHeader;  // bytes checked on restore
+  esp_partition_mmap_handle_t taMmap, sgMmap;  // second mapping, pass 1
+  bool ran;    // whether the engine used was set up (pass 0)
+  int status;  // and how that went
+} snapshot_setup_t;
+
+
+static const esp_partition_t *esp_pico_find_partition(const char *name)
+{
+  return esp_partition_find_first(
+    ESP_PARTITION_TYPE_ANY, ESP_PARTITION_SUBTYPE_ANY, name);
+}
+
+
+// Pointers to code are kept in snapshots, so they are only valid for the
+// firmware that made them
+static uint32_t esp_pico_build_id(void)
+{
+  const uint8_t *sha = esp_app_get_description()->app_elf_sha256;
+  return sha[0] | sha[1] << 8 | sha[2] << 16 | (uint32_t)sha[3] << 24;
+}
+
+
+// Bytes of the resources, which the engine may point to anywhere in, out of
+// the taMax and sgMax mapped. Their sizes and headers are checked on
+// restore, so they are the resources themselves rather than the partitions
+// they were flashed to.
+static void esp_pico_snapshot_regions(
+  snapshot_setup_t *setup, size_t taMax, size_t sgMax)
+{
+  setup->taSize = esp_pico_resource_size(setup->ta, &setup->taHeader);
+  setup->sgSize = esp_pico_resource_size(setup->sg, &setup->sgHeader);
+  // a resource claiming to be larger than its partition won't load either
+  if (setup->taSize > taMax)
+    setup->taSize = 0;
+  if (setup->sgSize > sgMax)
+    setup->sgSize = 0;
+}
+
+
+static bool esp_pico_snapshot_setup(
+  picotts_snapshot_state_t *state, int pass, void *ctx)
+{
+  snapshot_setup_t *setup = ctx;
+  const void *ta = setup->ta, *sg = setup->sg;
+  pico_System sys = NULL;
+  pico_Resource taRes, sgRes;
+  pico_Engine engine;
+
+#ifndef CONFIG_PICOTTS_RESOURCE_MODE_EMBED
+  if (pass == 1)
+  {
+    // The partitions mapped again, at other addresses, so that the pointers
+    // into them can be relocated
+    ta = find_and_map_partition(
+      CONFIG_PICOTTS_TA_PARTITION, &setup->taMmap, NULL);
+    sg = find_and_map_partition(
+      CONFIG_PICOTTS_SG_PARTITION, &setup->sgMmap, NULL);
+    if (!ta || !sg)
+      return false;
+  }
+#endif
+  state->region[0] = ta;
+  state->region_size[0] = setup->taSize;
+  state->region_check_size[0] = setup->taHeader;
+  state->region[1] = sg;
+  state->region_size[1] = setup->sgSize;
+  state->region_check_size[1] = setup->sgHeader;
+
+  // The first run sets up the engine used, the second one is thrown away
+  const bool used = (pass == 0);
+  int ret = esp_pico_setup(state->mem, ta, setup->taSize, sg, setup->sgSize,
+    used ? &picoSystem : &sys, used ? &picoTaResource : &taRes,
+    used ? &picoSgResource : &sgRes, used ? &picoEngine : &engine);
+  if (used)
+  {
+    setup->ran = true;
+    setup->status = ret;
+  }
+  if (ret != PICO_OK)
+    return false;
+  state->root[ROOT_SYSTEM] = used ? picoSystem : sys;
+  state->root[ROOT_TA] = used ? picoTaResource : taRes;
+  state->root[ROOT_SG] = used ? picoSgResource : sgRes;
+  state->root[ROOT_ENGINE] = used ? picoEngine : engine;
+  return true;
+}
+
+
+static bool esp_pico_snapshot_write(
+  const void *data, size_t len, size_t offset, void *ctx)
+{
+  const esp_partition_t *part = ctx;
+  return offset + len <= part->size &&
+    esp_partition_write(part, offset, data, len) == ESP_OK;
+}
+
+
+// Sets up the engine from the snapshot, if there is a valid one
+static bool esp_pico_snapshot_restore(
+  const void *ta, size_t taSize, const void *sg, size_t sgSize)
+{
+  const esp_partition_t *part =
+    esp_pico_find_partition(CONFIG_PICOTTS_SNAPSHOT_PARTITION);
+  if (!part)
+    return false;
+  esp_partition_mmap_handle_t mmap;
+  const void *snapshot = find_and_map_partition(
+    CONFIG_PICOTTS_SNAPSHOT_PARTITION, &mmap, NULL);
+  if (!snapshot)
+    return false;
+
+  snapshot_setup_t setup = { .ta = ta, .sg = sg };
+  esp_pico_snapshot_regions(&setup, taSize, sgSize);
+  picotts_snapshot_state_t state = {
+    .mem = picoMemArea,
+    .mem_size = PICO_MEM_SIZE,
+    .region = { ta, sg },
+    .region_size = { setup.taSize, setup.sgSize },
+  };
+  int ret = picotts_snapshot_restore(
+    snapshot, part->size, esp_pico_build_id(), &state);
+  esp_partition_munmap(mmap);
+  if (ret != PICOTTS_SNAPSHOT_OK)
+  {
+    ESP_LOGI(tag, "No snapshot to restore (%i)", ret);
+    return false;
+  }
+  picoSystem = state.root[ROOT_SYSTEM];
+  picoTaResource = state.root[ROOT_TA];
+  picoSgResource = state.root[ROOT_SG];
+  picoEngine = state.root[ROOT_ENGINE];
+  ESP_LOGI(tag, "Engine restored from snapshot");
+  return true;
+}
+
+
+// Sets up the engine and writes a snapshot of it. Without the memory or
+// partition for it the engine is set up as usual.
+static int esp_pico_snapshot_make(
+  const void *ta, size_t taSize, const void *sg, size_t sgSize)
+{
+  const esp_partition_t *part =
+    esp_pico_find_partition(CONFIG_PICOTTS_SNAPSHOT_PARTITION);
+  void *other = part ?
+    aligned_alloc(PICOTTS_SNAPSHOT_MEM_ALIGN, PICO_MEM_SIZE) : NULL;
+  snapshot_setup_t setup = { .ta = ta, .sg = sg };
+  int ret = PICOTTS_SNAPSHOT_ERR_WRITE;
+  if (other && esp_partition_erase_range(part, 0, part->size) == ESP_OK)
+  {
+    esp_pico_snapshot_regions(&setup, taSize, sgSize);
+    picotts_snapshot_state_t a = {
+      .mem = picoMemArea, .mem_size = PICO_MEM_SIZE };
+    picotts_snapshot_state_t b = { .mem = other, .mem_size = PICO_MEM_SIZE };
+    ret = picotts_snapshot_make(&a, &b, esp_pico_snapshot_setup, &setup,
+      esp_pico_build_id(), esp_pico_snapshot_write, (void *)part);
+#ifndef CONFIG_PICOTTS_RESOURCE_MODE_EMBED
+    if (setup.taMmap)
+      esp_partition_munmap(setup.taMmap);
+    if (setup.sgMmap)
+      esp_partition_munmap(setup.sgMmap);
+#endif
+  }
+  free(other);
+
+  if (ret == PICOTTS_SNAPSHOT_OK)
+    ESP_LOGI(tag, "Snapshot written to '%s'",
+      CONFIG_PICOTTS_SNAPSHOT_PARTITION);
+  else
+    ESP_LOGW(tag, "No snapshot made (%i)", ret);
+  if (setup.ran)
+    return setup.status;
+  return esp_pico_setup(picoMemArea, ta, taSize, sg, sgSize,
+    &picoSystem, &picoTaResource, &picoSgResource, &picoEngine);
+}
+#endif
+
+
+// Prompt being received by the TTS task; promptLen is -1 if there is none.
+// One more byte for the terminating zero.
+static uint8_t promptText[CONFIG_PICOTTS_PROMPT_MAX_LEN + 1];
+static int promptLen = -1;
+
+#if CONFIG_PICOTTS_PROMPT_CACHE_SIZE > 0
+// Audio of a spoken prompt; the list is kept in most recently used order.
+typedef struct prompt_entry
+{
+  struct prompt_entry *next;
+  uint32_t hash;
+  unsigned text_len;
+  unsigned count;
+  int16_t *samples;
+  uint8_t text[];
+} prompt_entry_t;
+
+static prompt_entry_t *promptCache;
+static size_t promptCacheUsed;
+
+// Audio captured while synthesising a prompt which is not in the cache,
+// straight into the entry that will keep it. Its allocation counts towards
+// CONFIG_PICOTTS_PROMPT_CACHE_SIZE as the cache's own entries do.
+static prompt_entry_t *captureEntry;
+static size_t captureSize;
+static unsigned captureCount;
+static unsigned captureTextLen;
+static bool capturing;
+
+
+static size_t prompt_entry_size(unsigned text_len, unsigned count)
+{
+  size_t text_size = (sizeof(prompt_entry_t) + text_len + 1) & ~(size_t)1;
+  return text_size + count * sizeof(int16_t);
+}
+
+
+// Evicts the least recently used prompts until another size bytes fit.
+// @returns False if they don't fit even into the empty cache.
+static bool esp_pico_prompt_evict(size_t size)
+{
+  while (promptCache && promptCacheUsed + size > CONFIG_PICOTTS_PROMPT_CACHE_SIZE)
+  {
+    prompt_entry_t **last = &promptCache;
+    while ((*last)->next)
+      last = &(*last)->next;
+    promptCacheUsed -= prompt_entry_size((*last)->text_len, (*last)->count);
+    free(*last);
+    *last = NULL;
+  }
+  return promptCacheUsed + size <= CONFIG_PICOTTS_PROMPT_CACHE_SIZE;
+}
+
+
+static void esp_pico_prompt_capture_start(unsigned text_len)
+{
+  capturing = true;
+  captureCount = 0;
+  captureTextLen = text_len;
+}
+
+
+static void esp_pico_prompt_capture_end(void)
+{
+  capturing = false;
+  free(captureEntry);
+  captureEntry = NULL;
+  captureSize = 0;
+}
+
+
+static void esp_pico_prompt_capture(const int16_t *samples, unsigned count)
+{
+  if (!capturing)
+    return;
+  const size_t need = prompt_entry_size(captureTextLen, captureCount + count);
+  if (need > captureSize)
+  {
+    // grow in steps of a quarter second of audio
+    size_t size = need + PICOTTS_SAMPLE_RATE / 4 * sizeof(int16_t);
+    if (size > CONFIG_PICOTTS_PROMPT_CACHE_SIZE)
+      size = need;
+    prompt_entry_t *e = NULL;
+    if (esp_pico_prompt_evict(size))
+      e = realloc(captureEntry, size);
+    if (!e)
+    {
+      // Too long for the cache (or no memory); say it without keeping it
+      esp_pico_prompt_capture_end();
+      return;
+    }
+    captureEntry = e;
+    captureSize = size;
+  }
+  int16_t *dst = (int16_t *)((uint8_t *)captureEntry +
+    prompt_entry_size(captureTextLen, 0));
+  memcpy(dst + captureCount, samples, count * sizeof(int16_t));
+  captureCount += count;
+}
+
+
+// Moves the captured prompt into the cache.
+static void esp_pico_prompt_insert(const uint8_t *text, uint32_t hash)
+{
+  const size_t size = prompt_entry_size(captureTextLen, captureCount);
+  prompt_entry_t *e = NULL;
+  if (esp_pico_prompt_evict(size))
+    e = realloc(captureEntry, size);
+  if (!e)
+  {
+    esp_pico_prompt_capture_end();
+    return;
+  }
+  captureEntry = NULL;
+  captureSize = 0;
+  capturing = false;
+
+  e->hash = hash;
+  e->text_len = captureTextLen;
+  e->count = captureCount;
+  e->samples = (int16_t *)((uint8_t *)e + prompt_entry_size(captureTextLen, 0));
+  memcpy(e->text, text, captureTextLen);
+  e->next = promptCache;
+  promptCache = e;
+  promptCacheUsed += size;
+}
+
+
+static void esp_pico_prompt_cache_free(void)
+{
+  while (promptCache)
+  {
+    prompt_entry_t *e = promptCache;
+    promptCache = e->next;
+    free(e);
+  }
+  promptCacheUsed = 0;
+  esp_pico_prompt_capture_end();
+}
+#else
+#define esp_pico_prompt_capture(samples, count)
+#endif
+
+
+static int esp_pico_drain(void);
+
+
+// Passes prompt audio to the output callback in blocks, as the engine does.
+static void esp_pico_play(const int16_t *samples, unsigned count)
+{
+  for (unsigned i = 0; i < count; i += 128)
+  {
+    int16_t outbuf[128];
+    unsigned n = (count - i < 128) ? count - i : 128;
+    // copied, since the callback may modify the buffer (and the samples may
+    // be in mapped flash)
+    memcpy(outbuf, samples + i, n * sizeof(int16_t));
+    outputCb(outbuf, n);
+    taskYIELD();
+  }
+}
+
+
+static const picotts_pack_entry_t *esp_pico_pack_find(
+  const uint8_t *text, unsigned len, uint32_t hash)
+{
+  if (!promptPack)
+    return NULL;
+
+  const picotts_pack_entry_t *index =
+    (const picotts_pack_entry_t *)(promptPack + 1);
+  unsigned lo = 0, hi = promptPack->count;
+  while (lo < hi)
+  {
+    unsigned mid = (lo + hi) / 2;
+    if (index[mid].hash < hash)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  for (; lo < promptPack->count && index[lo].hash == hash; ++lo)
+  {
+    if (index[lo].text_len == len &&
+        memcmp((const uint8_t *)promptPack + index[lo].text, text, len) == 0)
+      return &index[lo];
+  }
+  return NULL;
+}
+
+
+// Feeds all of the text to the engine, passing on audio produced meanwhile.
+static int esp_pico_put(const uint8_t *text, unsigned len)
+{
+  while (len)
+  {
+    int16_t processed = 0;
+    int ret = pico_putTextUtf8(picoEngine, text, len, &processed);
+    if (ret)
+      return ret;
+    text += processed;
+    len -= processed;
+    if (!processed)
+    {
+      ret = esp_pico_drain();
+      if (ret != PICO_STEP_IDLE)
+        return ret;
+    }
+  }
+  return 0;
+}
+
+
+// Speaks the prompt in promptText, from the cache if possible. Text from
+// picotts_add() still in the engine is finished first.
+static int esp_pico_say_prompt(void)
+{
+  static const uint8_t end = 0;
+  uint8_t *text = promptText;
+  unsigned len = promptLen;
+  int ret;
+
+  promptLen = -1;
+  ret = esp_pico_put(&end, 1);
+  if (!ret)
+    ret = esp_pico_drain();
+  if (ret != PICO_STEP_IDLE)
+    return ret;
+
+  uint32_t hash = picotts_pack_key(text, &len);
+
+  if (packLock)
+  {
+    xSemaphoreTake(packLock, portMAX_DELAY);
+    const picotts_pack_entry_t *pp = esp_pico_pack_find(text, len, hash);
+    if (pp)
+      esp_pico_play(
+        (const int16_t *)((const uint8_t *)promptPack + pp->samples),
+        pp->count);
+    xSemaphoreGive(packLock);
+    if (pp)
+      return 0;
+  }
+
+#if CONFIG_PICOTTS_PROMPT_CACHE_SIZE > 0
+  prompt_entry_t **pe = &promptCache;
+  while (*pe &&
+         ((*pe)->hash != hash || (*pe)->text_len != len ||
+          memcmp((*pe)->text, text, len) != 0))
+    pe = &(*pe)->next;
+  if (*pe)
+  {
+    prompt_entry_t *e = *pe;
+    *pe = e->next;
+    e->next = promptCache;
+    promptCache = e;
+    esp_pico_play(e->samples, e->count);
+    return 0;
+  }
+
+  esp_pico_prompt_capture_start(len);
+#endif
+  // in one piece, so that the engine can use its frame cache (see
+  // PICOCTRL_FRAME_CACHE_SIZE)
+  text[len] = 0;
+  ret = esp_pico_put(text, len + 1);
+  if (!ret)
+    ret = esp_pico_drain();
+#if CONFIG_PICOTTS_PROMPT_CACHE_SIZE > 0
+  if (ret == PICO_STEP_IDLE && capturing)
+    esp_pico_prompt_insert(text, hash);
+  esp_pico_prompt_capture_end();
+#endif
+  return (ret == PICO_STEP_IDLE) ? 0 : ret;
+}
+
+
+static int esp_pico_drain(void)
+{
+  int status;
+  do {
+    int16_t outbuf[128];
+    int16_t bytes = 0, type = 0;
+    // Note: Only PICO_DATA_PCM_16BIT is defined as output type, so we
+    // don't propagate that information. Rather, it's a fixed property.
+    status =
+      pico_getData(picoEngine, outbuf, sizeof(outbuf), &bytes, &type);
+    if (bytes > 0)
+    {
+      outputCb(outbuf, bytes/2);
+      esp_pico_prompt_capture(outbuf, bytes/2);
+    }
+    // small delay to feed wdt
+    taskYIELD();
+  } while (status == PICO_STEP_BUSY);
+  return status;
 }
 
 
@@ -148,11 +735,36 @@ static void esp_pico_run(void *)
     uint8_t c;
     while (xQueuePeek(textQ, &c, 0) == pdPASS)
     {
+      if (c == PROMPT_MARK || promptLen >= 0)
+      {
+        xQueueReceive(textQ, &c, 0);
+        if (c == PROMPT_MARK)
+          promptLen = 0;
+        else if (c != 0)
+        {
+          if (promptLen < CONFIG_PICOTTS_PROMPT_MAX_LEN)
+            promptText[promptLen++] = c;
+        }
+        else
+        {
+          int ret = esp_pico_say_prompt();
+          if (ret)
+          {
+            esp_pico_err_print(picoSystem, "Prompt failed, stopping TTS", ret);
+            error = true;
+            break;
+          }
+          state = WAITING_FOR_BYTES;
+          idles = 0;
+        }
+        continue;
+      }
+
       int16_t processed = 0;
       int ret = pico_putTextUtf8(picoEngine, &c, 1, &processed);
       if (ret)
       {
-        esp_pico_err_print("Put text failed, stopping TTS", ret);
+        esp_pico_err_print(picoSystem, "Put text failed, stopping TTS", ret);
         error = true;
         break;
       }
@@ -180,22 +792,10 @@ static void esp_pico_run(void *)
         break;
       case WAITING_FOR_OUTPUT:
       {
-        int status;
-        do {
-          int16_t outbuf[128];
-          int16_t bytes = 0, type = 0;
-          // Note: Only PICO_DATA_PCM_16BIT is defined as output type, so we
-          // don't propagate that information. Rather, it's a fixed property.
-          status =
-            pico_getData(picoEngine, outbuf, sizeof(outbuf), &bytes, &type);
-          if (bytes > 0)
-            outputCb(outbuf, bytes/2);
-          // small delay to feed wdt
-          taskYIELD();
-        } while (status == PICO_STEP_BUSY);
+        int status = esp_pico_drain();
         if (status != PICO_STEP_IDLE)
         {
-          esp_pico_err_print("Get data failed, stopping TTS", status);
+          esp_pico_err_print(picoSystem, "Get data failed, stopping TTS", status);
           error = true;
         }
         else
@@ -260,6 +860,12 @@ static void esp_pico_cleanup(void)
 
   free(picoMemArea);
   picoMemArea = NULL;
+  picoTaBin = picoSgBin = NULL;
+
+#if CONFIG_PICOTTS_PROMPT_CACHE_SIZE > 0
+  esp_pico_prompt_cache_free();
+#endif
+  promptLen = -1;
 
   if (textQ)
   {
@@ -273,6 +879,8 @@ bool picotts_init(unsigned prio, picotts_output_fn cb, int core)
 {
   if (!exitLock)
     exitLock = xSemaphoreCreateBinary();
+  if (!addLock)
+    addLock = xSemaphoreCreateMutex();
 
   outputCb = cb;
 
@@ -281,69 +889,49 @@ bool picotts_init(unsigned prio, picotts_output_fn cb, int core)
     ESP_LOGE(tag, "already initialized");
     return false;
   }
+#if CONFIG_PICOTTS_SNAPSHOT
+  // Snapshots need arenas of the same alignment
+  picoMemArea = aligned_alloc(PICOTTS_SNAPSHOT_MEM_ALIGN, PICO_MEM_SIZE);
+#else
   picoMemArea = malloc(PICO_MEM_SIZE);
+#endif
   if (!picoMemArea)
   {
     ESP_LOGE(tag, "insufficient memory to initialize picotts");
     return false;
   }
 
-  #define PICO_INIT_CHECK(msg) \
-    if (ret != 0) \
-    { \
-      esp_pico_err_print(msg, ret); \
-      esp_pico_cleanup(); \
-      return false; \
-    }
-
-  int ret = pico_initialize(picoMemArea, PICO_MEM_SIZE, &picoSystem);
-  PICO_INIT_CHECK("init failed");
-
-  const void *ta = find_ta_bin_start();
+  size_t taSize = 0, sgSize = 0;
+  const void *ta = find_ta_bin_start(&taSize);
   if (!ta)
   {
     ESP_LOGE(tag, "Unable to find text analysis resource");
+    esp_pico_cleanup();
     return false;
   }
-  else
-    ESP_LOGI(tag, "Loading text analysis resource from %p", ta);
-
-  ret = esp_pico_loadResource(picoSystem, ta, &picoTaResource);
-  PICO_INIT_CHECK("Text analysis load failed");
 
-  const void *sg = find_sg_bin_start();
+  const void *sg = find_sg_bin_start(&sgSize);
   if (!sg)
   {
     ESP_LOGE(tag, "Unable to find signal generator resource");
+    esp_pico_cleanup();
     return false;
   }
-  else
-    ESP_LOGI(tag, "Loading signal generator resource from %p", sg);
-
-  ret = esp_pico_loadResource(picoSystem, sg, &picoSgResource);
-  PICO_INIT_CHECK("Signal generator load failed");
-
-  ret = pico_createVoiceDefinition(picoSystem, voiceName);
-  PICO_INIT_CHECK("Voice creation failed");
-
-  pico_Retstring str;
 
-  ret = pico_getResourceName(picoSystem, picoTaResource, str);
-  PICO_INIT_CHECK("TA resource name error");
-  ret = pico_addResourceToVoiceDefinition(
-    picoSystem, voiceName, (const pico_Char *)str);
-  PICO_INIT_CHECK("TA resource add failed");
-
-  ret = pico_getResourceName(picoSystem, picoSgResource, str);
-  PICO_INIT_CHECK("SG resource name error");
-  ret = pico_addResourceToVoiceDefinition(
-    picoSystem, voiceName, (const pico_Char *)str);
-  PICO_INIT_CHECK("SG resource add failed");
-
-  ret = pico_newEngine(picoSystem, voiceName, &picoEngine);
-  PICO_INIT_CHECK("Engine creation failed");
-
-  #undef PICO_INIT_CHECK
+#if CONFIG_PICOTTS_SNAPSHOT
+  int ret = esp_pico_snapshot_restore(ta, taSize, sg, sgSize) ?
+    PICO_OK : esp_pico_snapshot_make(ta, taSize, sg, sgSize);
+#else
+  int ret = esp_pico_setup(picoMemArea, ta, taSize, sg, sgSize,
+    &picoSystem, &picoTaResource, &picoSgResource, &picoEngine);
+#endif
+  if (ret != PICO_OK)
+  {
+    esp_pico_cleanup();
+    return false;
+  }
+  picoTaBin = ta;
+  picoSgBin = sg;
 
   textQ = xQueueCreate(CONFIG_PICOTTS_INPUT_QUEUE_SIZE, sizeof(char));
   if (!textQ)
@@ -373,17 +961,212 @@ bool picotts_init(unsigned prio, picotts_output_fn cb, int core)
 }
 
 
-void picotts_add(const char *text, unsigned len)
+static void esp_pico_enqueue(const char *text, unsigned len)
 {
   while(len--)
     xQueueSendToBack(textQ, text++, portMAX_DELAY);
 }
 
 
+void picotts_add(const char *text, unsigned len)
+{
+  xSemaphoreTake(addLock, portMAX_DELAY);
+  esp_pico_enqueue(text, len);
+  xSemaphoreGive(addLock);
+}
+
+
+void picotts_say(const char *text, unsigned len)
+{
+  static const char mark = PROMPT_MARK, end = 0;
+  const char *nul = memchr(text, 0, len);
+  if (nul)
+    len = nul - text;
+
+  // in one go, so that text added by other tasks can't end up inside
+  xSemaphoreTake(addLock, portMAX_DELAY);
+  if (len > CONFIG_PICOTTS_PROMPT_MAX_LEN)
+  {
+    // Too long to be a prompt; finish the text before and say it as usual
+    esp_pico_enqueue(&end, 1);
+    esp_pico_enqueue(text, len);
+  }
+  else
+  {
+    esp_pico_enqueue(&mark, 1);
+    esp_pico_enqueue(text, len);
+  }
+  esp_pico_enqueue(&end, 1);
+  xSemaphoreGive(addLock);
+}
+
+
+// Checks the header and every entry of a pack of at most avail bytes, so
+// that playing from it never reads outside of it.
+static bool esp_pico_pack_valid(const picotts_pack_header_t *hdr, size_t avail)
+{
+  if (hdr->magic != PICOTTS_PACK_MAGIC ||
+      hdr->version != PICOTTS_PACK_VERSION ||
+      hdr->sample_rate != PICOTTS_SAMPLE_RATE ||
+      hdr->size > avail || hdr->size < sizeof(*hdr) ||
+      hdr->count > (hdr->size - sizeof(*hdr)) / sizeof(picotts_pack_entry_t))
+    return false;
+
+  const picotts_pack_entry_t *index = (const picotts_pack_entry_t *)(hdr + 1);
+  for (uint32_t i = 0; i < hdr->count; ++i)
+  {
+    const picotts_pack_entry_t *e = &index[i];
+    if (e->text > hdr->size || e->text_len > hdr->size - e->text ||
+        e->samples > hdr->size || (e->samples & 3) ||
+        e->count > (hdr->size - e->samples) / sizeof(int16_t) ||
+        (i > 0 && e->hash < index[i - 1].hash))
+      return false;
+  }
+  return true;
+}
+
+
+// Makes the TTS task use pack (and mmap) from the next prompt on.
+// @returns The mapping of the pack used so far, to be unmapped by the caller.
+static esp_partition_mmap_handle_t esp_pico_pack_swap(
+  const picotts_pack_header_t *pack, esp_partition_mmap_handle_t mmap)
+{
+  if (!packLock)
+    packLock = xSemaphoreCreateMutex();
+  xSemaphoreTake(packLock, portMAX_DELAY);
+  esp_partition_mmap_handle_t old = packMmap;
+  promptPack = pack;
+  packMmap = mmap;
+  xSemaphoreGive(packLock);
+  return old;
+}
+
+
+bool picotts_set_prompt_pack(const void *pack)
+{
+  if (pack && !esp_pico_pack_valid(pack, SIZE_MAX))
+  {
+    ESP_LOGE(tag, "Invalid prompt pack at %p", pack);
+    return false;
+  }
+  esp_partition_mmap_handle_t old = esp_pico_pack_swap(pack, 0);
+  if (old)
+    esp_partition_munmap(old);
+  return true;
+}
+
+
+bool picotts_map_prompt_pack(const char *partition)
+{
+  if (!partition)
+    partition = CONFIG_PICOTTS_PROMPT_PARTITION;
+  esp_partition_mmap_handle_t mmap = 0;
+  size_t size;
+  const void *pack = find_and_map_partition(partition, &mmap, &size);
+  if (!pack)
+    return false;
+  if (!esp_pico_pack_valid(pack, size))
+  {
+    ESP_LOGE(tag, "Invalid prompt pack in partition '%s'", partition);
+    esp_partition_munmap(mmap);
+    return false;
+  }
+  esp_partition_mmap_handle_t old = esp_pico_pack_swap(pack, mmap);
+  if (old)
+    esp_partition_munmap(old);
+  return true;
+}
+
+
+// Reads the blocks of a resource listed in the profile that were read by
+// the texts spoken while recording it, up to *budget bytes of them. With
+// count, only counts the blocks that fit; otherwise reads them back to
+// front, so that the ones used first are the last to enter the cache.
+static unsigned esp_pico_prefetch_resource(
+  const void *profile, const void *rsrc, unsigned count, size_t *budget)
+{
+  const picotts_profile_resource_t *entry =
+    picotts_profile_find(profile, rsrc);
+  if (!entry)
+    return 0;
+  const picotts_profile_block_t *blocks =
+    picotts_profile_blocks(profile, entry);
+  const unsigned shift =
+    ((const picotts_profile_header_t *)profile)->block_shift;
+  const size_t blockSize = (size_t)1 << shift;
+
+  if (!count)
+  {
+    unsigned n = 0;
+    for (; n < entry->count && *budget >= blockSize; ++n)
+    {
+      if (blocks[n].hits)
+        *budget -= blockSize;
+    }
+    return n;
+  }
+
+  volatile uint32_t sum = 0;
+  while (count--)
+  {
+    if (!blocks[count].hits)
+      continue;
+    const size_t start = (size_t)blocks[count].block << shift;
+    size_t end = start + blockSize;
+    if (end > entry->size)
+      end = entry->size;
+    for (size_t off = start; off + sizeof(uint32_t) <= end;
+         off += FLASH_CACHE_LINE)
+      sum += *(const volatile uint32_t *)((const uint8_t *)rsrc + off);
+  }
+  return 0;
+}
+
+
+bool picotts_prefetch(const void *profile)
+{
+  if (!picoTaBin || !picoSgBin)
+  {
+    ESP_LOGE(tag, "not initialized");
+    return false;
+  }
+  esp_partition_mmap_handle_t mmap = 0;
+  if (!profile)
+    profile = find_and_map_partition(
+      CONFIG_PICOTTS_PROFILE_PARTITION, &mmap, NULL);
+
+  size_t budget = CONFIG_PICOTTS_PREFETCH_SIZE;
+  unsigned ta = 0, sg = 0;
+  bool found = profile &&
+    picotts_profile_find(profile, picoTaBin) &&
+    picotts_profile_find(profile, picoSgBin);
+  if (found)
+  {
+    // text analysis runs first, so its blocks go last
+    ta = esp_pico_prefetch_resource(profile, picoTaBin, 0, &budget);
+    sg = esp_pico_prefetch_resource(profile, picoSgBin, 0, &budget);
+    esp_pico_prefetch_resource(profile, picoSgBin, sg, &budget);
+    esp_pico_prefetch_resource(profile, picoTaBin, ta, &budget);
+    ESP_LOGI(tag, "Prefetched %u bytes of the resources",
+      (unsigned)(CONFIG_PICOTTS_PREFETCH_SIZE - budget));
+  }
+  else if (profile)
+    ESP_LOGE(tag, "Access profile at %p doesn't list the resources", profile);
+
+  if (mmap)
+    esp_partition_munmap(mmap);
+  return found;
+}
+
+
 void picotts_shutdown(void)
 {
   esp_pico_cleanup();
 
+  esp_partition_mmap_handle_t old = esp_pico_pack_swap(NULL, 0);
+  if (old)
+    esp_partition_munmap(old);
+
 #if CONFIG_PICOTTS_RESOURCE_MODE_PARTITION
   unmap_partitions();
 #endif
@@ -528,6 +528,15 @@ PICO_FUNC pico_newEngine(
         picoos_emReset(system->common->em);
         if (system->engine == NULL) {
             *outEngine = (pico_Engine) picoctrl_newEngine(system->common->mm, system->rm, voiceName);
+#if defined(PICOKNOW_LAZY_INIT)
+            /* the kbs used are specialized while creating the engine; drop
+               it if that failed for one of them */
+            if ((*outEngine != NULL)
+                && (PICO_OK != picoos_emGetExceptionCode(system->common->em))) {
+                picoctrl_disposeEngine(system->common->mm, system->rm,
+                        (picoctrl_Engine *) outEngine);
+            }
+#endif
             if (*outEngine != NULL) {
                 system->engine = (picoctrl_Engine) *outEngine;
             } else {
@@ -616,6 +625,40 @@ PICO_FUNC pico_putTextUtf8(
     return status;
 }
 
+/**
+ * pico_putPhonemes : Puts a phonetic transcription into the engine
+ * @param    engine : pointer to a Pico engine handle
+ * @param    *phonemes : pointer to the transcription
+ * @param    phonemesSize : transcription buffer size
+ * @return  PICO_OK : successful
+ * @return     PICO_EXC_BUF_OVERFLOW : transcription put before still pending
+ * @return     PICO_EXC_MAX_NUM_EXCEED : transcription too long
+ * @return     PICO_ERR_INVALID_HANDLE, PICO_ERR_NULLPTR_ACCESS,
+ *           PICO_ERR_INVALID_ARGUMENT : errors
+ * @callgraph
+ * @callergraph
+ */
+PICO_FUNC pico_putPhonemes(
+        pico_Engine engine,
+        const pico_Char *phonemes,
+        const pico_Int16 phonemesSize)
+{
+    pico_Status status = PICO_OK;
+
+    if (!picoctrl_isValidEngineHandle((picoctrl_Engine) engine)) {
+        status = PICO_ERR_INVALID_HANDLE;
+    } else if (phonemes == NULL) {
+        status = PICO_ERR_NULLPTR_ACCESS;
+    } else if (phonemesSize < 0) {
+        status = PICO_ERR_INVALID_ARGUMENT;
+    } else {
+        picoctrl_engResetExceptionManager((picoctrl_Engine) engine);
+        status = picoctrl_engFeedPhonemes((picoctrl_Engine) engine, (const picoos_char *)phonemes, phonemesSize);
+    }
+
+    return status;
+}
+
 /**
  * pico_getData : Gets speech data from the engine.
  * @param    engine : pointer to a Pico engine handle
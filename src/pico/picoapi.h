@@ -392,6 +392,42 @@ PICO_FUNC pico_putTextUtf8(
         pico_Int16 *outBytesPut
         );
 
+/**
+   Puts the phonetic transcription 'phonemes' of an utterance into the
+   engine, which synthesizes it without text analysis, i.e. without
+   lexicon lookup, grapheme to phoneme conversion, accentuation and
+   phrasing. Words are syllabified and get a part of speech as with the
+   phoneme markup.
+   'phonemesSize' is the maximum size in number of bytes accessible in
+   'phonemes'; a '\0' ends the transcription before. The transcription
+   consists of tokens separated by blanks:
+     - a word in X-SAMPA as in the phoneme markup, with stress (") and
+       syllable (.) marks, e.g. k@"nEk.tId; it may end in /0 to /4 to
+       set the accent of the word (1 for an accented word, the default;
+       0 for none; 2 to 4 for weaker accents)
+     - '|' or '||' for a phrase boundary without or with a pause
+     - '.', '?' or '!' to end a sentence as statement, question or
+       exclamation (the default for the last one is statement)
+     - '#pitch=', '#speed=' or '#volume=' followed by a level in
+       percent, like the respective text markup, in effect up to the end
+       of the transcription
+     - '#break=' followed by the length of a pause in ms
+   Text put before without a final '\0' is finished and spoken first;
+   text put after is only accepted once the transcription is processed
+   up to the phonetic stage. The transcription is spoken by calling
+   'pico_getData' as for text.
+   Returns PICO_EXC_BUF_OVERFLOW if a transcription put before is still
+   pending (call 'pico_getData' and try again), PICO_EXC_MAX_NUM_EXCEED
+   if the transcription is too long for the engine and
+   PICO_ERR_INVALID_ARGUMENT if it contains unknown phonemes or tokens
+   (see 'pico_getEngineWarning').
+*/
+PICO_FUNC pico_putPhonemes(
+        pico_Engine engine,
+        const pico_Char *phonemes,
+        const pico_Int16 phonemesSize
+        );
+
 /**
    Gets speech data from the engine. Every time this function is
    called, the engine performs, within a short time slot, a small
@@ -70,7 +70,18 @@ extern "C" {
 }
 #endif
 
+#if defined(PICOCEP_STREAMING)
+/* streaming smoothing: instead of collecting a whole sentence, a window of frames is smoothed as soon as
+ * PICOCEP_STREAM_BLOCK new frames plus PICOCEP_STREAM_LOOKAHEAD frames of right context are available;
+ * only the new frames are output. The window then keeps PICOCEP_STREAM_HISTORY already output frames as
+ * left context for the next (overlapping) solve. Frames are 4 ms, so the look-ahead is about 256 ms */
+#define PICOCEP_STREAM_HISTORY    32
+#define PICOCEP_STREAM_BLOCK      64
+#define PICOCEP_STREAM_LOOKAHEAD  64
+#define PICOCEP_MAXWINLEN 1000  /* maximum number of frames that can be smoothed, i.e. window plus longest phone */
+#else
 #define PICOCEP_MAXWINLEN 10000  /* maximum number of frames that can be smoothed, i.e. maximum sentence length */
+#endif
 #define PICOCEP_MSGSTR_SIZE 32
 #define PICOCEP_IN_BUFF_SIZE PICODATA_BUFSIZE_DEFAULT
 
@@ -87,6 +98,23 @@ extern "C" {
 #define PICOCEP_LFZDOUBLEDEC 1
 #define PICOCEP_MGCDOUBLEDEC 0
 
+/* number of cepstral dimensions smoothed in lock-step. The lanes share the
+ * diag0, diag1, diag2, WUm and invdiag0 working arrays (interleaved), so a
+ * phrase of N frames is smoothed in lanes only while N*lanes fits into
+ * PICOCEP_MAXWINLEN; longer phrases fall back to one dimension at a time.
+ * Define as 1 to always smooth one dimension at a time */
+#if !defined(PICOCEP_SMOOTH_LANES)
+#define PICOCEP_SMOOTH_LANES 4
+#endif
+
+/* number of workers sharing the smoothing jobs (f0 dimensions and groups of mgc dimensions) of
+ * a phrase; every worker beyond the first needs its own working arrays (5*4*PICOCEP_MAXWINLEN
+ * bytes, fewer workers are used if these do not fit into the engine memory). The workers only
+ * run concurrently if the platform layer is built with PICOPAL_THREADS */
+#if !defined(PICOCEP_SMOOTH_WORKERS)
+#define PICOCEP_SMOOTH_WORKERS 1
+#endif
+
 typedef enum picocep_WantMeanOrIvar
 {
     PICOCEP_WANTMEAN, PICOCEP_WANTIVAR
@@ -149,6 +177,14 @@ typedef struct
     picoos_uint16 frame; /* sync position */
 } picoacph_headx_t;
 
+/* working arrays of the banded W'UW solver; every smoothing worker has its own */
+typedef struct
+{
+    picoos_int32 diag0[PICOCEP_MAXWINLEN], diag1[PICOCEP_MAXWINLEN],
+            diag2[PICOCEP_MAXWINLEN], WUm[PICOCEP_MAXWINLEN],
+            invdiag0[PICOCEP_MAXWINLEN];
+} cep_smoothbuf_t;
+
 /*----------------------------------------------------------
  //    Name    :    cep_subobj
  //    Function:    subobject definition for the cep processing
@@ -188,9 +224,12 @@ typedef struct cep_subobj
     picoos_uint32 nNumFrames;
     /*---------------------- other working variables ---------------------------*/
 
-    picoos_int32 diag0[PICOCEP_MAXWINLEN], diag1[PICOCEP_MAXWINLEN],
-            diag2[PICOCEP_MAXWINLEN], WUm[PICOCEP_MAXWINLEN],
-            invdiag0[PICOCEP_MAXWINLEN];
+    cep_smoothbuf_t smoothbuf; /* working arrays of smoothing worker 0 */
+    cep_smoothbuf_t * workerbuf[PICOCEP_SMOOTH_WORKERS]; /* working arrays of all smoothing workers */
+    picoos_uint16 smoothN; /* number of frames smoothed in the current SMOOTH step */
+    picoos_uint8 smoothLanes; /* number of mgc dimensions per smoothing job */
+    picoos_uint8 numWorkers; /* number of workers with working arrays, at most PICOCEP_SMOOTH_WORKERS */
+    picopal_JobPool pool; /* threads of the workers beyond the first, NULL if none */
 
     /*---------------------- constants --------------------------------------*/
     picoos_int32 xi[5], x1[2], x2[3], xm[3], xn[2];
@@ -205,6 +244,9 @@ typedef struct cep_subobj
     picoos_uint16 indicesMGC[PICOCEP_MAXWINLEN];
     picoos_uint16 indexReadPos, indexWritePos;
     picoos_uint16 activeEndPos; /* end position of indices to be considered */
+#if defined(PICOCEP_STREAMING)
+    picoos_uint16 historyEndPos; /* indices before this position have already been output (left context) */
+#endif
 
     /* this is used for input and output */
     picoos_uint8 phoneId[PICOCEP_MAXWINLEN]; /* synchronised with indexReadPos */
@@ -243,17 +285,18 @@ typedef struct cep_subobj
 
 static void initSmoothing(cep_subobj_t * cep);
 
-static picoos_int32 getFromPdf(picokpdf_PdfMUL pdf, picoos_uint32 vecstart,
+static picoos_int32 getFromPdf(picokpdf_PdfMUL pdf, picoos_uint16 vecindex,
         picoos_uint8 cepnum, picocep_WantMeanOrIvar_t wantMeanOrIvar,
         picocep_WantStaticOrDelta_t wantStaticOrDeltax);
 
-static void invMatrix(cep_subobj_t * cep, picoos_uint16 N,
-        picoos_int16 *smoothcep, picoos_uint8 cepnum,
+static void invMatrix(cep_smoothbuf_t * sb, picoos_uint16 N,
+        picoos_int16 *smoothcep, picoos_uint8 cepnum, picoos_uint8 lanes,
         picokpdf_PdfMUL pdf, picoos_uint8 invpow, picoos_uint8 invDoubleDec);
 
-static picoos_uint8 makeWUWandWUm(cep_subobj_t * cep, picokpdf_PdfMUL pdf,
+static picoos_uint8 makeWUWandWUm(cep_subobj_t * cep, cep_smoothbuf_t * sb,
+        picokpdf_PdfMUL pdf,
         picoos_uint16 *indices, picoos_uint16 b, picoos_uint16 N,
-        picoos_uint8 cepnum);
+        picoos_uint8 cepnum, picoos_uint8 lanes);
 
 static void getDirect(picokpdf_PdfMUL pdf, picoos_uint16 *indices,
         picoos_uint16 activeEndPos,
@@ -267,6 +310,12 @@ static picoos_uint16 get_pi_uint16(picoos_uint8 * buf, picoos_uint16 *pos);
 
 static void treat_phone(cep_subobj_t * cep, picodata_itemhead_t * ihead);
 
+static void smoothJob(void * ctx, picopal_uint16 job, picopal_uint8 worker);
+
+#if defined(PICOCEP_STREAMING)
+static void slideWindow(cep_subobj_t * cep);
+#endif
+
 static picoos_uint8 forwardingItem(picodata_itemhead_t * ihead);
 
 static picodata_step_result_t cepStep(register picodata_ProcessingUnit this,
@@ -308,6 +357,9 @@ static pico_status_t cepInitialize(register picodata_ProcessingUnit this, picoos
     /* indices* */
     cep->indexReadPos = 0;
     cep->indexWritePos = 0;
+#if defined(PICOCEP_STREAMING)
+    cep->historyEndPos = 0;
+#endif
     /* outCep, outF0, outVoiced */
     cep->outXCepReadPos = 0;
     cep->outXCepWritePos = 0;
@@ -397,6 +449,11 @@ static pico_status_t cepSubObjDeallocate(register picodata_ProcessingUnit this,
 #endif
     if (NULL != this) {
         cep_subobj_t * cep = (cep_subobj_t *) this->subObj;
+        picoos_uint8 i;
+        picoos_jobpool_dispose(&cep->pool);
+        for (i = 1; i < cep->numWorkers; i++) {
+            picoos_deallocate(this->common->mm, (void *) &cep->workerbuf[i]);
+        }
         picoos_deallocate(this->common->mm, (void *) &cep->outXCep);
         picoos_deallocate(this->common->mm, (void *) &cep->outVoiced);
         picoos_deallocate(this->common->mm, (void *) &cep->outF0);
@@ -463,6 +520,20 @@ picodata_ProcessingUnit picocep_newCepUnit(picoos_MemoryManager mm,
         picoos_deallocate(mm, (void*) &this);
         return NULL;
     }
+
+    /* working arrays of the smoothing workers; use fewer workers if the engine memory is short */
+    cep->workerbuf[0] = &cep->smoothbuf;
+    cep->numWorkers = 1;
+    while ((cep->numWorkers < PICOCEP_SMOOTH_WORKERS)
+            && (NULL != (cep->workerbuf[cep->numWorkers]
+                    = (cep_smoothbuf_t *) picoos_allocate(this->common->mm,
+                            sizeof(cep_smoothbuf_t))))) {
+        cep->numWorkers++;
+    }
+    /* the workers run for the lifetime of the PU, not per phrase */
+    cep->pool = picoos_jobpool_new(cep->numWorkers);
+    PICODBG_DEBUG(("smoothing with %i workers", cep->numWorkers));
+
     cepInitialize(this, PICO_RESET_FULL);
 
     return this;
@@ -731,7 +802,7 @@ static picoos_int32 picocep_fixptInvDiagEle(picoos_uint32 d,
         picoos_uint8* rowscpow, picoos_uint8 bigpow, picoos_uint8 invpow)
 {
     picoos_uint32 r, b, c, h, f, stop;
-    picoos_uint8 dlen;
+    picoos_uint8 dlen, blen, s;
     /* picoos_int32 zz; */
     c = 0;
     stop = 0;
@@ -754,14 +825,33 @@ static picoos_int32 picocep_fixptInvDiagEle(picoos_uint32 d,
     bigpow--;
     r <<= 1;
 
-    /* loop */
-    while ((bigpow > stop) && (r != 0)) {
-        if (r >= b) {
-            c += (1 << bigpow);
-            r -= b;
+    blen = dlen + (*rowscpow);
+    if (blen <= 30) {
+        /* loop, several bits at a time: the remainder is < b < 1<<blen, so it can be
+         * shifted by up to 32-blen bits and the next quotient bits obtained by one DIV */
+        r >>= 1;
+        while ((bigpow > stop) && (r != 0)) {
+            s = 32 - blen;
+            if (s > bigpow - stop) {
+                s = bigpow - stop;
+            }
+            r <<= s;
+            h = r / b;
+            r -= h * b;
+            c += h << (bigpow - s + 1);
+            bigpow -= s;
         }
-        bigpow--;
         r <<= 1;
+    } else {
+        /* loop */
+        while ((bigpow > stop) && (r != 0)) {
+            if (r >= b) {
+                c += (1 << bigpow);
+                r -= b;
+            }
+            bigpow--;
+            r <<= 1;
+        }
     }
 
     if (r != 0) {
@@ -866,119 +956,140 @@ static void initSmoothing(cep_subobj_t * cep)
 
 /**
  * matrix inversion
- * @param    cep : PU sub object pointer
+ * @param    sb : working arrays of the calling smoothing worker
  * @param    N
  * @param    smoothcep : pointer to picoos_int16, sequence of smoothed cepstral vectors
- * @param    cepnum :  cepstral dimension to be treated
+ * @param    cepnum :  first cepstral dimension to be treated
+ * @param    lanes :  number of cepstral dimensions (cepnum..cepnum+lanes-1) solved in lock-step
  * @param    pdf :  pdf resource
  * @param    invpow :  fixed point base for inverse
  * @param    invDoubleDec : boolean indicating that result of picocep_fixptinv has fixed point base 2*bigpow
  *             picocep_fixptmult absorbs double decimal size by dividing its result by extra factor big
  * @return  void
- * @remarks diag0, diag1, diag2, WUm, invdiag0  globals needed in this function (object members in pico)
+ * @remarks diag0, diag1, diag2, WUm, invdiag0  members of sb needed in this function
+ * @remarks the dimensions are stored interleaved (element j of dimension cepnum+l is at j*lanes+l), so
+ *          every row step works on lanes independent systems of the same shape with adjacent operands
  * @callgraph
  * @callergraph
  */
-static void invMatrix(cep_subobj_t * cep, picoos_uint16 N,
-        picoos_int16 *smoothcep, picoos_uint8 cepnum,
+static void invMatrix(cep_smoothbuf_t * sb, picoos_uint16 N,
+        picoos_int16 *smoothcep, picoos_uint8 cepnum, picoos_uint8 lanes,
         picokpdf_PdfMUL pdf, picoos_uint8 invpow, picoos_uint8 invDoubleDec)
 {
     picoos_int32 j, v1, v2, h;
-    picoos_uint32 k;
-    picoos_uint8 rowscpow, prevrowscpow;
+    picoos_uint32 k, m, m1, m2;
+    picoos_uint8 l;
+    picoos_uint8 rowscpow[PICOCEP_SMOOTH_LANES], prevrowscpow[PICOCEP_SMOOTH_LANES];
     picoos_uint8 ceporder = pdf->ceporder;
     picoos_uint8 bigpow = pdf->bigpow;
     picoos_uint8 meanpow = pdf->meanpow;
 
     /* LDL factorization */
-    prevrowscpow = 0;
-    cep->invdiag0[0] = picocep_fixptInvDiagEle(cep->diag0[0], &rowscpow,
-            bigpow, invpow); /* inverse has fixed point basis 1<<invpow */
-    if (cep->diag1[0] >= 0)
-      cep->diag1[0] <<= rowscpow;
-    else
-      cep->diag1[0] = -(-cep->diag1[0] << rowscpow);
-    cep->diag1[0] = picocep_fixptinv(cep->diag1[0],
-            cep->invdiag0[0], bigpow, invpow, invDoubleDec); /* perform division via inverse */
-    if (cep->diag2[0] >= 0)
-      cep->diag2[0] <<= rowscpow;
-    else
-      cep->diag2[0] = -(-cep->diag2[0] << rowscpow);
-    cep->diag2[0] = picocep_fixptinv(cep->diag2[0],
-            cep->invdiag0[0], bigpow, invpow, invDoubleDec);
-    if (cep->WUm[0] >= 0)
-      cep->WUm[0] = (cep->WUm[0]) << rowscpow; /* if diag0 too low, multiply LHS and RHS of row in matrix equation by 1<<rowscpow */
-    else
-      cep->WUm[0] = -(-cep->WUm[0] << rowscpow); /* if diag0 too low, multiply LHS and RHS of row in matrix equation by 1<<rowscpow */
-    for (j = 1; j < N; j++) {
-        /* do forward substitution */
-        cep->WUm[j] = cep->WUm[j] - picocep_fixptmult(cep->diag1[j - 1],
-                cep->WUm[j - 1], bigpow, invDoubleDec);
-        if (j > 1) {
-            cep->WUm[j] = cep->WUm[j] - picocep_fixptmult(cep->diag2[j - 2],
-                    cep->WUm[j - 2], bigpow, invDoubleDec);
-        }
-
-        /* update row j */
-        v1 = picocep_fixptmult((cep->diag1[j - 1]) / (1 << rowscpow),
-                cep->diag0[j - 1], bigpow, invDoubleDec); /* undo scaling by 1<<rowscpow because diag1(j-1) refers to symm ele in column j-1 not in row j-1 */
-        cep->diag0[j] = cep->diag0[j] - picocep_fixptmult(cep->diag1[j - 1],
-                v1, bigpow, invDoubleDec);
-        if (j > 1) {
-            v2 = picocep_fixptmult((cep->diag2[j - 2]) / (1 << prevrowscpow),
-                    cep->diag0[j - 2], bigpow, invDoubleDec); /* undo scaling by 1<<prevrowscpow because diag1(j-2) refers to symm ele in column j-2 not in row j-2 */
-            cep->diag0[j] = cep->diag0[j] - picocep_fixptmult(
-                    cep->diag2[j - 2], v2, bigpow, invDoubleDec);
-        }
-        prevrowscpow = rowscpow;
-        cep->invdiag0[j] = picocep_fixptInvDiagEle(cep->diag0[j], &rowscpow,
+    for (l = 0; l < lanes; l++) {
+        prevrowscpow[l] = 0;
+        sb->invdiag0[l] = picocep_fixptInvDiagEle(sb->diag0[l], &rowscpow[l],
                 bigpow, invpow); /* inverse has fixed point basis 1<<invpow */
-        if (cep->WUm[j] >= 0)
-          cep->WUm[j] = (cep->WUm[j]) << rowscpow;
+        if (sb->diag1[l] >= 0)
+          sb->diag1[l] <<= rowscpow[l];
         else
-          cep->WUm[j] = -(-cep->WUm[j] << rowscpow);
-        if (j < N - 1) {
-            h = picocep_fixptmult(cep->diag2[j - 1], v1, bigpow, invDoubleDec);
-            if (cep->diag1[j] - h >= 0)
-              cep->diag1[j] = picocep_fixptinv((cep->diag1[j] - h) << rowscpow,
-                      cep->invdiag0[j], bigpow, invpow, invDoubleDec); /* eliminate column j below pivot */
-            else
-              cep->diag1[j] = picocep_fixptinv(-(-(cep->diag1[j] - h) << rowscpow),
-                      cep->invdiag0[j], bigpow, invpow, invDoubleDec); /* eliminate column j below pivot */
-        }
-        if (j < N - 2) {
-            if (cep->diag2[j] >= 0)
-              cep->diag2[j] = picocep_fixptinv((cep->diag2[j]) << rowscpow,
-                      cep->invdiag0[j], bigpow, invpow, invDoubleDec); /* eliminate column j below pivot */
+          sb->diag1[l] = -(-sb->diag1[l] << rowscpow[l]);
+        sb->diag1[l] = picocep_fixptinv(sb->diag1[l],
+                sb->invdiag0[l], bigpow, invpow, invDoubleDec); /* perform division via inverse */
+        if (sb->diag2[l] >= 0)
+          sb->diag2[l] <<= rowscpow[l];
+        else
+          sb->diag2[l] = -(-sb->diag2[l] << rowscpow[l]);
+        sb->diag2[l] = picocep_fixptinv(sb->diag2[l],
+                sb->invdiag0[l], bigpow, invpow, invDoubleDec);
+        if (sb->WUm[l] >= 0)
+          sb->WUm[l] = (sb->WUm[l]) << rowscpow[l]; /* if diag0 too low, multiply LHS and RHS of row in matrix equation by 1<<rowscpow */
+        else
+          sb->WUm[l] = -(-sb->WUm[l] << rowscpow[l]); /* if diag0 too low, multiply LHS and RHS of row in matrix equation by 1<<rowscpow */
+    }
+    for (j = 1; j < N; j++) {
+        for (l = 0; l < lanes; l++) {
+            m = j * lanes + l; /* row j */
+            m1 = m - lanes; /* row j-1 */
+            m2 = m1 - lanes; /* row j-2, only valid for j > 1 */
+
+            /* do forward substitution */
+            sb->WUm[m] = sb->WUm[m] - picocep_fixptmult(sb->diag1[m1],
+                    sb->WUm[m1], bigpow, invDoubleDec);
+            if (j > 1) {
+                sb->WUm[m] = sb->WUm[m] - picocep_fixptmult(sb->diag2[m2],
+                        sb->WUm[m2], bigpow, invDoubleDec);
+            }
+
+            /* update row j */
+            v1 = picocep_fixptmult((sb->diag1[m1]) / (1 << rowscpow[l]),
+                    sb->diag0[m1], bigpow, invDoubleDec); /* undo scaling by 1<<rowscpow because diag1(j-1) refers to symm ele in column j-1 not in row j-1 */
+            sb->diag0[m] = sb->diag0[m] - picocep_fixptmult(sb->diag1[m1],
+                    v1, bigpow, invDoubleDec);
+            if (j > 1) {
+                v2 = picocep_fixptmult((sb->diag2[m2]) / (1 << prevrowscpow[l]),
+                        sb->diag0[m2], bigpow, invDoubleDec); /* undo scaling by 1<<prevrowscpow because diag1(j-2) refers to symm ele in column j-2 not in row j-2 */
+                sb->diag0[m] = sb->diag0[m] - picocep_fixptmult(
+                        sb->diag2[m2], v2, bigpow, invDoubleDec);
+            }
+            prevrowscpow[l] = rowscpow[l];
+            sb->invdiag0[m] = picocep_fixptInvDiagEle(sb->diag0[m], &rowscpow[l],
+                    bigpow, invpow); /* inverse has fixed point basis 1<<invpow */
+            if (sb->WUm[m] >= 0)
+              sb->WUm[m] = (sb->WUm[m]) << rowscpow[l];
             else
-              cep->diag2[j] = picocep_fixptinv(-(-cep->diag2[j] << rowscpow),
-                      cep->invdiag0[j], bigpow, invpow, invDoubleDec); /* eliminate column j below pivot */
+              sb->WUm[m] = -(-sb->WUm[m] << rowscpow[l]);
+            if (j < N - 1) {
+                h = picocep_fixptmult(sb->diag2[m1], v1, bigpow, invDoubleDec);
+                if (sb->diag1[m] - h >= 0)
+                  sb->diag1[m] = picocep_fixptinv((sb->diag1[m] - h) << rowscpow[l],
+                          sb->invdiag0[m], bigpow, invpow, invDoubleDec); /* eliminate column j below pivot */
+                else
+                  sb->diag1[m] = picocep_fixptinv(-(-(sb->diag1[m] - h) << rowscpow[l]),
+                          sb->invdiag0[m], bigpow, invpow, invDoubleDec); /* eliminate column j below pivot */
+            }
+            if (j < N - 2) {
+                if (sb->diag2[m] >= 0)
+                  sb->diag2[m] = picocep_fixptinv((sb->diag2[m]) << rowscpow[l],
+                          sb->invdiag0[m], bigpow, invpow, invDoubleDec); /* eliminate column j below pivot */
+                else
+                  sb->diag2[m] = picocep_fixptinv(-(-sb->diag2[m] << rowscpow[l]),
+                          sb->invdiag0[m], bigpow, invpow, invDoubleDec); /* eliminate column j below pivot */
+            }
         }
     }
 
     /* divide all entries of WUm by diag0 */
-    for (j = 0; j < N; j++) {
-        cep->WUm[j] = picocep_fixptinv(cep->WUm[j], cep->invdiag0[j], bigpow,
+    for (m = 0; m < (picoos_uint32) N * lanes; m++) {
+        sb->WUm[m] = picocep_fixptinv(sb->WUm[m], sb->invdiag0[m], bigpow,
                 invpow, invDoubleDec);
         if (invDoubleDec == 1) {
-            cep->WUm[j] = picocep_fixptdivpow(cep->WUm[j], bigpow);
+            sb->WUm[m] = picocep_fixptdivpow(sb->WUm[m], bigpow);
         }
     }
 
     /* backward substitution */
     for (j = N - 2; j >= 0; j--) {
-        cep->WUm[j] = cep->WUm[j] - picocep_fixptmult(cep->diag1[j], cep->WUm[j
-                + 1], bigpow, invDoubleDec);
-        if (j < N - 2) {
-            cep->WUm[j] = cep->WUm[j] - picocep_fixptmult(cep->diag2[j],
-                    cep->WUm[j + 2], bigpow, invDoubleDec);
+        for (l = 0; l < lanes; l++) {
+            m = j * lanes + l; /* row j */
+            m1 = m + lanes; /* row j+1 */
+            m2 = m1 + lanes; /* row j+2, only valid for j < N-2 */
+            sb->WUm[m] = sb->WUm[m] - picocep_fixptmult(sb->diag1[m],
+                    sb->WUm[m1], bigpow, invDoubleDec);
+            if (j < N - 2) {
+                sb->WUm[m] = sb->WUm[m] - picocep_fixptmult(sb->diag2[m],
+                        sb->WUm[m2], bigpow, invDoubleDec);
+            }
         }
     }
-    /* copy N frames into smoothcep (only for coeff # "cepnum")  */
+    /* copy N frames into smoothcep (only for coeffs # "cepnum".."cepnum+lanes-1")  */
     /* coefficients normalized to occupy short; for correct waveform energy, divide by (1<<(bigpow-meanpow)) then convert e.g. to picoos_single */
     k = cepnum;
+    m = 0;
     for (j = 0; j < N; j++) {
-        smoothcep[k] = (picoos_int16)(cep->WUm[j]/(1<<meanpow));
+        for (l = 0; l < lanes; l++) {
+            smoothcep[k + l] = (picoos_int16)(sb->WUm[m]/(1<<meanpow));
+            m++;
+        }
         k += ceporder;
     }
 
@@ -987,177 +1098,187 @@ static void invMatrix(cep_subobj_t * cep, picoos_uint16 N,
 /**
  * Calculate matrix products needed to implement the solution
  * @param    cep : PU sub object pointer
+ * @param    sb : working arrays of the calling smoothing worker
  * @param    pdf :  pointer to picoos_uint8, sequence of pdf vectors, each vector of length 1+ceporder*2+numdeltas*3+ceporder*3
  * @param    indices : indices of pdf vectors for all frames in current sentence
  * @param    b, N :  to be smoothed frames indices (range will be from b to b+N-1)
- * @param    cepnum :  cepstral dimension to be treated
+ * @param    cepnum :  first cepstral dimension to be treated
+ * @param    lanes :  number of cepstral dimensions (cepnum..cepnum+lanes-1) to be treated
  * @return  void
- * @remarks diag0, diag1, diag2, WUm, invdiag0  globals needed in this function (object members in pico)
+ * @remarks diag0, diag1, diag2, WUm, invdiag0  members of sb needed in this function
+ * @remarks the dimensions are stored interleaved, element i of dimension cepnum+l is at i*lanes+l
  * @remarks WUW --> At x W x A
  * @remarks WUm --> At x W x b
  * @callgraph
  * @callergraph
  */
-static picoos_uint8 makeWUWandWUm(cep_subobj_t * cep, picokpdf_PdfMUL pdf,
+static picoos_uint8 makeWUWandWUm(cep_subobj_t * cep, cep_smoothbuf_t * sb,
+        picokpdf_PdfMUL pdf,
         picoos_uint16 *indices, picoos_uint16 b, picoos_uint16 N,
-        picoos_uint8 cepnum)
+        picoos_uint8 cepnum, picoos_uint8 lanes)
 {
     picoos_uint16 Id[2], Idd[3];
     /*picoos_uint32      vecstart, k;*/
-    picoos_uint32 vecstart;
+    picoos_uint16 vecindex;
     picoos_int32 *x = NULL, *xsq = NULL;
     picoos_int32 mean, ivar;
     picoos_uint16 i, j, numd = 0, numdd = 0;
-    picoos_uint8 vecsize = pdf->vecsize;
+    picoos_uint32 m;
+    picoos_uint8 l, dim;
     picoos_int32 prev_WUm, prev_diag0, prev_diag1, prev_diag1_1, prev_diag2;
 
-    prev_WUm = prev_diag0 = prev_diag1 = prev_diag1_1 = prev_diag2 = 0;
-    for (i = 0; i < N; i++) {
-
-        if ((1 < i) && (i < N - 2)) {
-            x = cep->xi;
-            xsq = cep->xsqi;
-            numd = 2;
-            numdd = 3;
-            Id[0] = Idd[0] = i - 1;
-            Id[1] = Idd[2] = i + 1;
-            Idd[1] = i;
-        } else if (i == 0) {
-            x = cep->x1;
-            xsq = cep->xsq1;
-            numd = numdd = 1;
-            Id[0] = Idd[0] = 1;
-        } else if (i == 1) {
-            x = cep->x2;
-            xsq = cep->xsq2;
-            numd = 1;
-            numdd = 2;
-            Id[0] = Idd[1] = 2;
-            Idd[0] = 1;
-        } else if (i == N - 2) {
-            x = cep->xm;
-            xsq = cep->xsqm;
-            numd = 1;
-            numdd = 2;
-            Id[0] = Idd[0] = N - 3;
-            Idd[1] = N - 2;
-        } else if (i == N - 1) {
-            x = cep->xn;
-            xsq = cep->xsqn;
-            numd = numdd = 1;
-            Id[0] = Idd[0] = N - 2;
-        }
+    for (l = 0; l < lanes; l++) {
+        dim = cepnum + l;
+        prev_WUm = prev_diag0 = prev_diag1 = prev_diag1_1 = prev_diag2 = 0;
+        for (i = 0; i < N; i++) {
+            m = i * lanes + l;
+
+            if ((1 < i) && (i < N - 2)) {
+                x = cep->xi;
+                xsq = cep->xsqi;
+                numd = 2;
+                numdd = 3;
+                Id[0] = Idd[0] = i - 1;
+                Id[1] = Idd[2] = i + 1;
+                Idd[1] = i;
+            } else if (i == 0) {
+                x = cep->x1;
+                xsq = cep->xsq1;
+                numd = numdd = 1;
+                Id[0] = Idd[0] = 1;
+            } else if (i == 1) {
+                x = cep->x2;
+                xsq = cep->xsq2;
+                numd = 1;
+                numdd = 2;
+                Id[0] = Idd[1] = 2;
+                Idd[0] = 1;
+            } else if (i == N - 2) {
+                x = cep->xm;
+                xsq = cep->xsqm;
+                numd = 1;
+                numdd = 2;
+                Id[0] = Idd[0] = N - 3;
+                Idd[1] = N - 2;
+            } else if (i == N - 1) {
+                x = cep->xn;
+                xsq = cep->xsqn;
+                numd = numdd = 1;
+                Id[0] = Idd[0] = N - 2;
+            }
 
-        /* process static means and static inverse variances */
-        if (i > 0 && indices[b + i] == indices[b + i - 1]) {
-            cep->diag0[i] = prev_diag0;
-            cep->WUm[i] = prev_WUm;
-        } else {
-            vecstart = indices[b + i] * vecsize;
-            ivar = getFromPdf(pdf, vecstart, cepnum, PICOCEP_WANTIVAR,
-                    PICOCEP_WANTSTATIC);
-            prev_diag0 = cep->diag0[i] = ivar << 2; /* multiply ivar by 4 (4 used to be first entry of xsq) */
-            mean = getFromPdf(pdf, vecstart, cepnum, PICOCEP_WANTMEAN,
-                    PICOCEP_WANTSTATIC);
-            if (mean >= 0)
-              prev_WUm = cep->WUm[i] = mean << 1; /* multiply mean by 2 (2 used to be first entry of x) */
-            else
-              prev_WUm = cep->WUm[i] = -(-mean << 1); /* multiply mean by 2 (2 used to be first entry of x) */
-        }
+            /* process static means and static inverse variances */
+            if (i > 0 && indices[b + i] == indices[b + i - 1]) {
+                sb->diag0[m] = prev_diag0;
+                sb->WUm[m] = prev_WUm;
+            } else {
+                vecindex = indices[b + i];
+                ivar = getFromPdf(pdf, vecindex, dim, PICOCEP_WANTIVAR,
+                        PICOCEP_WANTSTATIC);
+                prev_diag0 = sb->diag0[m] = ivar << 2; /* multiply ivar by 4 (4 used to be first entry of xsq) */
+                mean = getFromPdf(pdf, vecindex, dim, PICOCEP_WANTMEAN,
+                        PICOCEP_WANTSTATIC);
+                if (mean >= 0)
+                  prev_WUm = sb->WUm[m] = mean << 1; /* multiply mean by 2 (2 used to be first entry of x) */
+                else
+                  prev_WUm = sb->WUm[m] = -(-mean << 1); /* multiply mean by 2 (2 used to be first entry of x) */
+            }
 
-        /* process delta means and delta inverse variances */
-        for (j = 0; j < numd; j++) {
-            vecstart = indices[b + Id[j]] * vecsize;
-            ivar = getFromPdf(pdf, vecstart, cepnum, PICOCEP_WANTIVAR,
-                    PICOCEP_WANTDELTA);
-            cep->diag0[i] += xsq[j] * ivar;
-
-            mean = getFromPdf(pdf, vecstart, cepnum, PICOCEP_WANTMEAN,
-                    PICOCEP_WANTDELTA);
-            if (mean != 0) {
-                cep->WUm[i] += x[j] * mean;
+            /* process delta means and delta inverse variances */
+            for (j = 0; j < numd; j++) {
+                vecindex = indices[b + Id[j]];
+                ivar = getFromPdf(pdf, vecindex, dim, PICOCEP_WANTIVAR,
+                        PICOCEP_WANTDELTA);
+                sb->diag0[m] += xsq[j] * ivar;
+
+                mean = getFromPdf(pdf, vecindex, dim, PICOCEP_WANTMEAN,
+                        PICOCEP_WANTDELTA);
+                if (mean != 0) {
+                    sb->WUm[m] += x[j] * mean;
+                }
             }
-        }
 
-        /* process delta delta means and delta delta inverse variances */
-        for (j = 0; j < numdd; j++) {
-            vecstart = indices[b + Idd[j]] * vecsize;
-            ivar = getFromPdf(pdf, vecstart, cepnum, PICOCEP_WANTIVAR,
-                    PICOCEP_WANTDELTA2);
-            cep->diag0[i] += xsq[numd + j] * ivar;
-
-            mean = getFromPdf(pdf, vecstart, cepnum, PICOCEP_WANTMEAN,
-                    PICOCEP_WANTDELTA2);
-            if (mean != 0) {
-                cep->WUm[i] += x[numd + j] * mean;
+            /* process delta delta means and delta delta inverse variances */
+            for (j = 0; j < numdd; j++) {
+                vecindex = indices[b + Idd[j]];
+                ivar = getFromPdf(pdf, vecindex, dim, PICOCEP_WANTIVAR,
+                        PICOCEP_WANTDELTA2);
+                sb->diag0[m] += xsq[numd + j] * ivar;
+
+                mean = getFromPdf(pdf, vecindex, dim, PICOCEP_WANTMEAN,
+                        PICOCEP_WANTDELTA2);
+                if (mean != 0) {
+                    sb->WUm[m] += x[numd + j] * mean;
+                }
             }
-        }
 
-        cep->diag0[i] = (cep->diag0[i] + 2) / 4; /* long DIV with rounding */
-        cep->WUm[i] = (cep->WUm[i] + 1) / 2; /* long DIV with rounding */
+            sb->diag0[m] = (sb->diag0[m] + 2) / 4; /* long DIV with rounding */
+            sb->WUm[m] = (sb->WUm[m] + 1) / 2; /* long DIV with rounding */
 
-        /* calculate diag(A,-1) */
-        if (i < N - 1) {
-            if (i < N - 2) {
-                if (i > 0 && indices[b + i + 1] == indices[b + i]) {
-                    cep->diag1[i] = prev_diag1;
-                } else {
-                    vecstart = indices[b + i + 1] * vecsize;
+            /* calculate diag(A,-1) */
+            if (i < N - 1) {
+                if (i < N - 2) {
+                    if (i > 0 && indices[b + i + 1] == indices[b + i]) {
+                        sb->diag1[m] = prev_diag1;
+                    } else {
+                        vecindex = indices[b + i + 1];
+                        /*
+                         diag1[i] = getFromPdf(pdf, vecstart, numvuv, ceporder, numdeltas, cepnum,
+                         bigpow, meanpowUm, ivarpow, PICOCEP_WANTIVAR, PICOCEP_WANTDELTA2);
+                         */
+                        prev_diag1 = sb->diag1[m] = getFromPdf(pdf, vecindex,
+                                dim, PICOCEP_WANTIVAR, PICOCEP_WANTDELTA2);
+                    }
                     /*
-                     diag1[i] = getFromPdf(pdf, vecstart, numvuv, ceporder, numdeltas, cepnum,
-                     bigpow, meanpowUm, ivarpow, PICOCEP_WANTIVAR, PICOCEP_WANTDELTA2);
+                     k = vecstart +pdf->numvuv+pdf->ceporder*2 +    pdf->numdeltas*3 +
+                     pdf->ceporder*2 +cepnum;
+                     cep->diag1[i] = (picoos_int32)(pdf->content[k]) << pdf->bigpow;
                      */
-                    prev_diag1 = cep->diag1[i] = getFromPdf(pdf, vecstart,
-                            cepnum, PICOCEP_WANTIVAR, PICOCEP_WANTDELTA2);
-                }
-                /*
-                 k = vecstart +pdf->numvuv+pdf->ceporder*2 +    pdf->numdeltas*3 +
-                 pdf->ceporder*2 +cepnum;
-                 cep->diag1[i] = (picoos_int32)(pdf->content[k]) << pdf->bigpow;
-                 */
-            } else {
-                cep->diag1[i] = 0;
-            }
-            if (i > 0) {
-                if (i > 1 && indices[b + i] == indices[b + i - 1]) {
-                    cep->diag1[i] += prev_diag1_1;
                 } else {
-                    vecstart = indices[b + i] * vecsize;
-                    /*
-                     k = vecstart + pdf->numvuv + pdf->ceporder * 2 + pdf->numdeltas * 3 + pdf->ceporder * 2 + cepnum;
-                     cep->diag1[i] += (picoos_int32)(pdf->content[k]) << pdf->bigpow; */
-                    /* cepnum'th delta delta ivar */
-
-                    prev_diag1_1 = getFromPdf(pdf, vecstart, cepnum,
-                            PICOCEP_WANTIVAR, PICOCEP_WANTDELTA2);
-                    cep->diag1[i] += prev_diag1_1;
+                    sb->diag1[m] = 0;
                 }
+                if (i > 0) {
+                    if (i > 1 && indices[b + i] == indices[b + i - 1]) {
+                        sb->diag1[m] += prev_diag1_1;
+                    } else {
+                        vecindex = indices[b + i];
+                        /*
+                         k = vecstart + pdf->numvuv + pdf->ceporder * 2 + pdf->numdeltas * 3 + pdf->ceporder * 2 + cepnum;
+                         cep->diag1[i] += (picoos_int32)(pdf->content[k]) << pdf->bigpow; */
+                        /* cepnum'th delta delta ivar */
+
+                        prev_diag1_1 = getFromPdf(pdf, vecindex, dim,
+                                PICOCEP_WANTIVAR, PICOCEP_WANTDELTA2);
+                        sb->diag1[m] += prev_diag1_1;
+                    }
 
-            } /*i < N-1 */
-            cep->diag1[i] *= -2;
+                } /*i < N-1 */
+                sb->diag1[m] *= -2;
+            }
         }
-    }
 
-    /* calculate diag(A,-2) */
-    for (i = 0; i < N - 2; i++) {
-        if (i > 0 && indices[b + i + 1] == indices[b + i]) {
-            cep->diag2[i] = prev_diag2;
-        } else {
-            vecstart = indices[b + i + 1] * vecsize;
-            /*
-             k = vecstart + pdf->numvuv + pdf->ceporder * 2 + pdf->numdeltas * 3 + pdf->ceporder * 2 + cepnum;
-             cep->diag2[i] = (picoos_int32)(pdf->content[k]) << pdf->bigpow;
-             k -= pdf->ceporder;
-             ivar = (picoos_int32)(pdf->content[k]) << pdf->bigpow;
-             */
-            cep->diag2[i] = getFromPdf(pdf, vecstart, cepnum, PICOCEP_WANTIVAR,
-                    PICOCEP_WANTDELTA2);
-            ivar = getFromPdf(pdf, vecstart, cepnum, PICOCEP_WANTIVAR,
-                    PICOCEP_WANTDELTA);
-            cep->diag2[i] -= (ivar + 2) / 4;
-            prev_diag2 = cep->diag2[i];
+        /* calculate diag(A,-2) */
+        for (i = 0; i < N - 2; i++) {
+            m = i * lanes + l;
+            if (i > 0 && indices[b + i + 1] == indices[b + i]) {
+                sb->diag2[m] = prev_diag2;
+            } else {
+                vecindex = indices[b + i + 1];
+                /*
+                 k = vecstart + pdf->numvuv + pdf->ceporder * 2 + pdf->numdeltas * 3 + pdf->ceporder * 2 + cepnum;
+                 cep->diag2[i] = (picoos_int32)(pdf->content[k]) << pdf->bigpow;
+                 k -= pdf->ceporder;
+                 ivar = (picoos_int32)(pdf->content[k]) << pdf->bigpow;
+                 */
+                sb->diag2[m] = getFromPdf(pdf, vecindex, dim, PICOCEP_WANTIVAR,
+                        PICOCEP_WANTDELTA2);
+                ivar = getFromPdf(pdf, vecindex, dim, PICOCEP_WANTIVAR,
+                        PICOCEP_WANTDELTA);
+                sb->diag2[m] -= (ivar + 2) / 4;
+                prev_diag2 = sb->diag2[m];
+            }
         }
-    }
+    }/* end for l */
 
     return 0;
 }/* makeWUWandWUm */
@@ -1165,7 +1286,7 @@ static picoos_uint8 makeWUWandWUm(cep_subobj_t * cep, picokpdf_PdfMUL pdf,
 /**
  * Retrieve actual values for MGC from PDF resource
  * @param    pdf :  pointer to picoos_uint8, sequence of pdf vectors, each vector of length 1+ceporder*2+numdeltas*3+ceporder*3
- * @param    vecstart : indices of pdf vectors for all frames in current sentence
+ * @param    vecindex : index of the pdf vector
  * @param    cepnum :  cepstral dimension to be treated
  * @param    wantMeanOrIvar :  flag to select mean or variance values
  * @param    wantStaticOrDeltax :  flag to select static or delta values
@@ -1173,16 +1294,24 @@ static picoos_uint8 makeWUWandWUm(cep_subobj_t * cep, picokpdf_PdfMUL pdf,
  * @callgraph
  * @callergraph
  */
-static picoos_int32 getFromPdf(picokpdf_PdfMUL pdf, picoos_uint32 vecstart,
+static picoos_int32 getFromPdf(picokpdf_PdfMUL pdf, picoos_uint16 vecindex,
         picoos_uint8 cepnum, picocep_WantMeanOrIvar_t wantMeanOrIvar,
         picocep_WantStaticOrDelta_t wantStaticOrDeltax)
 {
     picoos_uint8 s, ind;
     picoos_uint8 *p;
     picoos_uint8 ceporder, ceporder2, cc;
-    picoos_uint32 k;
+    picoos_uint32 k, vecstart;
     picoos_int32 mean = 0, ivar = 0;
 
+#if defined(PICOKPDF_PREDECODE)
+    if (NULL != pdf->decoded) {
+        /* (mean, ivar) pairs for static, delta and delta delta, see picokpdf.h */
+        return pdf->decoded[((picoos_uint32) vecindex * pdf->ceporder + cepnum)
+                * PICOKPDF_DEC_ELEMS + 2 * wantStaticOrDeltax + wantMeanOrIvar];
+    }
+#endif
+    vecstart = (picoos_uint32) vecindex * pdf->vecsize;
     if (pdf->numdeltas == 0xFF) {
         switch (wantMeanOrIvar) {
             case PICOCEP_WANTMEAN:
@@ -1368,10 +1497,9 @@ static void getDirect(picokpdf_PdfMUL pdf, picoos_uint16 *indices,
 {
     picoos_uint16 i;
     picoos_uint32 j;
-    picoos_uint32 vecstart;
+    picoos_uint16 vecindex;
     picoos_int32 mean, ivar;
     picoos_int32 prev_mean;
-    picoos_uint8 vecsize = pdf->vecsize;
     picoos_uint8 order = pdf->ceporder;
 
     j = cepnum;
@@ -1380,10 +1508,10 @@ static void getDirect(picokpdf_PdfMUL pdf, picoos_uint16 *indices,
         if (i > 0 && indices[i] == indices[i - 1]) {
             mean = prev_mean;
         } else {
-            vecstart = indices[i] * vecsize;
-            mean = getFromPdf(pdf, vecstart, cepnum, PICOCEP_WANTMEAN,
+            vecindex = indices[i];
+            mean = getFromPdf(pdf, vecindex, cepnum, PICOCEP_WANTMEAN,
                     PICOCEP_WANTSTATIC);
-            ivar = getFromPdf(pdf, vecstart, cepnum, PICOCEP_WANTIVAR,
+            ivar = getFromPdf(pdf, vecindex, cepnum, PICOCEP_WANTIVAR,
                     PICOCEP_WANTSTATIC);
             prev_mean = mean = picocep_fixptdiv(mean, ivar, pdf->bigpow);
         }
@@ -1506,6 +1634,111 @@ static void treat_phone(cep_subobj_t * cep, picodata_itemhead_t * ihead)
     PICODBG_DEBUG(("finished phone, advancing inReadPos to %i",cep->inReadPos));
 }
 
+#if defined(PICOCEP_STREAMING)
+/**
+ * Slides the smoothing window after its active frames have been output: drops all but
+ * PICOCEP_STREAM_HISTORY output frames, which remain as left context for the next solve,
+ * and moves the look-ahead frames and the pending items in headx/cbuf to the window start
+ * @param    cep :  the CEP PU sub object pointer
+ * @callgraph
+ * @callergraph
+ */
+static void slideWindow(cep_subobj_t * cep)
+{
+    picoos_uint16 drop, i, n, cbufStart;
+
+    drop = (cep->activeEndPos > PICOCEP_STREAM_HISTORY) ? cep->activeEndPos
+            - PICOCEP_STREAM_HISTORY : 0;
+
+    /* indices and phone ids */
+    n = cep->indexWritePos - drop;
+    for (i = 0; i < n; i++) {
+        cep->indicesLFZ[i] = cep->indicesLFZ[drop + i];
+        cep->indicesMGC[i] = cep->indicesMGC[drop + i];
+        cep->phoneId[i] = cep->phoneId[drop + i];
+    }
+    cep->indexWritePos = n;
+    cep->indexReadPos = cep->historyEndPos = cep->activeEndPos = cep->activeEndPos
+            - drop;
+
+    /* pending items, all of them are synchronised with frames after activeEndPos */
+    cbufStart = cep->cbufWritePos;
+    for (i = cep->headxBottom; i < cep->headxWritePos; i++) {
+        if ((cep->headx[i].head.len > 0) && (cep->headx[i].cind < cbufStart)) {
+            cbufStart = cep->headx[i].cind;
+        }
+    }
+    n = cep->headxWritePos - cep->headxBottom;
+    for (i = 0; i < n; i++) {
+        cep->headx[i] = cep->headx[cep->headxBottom + i];
+        cep->headx[i].frame -= drop;
+        if (cep->headx[i].head.len > 0) {
+            cep->headx[i].cind -= cbufStart;
+        }
+    }
+    cep->headxBottom = 0;
+    cep->headxWritePos = n;
+    for (i = cbufStart; i < cep->cbufWritePos; i++) {
+        cep->cbuf[i - cbufStart] = cep->cbuf[i];
+    }
+    cep->cbufWritePos -= cbufStart;
+}
+#endif
+
+/**
+ * Smooths the coefficients of one job of the current phrase (cep->smoothN frames):
+ * jobs 0..lfz ceporder-1 are the f0 dimensions, the following jobs are groups of up to
+ * cep->smoothLanes mgc dimensions. Jobs write disjoint coefficients and use the working
+ * arrays of the worker running them, so they may run concurrently
+ * @param    ctx :  the CEP PU sub object pointer
+ * @param    job :  the job number
+ * @param    worker :  the worker running the job
+ * @callgraph
+ * @callergraph
+ */
+static void smoothJob(void * ctx, picopal_uint16 job, picopal_uint8 worker)
+{
+    cep_subobj_t * cep = (cep_subobj_t *) ctx;
+    cep_smoothbuf_t * sb = cep->workerbuf[worker];
+    picokpdf_PdfMUL pdf;
+    picoos_uint16 * indices;
+    picoos_int16 * smoothcep;
+    picoos_uint16 N = cep->smoothN;
+    picoos_uint8 cepnum, lanes, l, invpow, invDoubleDec;
+
+    if (job < cep->pdflfz->ceporder) {
+        pdf = cep->pdflfz;
+        indices = cep->indicesLFZ;
+        smoothcep = cep->outF0 + cep->outF0WritePos;
+        cepnum = (picoos_uint8) job;
+        lanes = 1;
+        invpow = PICOCEP_LFZINVPOW;
+        invDoubleDec = PICOCEP_LFZDOUBLEDEC;
+    } else {
+        pdf = cep->pdfmgc;
+        indices = cep->indicesMGC;
+        smoothcep = cep->outXCep + cep->outXCepWritePos;
+        cepnum = (picoos_uint8) ((job - cep->pdflfz->ceporder) * cep->smoothLanes);
+        lanes = pdf->ceporder - cepnum;
+        if (lanes > cep->smoothLanes) {
+            lanes = cep->smoothLanes;
+        }
+        invpow = PICOCEP_MGCINVPOW;
+        invDoubleDec = PICOCEP_MGCDOUBLEDEC;
+    }
+
+    if (cep->activeEndPos <= 0) {
+        /* do nothing */
+    } else if (3 < N) {
+        makeWUWandWUm(cep, sb, pdf, indices, 0, N, cepnum, lanes); /* update diag0, diag1, diag2, WUm */
+        invMatrix(sb, N, smoothcep, cepnum, lanes, pdf, invpow, invDoubleDec);
+    } else {
+        for (l = 0; l < lanes; l++) {
+            getDirect(pdf, indices, cep->activeEndPos, cepnum + l, smoothcep);
+        }
+    }
+}
+
 /**
  * Returns true if an Item has to be forwarded to next PU
  * @param   ihead : pointer to item head structure
@@ -1673,6 +1906,16 @@ static picodata_step_result_t cepStep(register picodata_ProcessingUnit this,
                     /* it is a phone */
                     PICODBG_DEBUG(("cep: PARSE treating PHONE"));
                     treat_phone(cep, &ihead);
+#if defined(PICOCEP_STREAMING)
+                    if (cep->indexWritePos >= cep->historyEndPos
+                            + PICOCEP_STREAM_BLOCK + PICOCEP_STREAM_LOOKAHEAD) {
+                        /* enough right context: smooth the window and output all but the look-ahead */
+                        cep->activeEndPos = cep->indexWritePos
+                                - PICOCEP_STREAM_LOOKAHEAD;
+                        PICODBG_DEBUG(("cep: PARSE streaming window full; setting activeEndPos to %i",cep->activeEndPos));
+                        cep->procState = PICOCEP_STEPSTATE_PROCESS_SMOOTH;
+                    }
+#endif
 
                 } else {
                     if ((PICODATA_ITEM_CMD == ihead.type)
@@ -1732,6 +1975,9 @@ static picodata_step_result_t cepStep(register picodata_ProcessingUnit this,
                             cep->headxWritePos++;
                         } else {
                             /* buffer full, smooth and output whatever we got */
+#if defined(PICOCEP_STREAMING)
+                            cep->activeEndPos = cep->indexWritePos;
+#endif
                             PICODBG_DEBUG(("PARSE is forced to smooth prematurely; setting activeEndPos to %i", cep->activeEndPos));
                             cep->procState = PICOCEP_STEPSTATE_PROCESS_SMOOTH;
                             /* don't consume item yet */
@@ -1751,10 +1997,13 @@ static picodata_step_result_t cepStep(register picodata_ProcessingUnit this,
                     picokpdf_PdfMUL pdf;
 
                     /* picoos_uint16 framesTreated = 0; */
-                    picoos_uint8 cepnum;
                     picoos_uint16 N;
 
+#if defined(PICOCEP_STREAMING)
+                    N = cep->indexWritePos; /* numframes in current window, including left context and look-ahead */
+#else
                     N = cep->activeEndPos; /* numframes in current step */
+#endif
 
                     /* the range to be smoothed starts at 0 and is N long */
 
@@ -1768,42 +2017,18 @@ static picodata_step_result_t cepStep(register picodata_ProcessingUnit this,
 
                     PICODBG_DEBUG(("smoothing %d frames\n", N));
 
-                    /* smooth f0 */
-                    pdf = cep->pdflfz;
-                    for (cepnum = 0; cepnum < pdf->ceporder; cepnum++) {
-                        if (cep->activeEndPos <= 0) {
-                            /* do nothing */
-                        } else if (3 < N) {
-                            makeWUWandWUm(cep, pdf, cep->indicesLFZ, 0, N,
-                                    cepnum); /* update diag0, diag1, diag2, WUm */
-                            invMatrix(cep, N, cep->outF0 + cep->outF0WritePos, cepnum, pdf,
-                                    PICOCEP_LFZINVPOW, PICOCEP_LFZDOUBLEDEC);
-                        } else {
-                            getDirect(pdf, cep->indicesLFZ, cep->activeEndPos,
-                                    cepnum, cep->outF0 + cep->outF0WritePos);
-                        }
-                    }/* end for cepnum  */
-                    cep->outF0WritePos += cep->activeEndPos * pdf->ceporder;
+                    /* smooth f0 and mgc, several mgc dimensions at a time if the phrase is short enough;
+                     * the jobs are independent and may run on several workers */
+                    cep->smoothN = N;
+                    cep->smoothLanes = ((picoos_uint32) N * PICOCEP_SMOOTH_LANES
+                            <= PICOCEP_MAXWINLEN) ? PICOCEP_SMOOTH_LANES : 1;
+                    picoos_jobpool_run(cep->pool, smoothJob, cep, cep->pdflfz->ceporder
+                            + (cep->pdfmgc->ceporder + cep->smoothLanes - 1)
+                                    / cep->smoothLanes);
+                    cep->outF0WritePos += cep->activeEndPos * cep->pdflfz->ceporder;
+                    cep->outXCepWritePos += cep->activeEndPos * cep->pdfmgc->ceporder;
 
-                    /* smooth mgc */
                     pdf = cep->pdfmgc;
-                    for (cepnum = 0; cepnum < pdf->ceporder; cepnum++) {
-                        if (cep->activeEndPos <= 0) {
-                            /* do nothing */
-                        } else if (3 < N) {
-                            makeWUWandWUm(cep, pdf, cep->indicesMGC, 0, N,
-                                    cepnum); /* update diag0, diag1, diag2, WUm */
-                            invMatrix(cep, N, cep->outXCep
-                                            + cep->outXCepWritePos, cepnum,
-                                    pdf, PICOCEP_MGCINVPOW,
-                                    PICOCEP_MGCDOUBLEDEC);
-                        } else {
-                            getDirect(pdf, cep->indicesMGC, cep->activeEndPos,
-                                    cepnum, cep->outXCep + cep->outXCepWritePos);
-                        }
-                    }/* end for cepnum  */
-                    cep->outXCepWritePos += cep->activeEndPos * pdf->ceporder;
-
                     getVoiced(pdf, cep->indicesMGC, cep->activeEndPos, cep->outVoiced
                                     + cep->outVoicedWritePos);
                     cep->outVoicedWritePos += cep->activeEndPos;
@@ -1811,7 +2036,16 @@ static picodata_step_result_t cepStep(register picodata_ProcessingUnit this,
                 }
                 /* setting indexReadPos to the next active index to be used. (will be advanced by FRAME when
                  * reading the phoneId */
+#if defined(PICOCEP_STREAMING)
+                /* skip the left context, it has been output with the previous window */
+                cep->indexReadPos = cep->historyEndPos;
+                cep->outF0ReadPos = cep->historyEndPos * cep->pdflfz->ceporder;
+                cep->outVoicedReadPos = cep->historyEndPos; /* one per frame */
+                cep->outXCepReadPos = (picoos_uint32) cep->historyEndPos
+                        * cep->pdfmgc->ceporder;
+#else
                 cep->indexReadPos = 0;
+#endif
                 cep->procState = PICOCEP_STEPSTATE_PROCESS_FRAME;
                 return PICODATA_PU_BUSY; /*data to feed*/
 
@@ -1959,12 +2193,20 @@ static picodata_step_result_t cepStep(register picodata_ProcessingUnit this,
                     cep->sentenceEnd = FALSE;
                     cep->indexReadPos = cep->indexWritePos = 0;
                     cep->activeEndPos = PICOCEP_MAXWINLEN;
+#if defined(PICOCEP_STREAMING)
+                    cep->historyEndPos = 0;
+#endif
                     cep->headxBottom = cep->headxWritePos = 0;
                     cep->cbufWritePos = 0;
                     cep->procState = PICOCEP_STEPSTATE_PROCESS_PARSE;
                 } else {
                     /*------------  no more frames can be output but sentence end not reached ----------------------------------------*/
+#if defined(PICOCEP_STREAMING)
+                    PICODBG_DEBUG(("FRAME window output, sliding window"));
+                    slideWindow(cep);
+#else
                     PICODBG_DEBUG(("Maximum number of frames per sentence reached"));
+#endif
                     cep->procState = PICOCEP_STEPSTATE_PROCESS_PARSE;
                 }
                 /*----------------------------------------------------*/
@@ -72,6 +72,11 @@ extern "C" {
  *  a sequence of Processing Units (of possibly different
  *  implementations) exchanging data via CharBuffers
  * ---------------------------------------------------------*/
+#if defined(PICOCTRL_ITEM_CAPTURE)
+#define CTRL_CAP_HEADSIZE 8
+#define CTRL_CAP_STAMPSIZE 4
+#endif
+
 /* control sub-object */
 typedef struct ctrl_subobj {
     picoos_uint8 numProcUnits;
@@ -80,8 +85,816 @@ typedef struct ctrl_subobj {
     picodata_ProcessingUnit procUnit [PICOCTRL_MAX_PROC_UNITS];
     picodata_step_result_t procStatus [PICOCTRL_MAX_PROC_UNITS];
     picodata_CharBuffer procCbOut [PICOCTRL_MAX_PROC_UNITS];
+    picoos_bool textOpen;       /* text fed since the last '\0' */
+    /* phoneme input (see picoctrl_engFeedPhonemes) */
+    picoos_uint8 sphoPU;        /* index of the PU taking the phoneme items */
+    picotrns_SimpleTransducer phonTransducer; /* NULL until first used */
+    picoos_uint8 * phonItems;   /* PICOCTRL_PHONEME_BUFSIZE bytes */
+    picoos_uint16 phonLen;      /* bytes of items, 0 if none pending */
+    picoos_uint16 phonPos;      /* bytes of items already passed on */
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+    struct ctrl_framecache * fc; /* NULL if running without frame cache */
+#endif
+#if defined(PICOCTRL_ITEM_CAPTURE)
+    /* item capture and replay (see picoctrl_engStartCapture) */
+    picoos_uint8 procType [PICOCTRL_MAX_PROC_UNITS];
+    picoos_File capFile;        /* NULL if not capturing */
+    picoos_uint8 capPU;         /* PU whose input is captured */
+    picopal_uint32 capSec, capUsec; /* start of the capture */
+    picoos_File repFile;        /* NULL if not replaying */
+    picoos_uint8 repPU;         /* PU the replayed items are put to */
+    picoos_uint16 repLen;       /* bytes in repItem, 0 if none read ahead */
+    picoos_uint8 repItem[CTRL_CAP_STAMPSIZE + PICODATA_MAX_ITEMSIZE];
+#endif
 } ctrl_subobj_t;
 
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+/*----------------------------------------------------------
+ *  frame cache
+ *  keeps the item stream put by the last but one PU (cep) to
+ *  the last PU (sig) for recently spoken text units. A unit
+ *  fed again is not passed to the first PU; its stream is put
+ *  to the input of the last PU instead.
+ * ---------------------------------------------------------*/
+typedef struct ctrl_fcentry {
+    struct ctrl_fcentry * next;
+    picoos_uint32 hash;
+    picoos_uint16 textLen;
+    picoos_uint32 streamLen;
+    /* followed by textLen bytes of text and streamLen bytes of items */
+} ctrl_fcentry_t;
+
+typedef struct ctrl_framecache {
+    picoos_MemoryManager mm;
+    ctrl_fcentry_t * entries;   /* most recently used first */
+
+    ctrl_fcentry_t * replay;    /* entry being replayed */
+    picoos_uint32 replayPos;
+
+    picoos_bool unitStart;      /* no text since the last '\0' */
+    picoos_bool capturing;
+    picoos_uint16 textLeft;     /* bytes of the captured unit still to feed */
+    picoos_uint32 hash;
+    picoos_uint16 textLen;
+    picoos_uint8 text[PICOCTRL_FRAME_CACHE_MAX_TEXT];
+    picoos_uint32 streamLen;
+    picoos_uint8 * stream;      /* PICOCTRL_FRAME_CACHE_MAX_STREAM bytes */
+} ctrl_framecache_t;
+
+/* all PUs but the last are idle and have no input pending */
+static picoos_bool ctrlFcUpstreamIdle(ctrl_subobj_t * ctrl)
+{
+    picoos_uint8 i;
+
+    for (i = 0; i < ctrl->numProcUnits - 1; i++) {
+        if (PICODATA_PU_IDLE != ctrl->procStatus[i]) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* records the items put to the input of the last PU while capturing */
+static void ctrlFcTap(void * tapObj, const picoos_uint8 * item,
+        picoos_uint16 len)
+{
+    ctrl_framecache_t * fc = (ctrl_framecache_t *) tapObj;
+
+    if (fc->capturing) {
+        if (fc->streamLen + len <= PICOCTRL_FRAME_CACHE_MAX_STREAM) {
+            picoos_mem_copy(item, fc->stream + fc->streamLen, len);
+            fc->streamLen += len;
+        } else {
+            /* too long to be cached */
+            fc->capturing = FALSE;
+        }
+    }
+}
+
+/* stores the captured unit as most recently used entry, dropping the least
+ * recently used ones as far as needed */
+static void ctrlFcInsert(ctrl_framecache_t * fc)
+{
+    ctrl_fcentry_t * e;
+    ctrl_fcentry_t ** last;
+    picoos_uint8 * data;
+
+    while ((NULL == (e = picoos_allocate(fc->mm, sizeof(ctrl_fcentry_t)
+            + fc->textLen + fc->streamLen))) && (NULL != fc->entries)) {
+        last = &fc->entries;
+        while (NULL != (*last)->next) {
+            last = &(*last)->next;
+        }
+        picoos_deallocate(fc->mm, (void *) last);
+    }
+    if (NULL == e) {
+        PICODBG_WARN(("frame cache too small for %i bytes", fc->streamLen));
+        return;
+    }
+    e->hash = fc->hash;
+    e->textLen = fc->textLen;
+    e->streamLen = fc->streamLen;
+    data = (picoos_uint8 *) (e + 1);
+    picoos_mem_copy(fc->text, data, fc->textLen);
+    picoos_mem_copy(fc->stream, data + fc->textLen, fc->streamLen);
+    e->next = fc->entries;
+    fc->entries = e;
+}
+
+/* finishes the capture once the unit has passed all PUs but the last */
+static void ctrlFcCheckCapture(ctrl_subobj_t * ctrl)
+{
+    ctrl_framecache_t * fc = ctrl->fc;
+
+    if (fc->capturing && (0 == fc->textLeft) && ctrlFcUpstreamIdle(ctrl)) {
+        fc->capturing = FALSE;
+        ctrlFcInsert(fc);
+    }
+}
+
+/* puts as much of the replayed stream as fits to the input of the last PU */
+static void ctrlFcReplay(ctrl_subobj_t * ctrl)
+{
+    ctrl_framecache_t * fc = ctrl->fc;
+    ctrl_fcentry_t * e = fc->replay;
+    picoos_uint8 lastPU = ctrl->numProcUnits - 1;
+    picoos_uint8 * stream = (picoos_uint8 *) (e + 1) + e->textLen;
+    picoos_uint16 blen;
+    picoos_bool put = FALSE;
+
+    while ((fc->replayPos < e->streamLen) && (PICO_OK == picodata_cbPutItem(
+            ctrl->procCbOut[lastPU - 1], stream + fc->replayPos,
+            (picoos_uint16) (e->streamLen - fc->replayPos), &blen))) {
+        fc->replayPos += blen;
+        put = TRUE;
+    }
+    if (put) {
+        ctrl->procStatus[lastPU] = PICODATA_PU_BUSY;
+        ctrl->curPU = lastPU;
+    }
+    if (fc->replayPos >= e->streamLen) {
+        fc->replay = NULL;
+    }
+}
+
+/* feeds text to cbIn; a complete unit at the start of 'text' is replayed
+ * if cached and captured otherwise */
+static pico_status_t ctrlFcFeedText(ctrl_subobj_t * ctrl,
+        picodata_CharBuffer cbIn, picoos_char * text, picoos_int16 textSize,
+        picoos_int16 * bytesPut)
+{
+    ctrl_framecache_t * fc = ctrl->fc;
+    ctrl_fcentry_t ** pe;
+    picoos_int16 len;
+    picoos_uint32 hash;
+
+    *bytesPut = 0;
+    if ((NULL != fc->replay) || (fc->capturing && (0 == fc->textLeft))) {
+        /* the pending unit must pass the PUs before the last one first */
+        return PICO_OK;
+    }
+    if (fc->unitStart && !fc->capturing && ctrlFcUpstreamIdle(ctrl)) {
+        hash = 2166136261u;  /* FNV-1a */
+        for (len = 0; (len < textSize) && (len < PICOCTRL_FRAME_CACHE_MAX_TEXT)
+                && ('\0' != text[len]); len++) {
+            hash = (hash ^ (picoos_uint8) text[len]) * 16777619u;
+        }
+        if ((len > 0) && (len < textSize) && ('\0' == text[len])) {
+            pe = &fc->entries;
+            while ((NULL != *pe) && (((*pe)->hash != hash)
+                    || ((*pe)->textLen != len) || (0 != picoos_strncmp(
+                    (picoos_char *) (*pe + 1), text, len)))) {
+                pe = &(*pe)->next;
+            }
+            if (NULL != *pe) {
+                fc->replay = *pe;
+                *pe = fc->replay->next;
+                fc->replay->next = fc->entries;
+                fc->entries = fc->replay;
+                fc->replayPos = 0;
+                *bytesPut = len + 1;
+                return PICO_OK;
+            }
+            fc->capturing = TRUE;
+            fc->hash = hash;
+            fc->textLen = len;
+            fc->textLeft = len + 1;
+            fc->streamLen = 0;
+            picoos_mem_copy(text, fc->text, len);
+        }
+    }
+    while ((*bytesPut < textSize)
+            && !(fc->capturing && (0 == fc->textLeft))
+            && (PICO_OK == picodata_cbPutCh(cbIn, text[*bytesPut]))) {
+        fc->unitStart = ('\0' == text[*bytesPut]);
+        if (fc->capturing) {
+            fc->textLeft--;
+        }
+        (*bytesPut)++;
+    }
+    return PICO_OK;
+}
+
+/* sets up the frame cache in 'size' bytes of 'mem' */
+static void ctrlFcAttach(ctrl_subobj_t * ctrl, void * mem, picoos_objsize_t size)
+{
+    picoos_MemoryManager mm;
+    ctrl_framecache_t * fc = NULL;
+
+    mm = picoos_newMemoryManager(mem, size, /*enableMemProt*/ FALSE);
+    if (NULL != mm) {
+        fc = picoos_allocate(mm, sizeof(ctrl_framecache_t));
+    }
+    if (NULL != fc) {
+        fc->mm = mm;
+        fc->entries = NULL;
+        fc->replay = NULL;
+        fc->unitStart = TRUE;
+        fc->capturing = FALSE;
+        fc->stream = picoos_allocate(mm, PICOCTRL_FRAME_CACHE_MAX_STREAM);
+        if (NULL == fc->stream) {
+            fc = NULL;
+        }
+    }
+    if (NULL == fc) {
+        PICODBG_WARN(("frame cache memory too small, running without"));
+        return;
+    }
+    ctrl->fc = fc;
+    picodata_cbSetTap(ctrl->procCbOut[ctrl->numProcUnits - 2], ctrlFcTap, fc);
+}
+#endif
+
+/*----------------------------------------------------------
+ *  phoneme input
+ *  a phonetic transcription is turned into the items the
+ *  acph PU would produce and put to the input of the spho
+ *  PU once the PUs before it are idle.
+ * ---------------------------------------------------------*/
+#define CTRL_PHON_IS_BLANK(ch) \
+    ((' ' == (ch)) || ('\t' == (ch)) || ('\n' == (ch)) || ('\r' == (ch)))
+
+/* appends an item to the phoneme items */
+static picoos_bool ctrlPhonPutItem(ctrl_subobj_t * ctrl, picoos_uint8 type,
+        picoos_uint8 info1, picoos_uint8 info2,
+        const picoos_uint8 * content, picoos_uint8 len)
+{
+    picoos_uint8 * item;
+
+    if (ctrl->phonLen + PICODATA_ITEM_HEADSIZE + len > PICOCTRL_PHONEME_BUFSIZE) {
+        return FALSE;
+    }
+    item = ctrl->phonItems + ctrl->phonLen;
+    item[PICODATA_ITEMIND_TYPE] = type;
+    item[PICODATA_ITEMIND_INFO1] = info1;
+    item[PICODATA_ITEMIND_INFO2] = info2;
+    item[PICODATA_ITEMIND_LEN] = len;
+    picoos_mem_copy(content, item + PICODATA_ITEM_HEADSIZE, len);
+    ctrl->phonLen += PICODATA_ITEM_HEADSIZE + len;
+    return TRUE;
+}
+
+/* appends a CMD item with a little endian uint16 value */
+static picoos_bool ctrlPhonPutCmd(ctrl_subobj_t * ctrl, picoos_uint8 info1,
+        picoos_uint8 info2, picoos_uint16 value)
+{
+    picoos_uint8 content[2];
+    picoos_uint32 pos = 0;
+
+    picoos_write_mem_pi_uint16(content, &pos, value);
+    return ctrlPhonPutItem(ctrl, PICODATA_ITEM_CMD, info1, info2, content, 2);
+}
+
+/* applies the word level transducers of the voice to the phoneme ids of a
+ * word (syllabification, stress placement), as the sa PU does for the words
+ * it outputs */
+static pico_status_t ctrlPhonTransduceWord(register picodata_ProcessingUnit this,
+        picoos_uint8 * ids, picoos_uint32 maxIds)
+{
+    ctrl_subobj_t * ctrl = (ctrl_subobj_t *) this->subObj;
+    picoknow_kb_id_t fstKbIds[PICOKNOW_MAX_NUM_WPHO_FSTS] = PICOKNOW_KBID_WPHO_ARRAY;
+    picoktab_FixedIds fixedIds;
+    picokfst_FST fst;
+    picoos_char term[2];
+    picoos_uint8 i;
+    pico_status_t status;
+
+    fixedIds = picoktab_getFixedIds(this->voice->kbArray[PICOKNOW_KBID_FIXED_IDS]);
+    if (NULL == fixedIds) {
+        return PICO_OK;
+    }
+    picotrns_stInitialize(ctrl->phonTransducer);
+    term[1] = NULLC;
+    term[0] = (picoos_char) fixedIds->phonStartId;
+    status = picotrns_stAddWithPlane(ctrl->phonTransducer, term,
+            PICOKFST_PLANE_INTERN);
+    if (PICO_OK == status) {
+        status = picotrns_stAddWithPlane(ctrl->phonTransducer,
+                (picoos_char *) ids, PICOKFST_PLANE_PHONEMES);
+    }
+    if (PICO_OK == status) {
+        term[0] = (picoos_char) fixedIds->phonTermId;
+        status = picotrns_stAddWithPlane(ctrl->phonTransducer, term,
+                PICOKFST_PLANE_INTERN);
+    }
+    for (i = 0; (PICO_OK == status) && (i < PICOKNOW_MAX_NUM_WPHO_FSTS); i++) {
+        fst = picokfst_getFST(this->voice->kbArray[fstKbIds[i]]);
+        if (NULL != fst) {
+            status = picotrns_stTransduce(ctrl->phonTransducer, fst);
+        }
+    }
+    if (PICO_OK == status) {
+        status = picotrns_stGetSymSequenceOfPlane(ctrl->phonTransducer,
+                PICOKFST_PLANE_PHONEMES, ids, maxIds);
+    }
+    return status;
+}
+
+/* offset of the next WORDPHON item after the item at 'pos' within the same
+ * sentence, ctrl->phonLen if there is none */
+static picoos_uint16 ctrlPhonNextWord(ctrl_subobj_t * ctrl, picoos_uint16 pos)
+{
+    picoos_uint8 * item;
+
+    while (TRUE) {
+        pos += PICODATA_ITEM_HEADSIZE
+                + ctrl->phonItems[pos + PICODATA_ITEMIND_LEN];
+        if (pos >= ctrl->phonLen) {
+            return ctrl->phonLen;
+        }
+        item = ctrl->phonItems + pos;
+        if (PICODATA_ITEM_WORDPHON == item[PICODATA_ITEMIND_TYPE]) {
+            return pos;
+        }
+        if ((PICODATA_ITEM_BOUND == item[PICODATA_ITEMIND_TYPE])
+                && (PICODATA_ITEMINFO1_BOUND_SEND == item[PICODATA_ITEMIND_INFO1])) {
+            return ctrl->phonLen;
+        }
+    }
+}
+
+/* disambiguates the POS of the words of the sentence starting at 'sbeg',
+ * left to right with the POS tree of the voice, as the sa PU does for the
+ * words of phoneme markup */
+static void ctrlPhonDisambPos(register picodata_ProcessingUnit this,
+        picoos_uint16 sbeg)
+{
+    ctrl_subobj_t * ctrl = (ctrl_subobj_t *) this->subObj;
+    picokdt_DtPosD dtposd;
+    picoktab_Pos tabpos;
+    picokdt_classify_result_t dtres;
+    picoos_uint8 half_nratt_posd = PICOKDT_NRATT_POSD >> 1;
+    picoos_uint16 valbuf[PICOKDT_NRATT_POSD];
+    picoos_uint16 prevout = PICOKDT_HISTORY_ZERO;
+    picoos_uint16 fallback;
+    picoos_uint16 cur, right;
+    picoos_uint8 i;
+
+    dtposd = picokdt_getDtPosD(this->voice->kbArray[PICOKNOW_KBID_DT_POSD]);
+    tabpos = picoktab_getPos(this->voice->kbArray[PICOKNOW_KBID_TAB_POS]);
+    cur = ctrlPhonNextWord(ctrl, sbeg);
+    if ((NULL == dtposd) || (NULL == tabpos) || (cur >= ctrl->phonLen)) {
+        return;
+    }
+    for (i = 0; i <= half_nratt_posd; i++) {
+        valbuf[i] = PICOKDT_HISTORY_ZERO;
+    }
+    /* POS of the current word and of the following ones, shifted below */
+    right = cur;
+    valbuf[half_nratt_posd+1] = ctrl->phonItems[cur + PICODATA_ITEMIND_INFO1];
+    for (i = half_nratt_posd+2; i < PICOKDT_NRATT_POSD; i++) {
+        right = ctrlPhonNextWord(ctrl, right);
+        valbuf[i] = (right < ctrl->phonLen)
+                ? ctrl->phonItems[right + PICODATA_ITEMIND_INFO1] : PICOKDT_EPSILON;
+    }
+
+    for (; cur < ctrl->phonLen; cur = ctrlPhonNextWord(ctrl, cur)) {
+        for (i = 1; i < half_nratt_posd; i++) {
+            valbuf[i-1] = valbuf[i];
+        }
+        valbuf[half_nratt_posd-1] = prevout;
+        for (i = half_nratt_posd+1; i < PICOKDT_NRATT_POSD; i++) {
+            valbuf[i-1] = valbuf[i];
+        }
+        if (right < ctrl->phonLen) {
+            right = ctrlPhonNextWord(ctrl, right);
+        }
+        valbuf[PICOKDT_NRATT_POSD-1] = (right < ctrl->phonLen)
+                ? ctrl->phonItems[right + PICODATA_ITEMIND_INFO1] : PICOKDT_EPSILON;
+
+        if (picoktab_isUniquePos(tabpos, (picoos_uint8) valbuf[half_nratt_posd])) {
+            fallback = 0;
+            if (!picokdt_dtPosDreverseMapOutFixed(dtposd,
+                    valbuf[half_nratt_posd], &prevout, &fallback)) {
+                prevout = (fallback) ? fallback : valbuf[half_nratt_posd];
+            }
+        } else if (picokdt_dtPosDconstructInVec(dtposd, valbuf)
+                && picokdt_dtPosDclassify(dtposd, &prevout)
+                && picokdt_dtPosDdecomposeOutClass(dtposd, &dtres)
+                && dtres.set && (dtres.class <= 255)) {
+            ctrl->phonItems[cur + PICODATA_ITEMIND_INFO1] = (picoos_uint8) dtres.class;
+        }
+    }
+}
+
+/* translates 'phonemes' into ctrl->phonItems */
+static pico_status_t ctrlPhonParse(register picodata_ProcessingUnit this,
+        const picoos_char * phonemes, picoos_int16 size)
+{
+    ctrl_subobj_t * ctrl = (ctrl_subobj_t *) this->subObj;
+    picoos_uchar token[PICOCTRL_PHONEME_MAX_WORD + 1];
+    picoos_uint8 ids[256];
+    picoos_int16 i = 0, len;
+    picoos_uint16 pending = 0;  /* bound item waiting for its phrase type */
+    picoos_bool inSentence = FALSE;
+    picoos_bool ok = TRUE;
+    picoos_uint8 modified = 0; /* settings changed: 1 pitch, 2 speed, 4 volume */
+    picoos_uint8 acc, cmd;
+    picoos_uint16 value;
+    picoos_int16 j = 0;
+    pico_status_t status = PICO_OK;
+
+    ctrl->phonLen = 0;
+    ctrl->phonPos = 0;
+    while (ok && (PICO_OK == status)) {
+        while ((i < size) && CTRL_PHON_IS_BLANK(phonemes[i])) {
+            i++;
+        }
+        if ((i >= size) || (NULLC == phonemes[i])) {
+            break;
+        }
+        len = 0;
+        while ((i < size) && (NULLC != phonemes[i])
+                && !CTRL_PHON_IS_BLANK(phonemes[i])) {
+            if (len < PICOCTRL_PHONEME_MAX_WORD) {
+                token[len] = phonemes[i];
+            }
+            len++;
+            i++;
+        }
+        if (len > PICOCTRL_PHONEME_MAX_WORD) {
+            token[PICOCTRL_PHONEME_MAX_WORD] = NULLC;
+            picoos_emRaiseWarning(this->common->em, PICO_ERR_INVALID_ARGUMENT,
+                    NULL, (picoos_char *) "phonemes too long (%s...)", token);
+            status = PICO_ERR_INVALID_ARGUMENT;
+            break;
+        }
+        token[len] = NULLC;
+
+        /* sentence end */
+        if ((1 == len) && (('.' == token[0]) || ('?' == token[0])
+                || ('!' == token[0]))) {
+            if (inSentence) {
+                ctrl->phonItems[pending + PICODATA_ITEMIND_INFO2] =
+                        ('?' == token[0]) ? PICODATA_ITEMINFO2_BOUNDTYPE_Q
+                        : ('!' == token[0]) ? PICODATA_ITEMINFO2_BOUNDTYPE_E
+                        : PICODATA_ITEMINFO2_BOUNDTYPE_T;
+                ok = ctrlPhonPutItem(ctrl, PICODATA_ITEM_BOUND,
+                        PICODATA_ITEMINFO1_BOUND_SEND, PICODATA_ITEMINFO2_NA,
+                        NULL, 0);
+                inSentence = FALSE;
+            }
+            continue;
+        }
+        if (!inSentence) {
+            pending = ctrl->phonLen;
+            ok = ctrlPhonPutItem(ctrl, PICODATA_ITEM_BOUND,
+                    PICODATA_ITEMINFO1_BOUND_SBEG,
+                    PICODATA_ITEMINFO2_BOUNDTYPE_T, NULL, 0);
+            inSentence = TRUE;
+        }
+
+        if (('|' == token[0]) && ((1 == len) || ((2 == len) && ('|' == token[1])))) {
+            /* phrase boundary; the phrase before is not the last one */
+            ctrl->phonItems[pending + PICODATA_ITEMIND_INFO2] =
+                    PICODATA_ITEMINFO2_BOUNDTYPE_P;
+            pending = ctrl->phonLen;
+            ok = ok && ctrlPhonPutItem(ctrl, PICODATA_ITEM_BOUND,
+                    (1 == len) ? PICODATA_ITEMINFO1_BOUND_PHR3
+                    : PICODATA_ITEMINFO1_BOUND_PHR1,
+                    PICODATA_ITEMINFO2_BOUNDTYPE_T, NULL, 0);
+
+        } else if ('#' == token[0]) {
+            /* #pitch=, #speed=, #volume= (percent) or #break= (ms) */
+            cmd = 0;
+            if (0 == picoos_strncmp((picoos_char *) token, (picoos_char *) "#pitch=", 7)) {
+                cmd = PICODATA_ITEMINFO1_CMD_PITCH;
+                j = 7;
+            } else if (0 == picoos_strncmp((picoos_char *) token, (picoos_char *) "#speed=", 7)) {
+                cmd = PICODATA_ITEMINFO1_CMD_SPEED;
+                j = 7;
+            } else if (0 == picoos_strncmp((picoos_char *) token, (picoos_char *) "#volume=", 8)) {
+                cmd = PICODATA_ITEMINFO1_CMD_VOLUME;
+                j = 8;
+            } else if (0 == picoos_strncmp((picoos_char *) token, (picoos_char *) "#break=", 7)) {
+                cmd = PICODATA_ITEMINFO1_CMD_SIL;
+                j = 7;
+            }
+            value = 0;
+            if ((0 != cmd) && (j < len)) {
+                while ((j < len) && (token[j] >= '0') && (token[j] <= '9')
+                        && (value < 10000)) {
+                    value = value * 10 + (token[j] - '0');
+                    j++;
+                }
+            }
+            if ((0 == cmd) || (j < len) || (0 == value)) {
+                picoos_emRaiseWarning(this->common->em, PICO_ERR_INVALID_ARGUMENT,
+                        NULL, (picoos_char *) "illegal phoneme command (%s)", token);
+                status = PICO_ERR_INVALID_ARGUMENT;
+            } else if (PICODATA_ITEMINFO1_CMD_SIL == cmd) {
+                ok = ok && ctrlPhonPutCmd(ctrl, cmd, PICODATA_ITEMINFO2_NA, value);
+            } else {
+                modified |= (PICODATA_ITEMINFO1_CMD_PITCH == cmd) ? 1
+                        : (PICODATA_ITEMINFO1_CMD_SPEED == cmd) ? 2 : 4;
+                ok = ok && ctrlPhonPutCmd(ctrl, cmd,
+                        PICODATA_ITEMINFO2_CMD_ABSOLUTE, value);
+            }
+
+        } else {
+            /* word, possibly with "/accent" */
+            acc = PICODATA_ACC1;
+            if ((len > 2) && ('/' == token[len - 2]) && (token[len - 1] >= '0')
+                    && (token[len - 1] <= '4')) {
+                acc = PICODATA_ACC0 + (token[len - 1] - '0');
+                len -= 2;
+                token[len] = NULLC;
+            }
+            status = picodata_mapPAStrToPAIds(ctrl->phonTransducer,
+                    this->common,
+                    picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_XSAMPA_PARSE]),
+                    picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_SVOXPA_PARSE]),
+                    picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_XSAMPA2SVOXPA]),
+                    token, PICODATA_XSAMPA, ids, sizeof(ids) - 1);
+            if (PICO_OK == status) {
+                status = ctrlPhonTransduceWord(this, ids, sizeof(ids) - 1);
+            }
+            if (PICO_OK != status) {
+                status = PICO_ERR_INVALID_ARGUMENT;
+            } else if (NULLC != ids[0]) {
+                ok = ok && ctrlPhonPutItem(ctrl, PICODATA_ITEM_WORDPHON,
+                        PICODATA_POS_XX, acc, ids,
+                        (picoos_uint8) picoos_strlen((picoos_char *) ids));
+            }
+        }
+    }
+
+    if (PICO_OK == status) {
+        for (j = 0; j < ctrl->phonLen; j += PICODATA_ITEM_HEADSIZE
+                + ctrl->phonItems[j + PICODATA_ITEMIND_LEN]) {
+            if ((PICODATA_ITEM_BOUND == ctrl->phonItems[j + PICODATA_ITEMIND_TYPE])
+                    && (PICODATA_ITEMINFO1_BOUND_SBEG
+                            == ctrl->phonItems[j + PICODATA_ITEMIND_INFO1])) {
+                ctrlPhonDisambPos(this, (picoos_uint16) j);
+            }
+        }
+        /* leave the settings as they were */
+        if (modified & 1) {
+            ok = ok && ctrlPhonPutCmd(ctrl, PICODATA_ITEMINFO1_CMD_PITCH,
+                    PICODATA_ITEMINFO2_CMD_ABSOLUTE, 100);
+        }
+        if (modified & 2) {
+            ok = ok && ctrlPhonPutCmd(ctrl, PICODATA_ITEMINFO1_CMD_SPEED,
+                    PICODATA_ITEMINFO2_CMD_ABSOLUTE, 100);
+        }
+        if (modified & 4) {
+            ok = ok && ctrlPhonPutCmd(ctrl, PICODATA_ITEMINFO1_CMD_VOLUME,
+                    PICODATA_ITEMINFO2_CMD_ABSOLUTE, 100);
+        }
+        /* flush, like a '\0' in the text */
+        ok = ok && ctrlPhonPutItem(ctrl, PICODATA_ITEM_BOUND,
+                PICODATA_ITEMINFO1_BOUND_TERM, PICODATA_ITEMINFO2_NA, NULL, 0);
+        if (!ok) {
+            status = PICO_EXC_MAX_NUM_EXCEED;
+        }
+    }
+    if (PICO_OK != status) {
+        ctrl->phonLen = 0;
+    }
+    return status;
+}
+
+/* items may be put to the input of 'pu': the PUs before it are done and no
+ * other items are being put there */
+static picoos_bool ctrlInjectReady(ctrl_subobj_t * ctrl, picoos_uint8 pu)
+{
+    picoos_uint8 i;
+
+    if (ctrl->curPU > pu) {
+        return FALSE;
+    }
+    for (i = 0; i < pu; i++) {
+        if (PICODATA_PU_IDLE != ctrl->procStatus[i]) {
+            return FALSE;
+        }
+    }
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+    if ((NULL != ctrl->fc) && (ctrl->fc->capturing || (NULL != ctrl->fc->replay))) {
+        return FALSE;
+    }
+#endif
+    return TRUE;
+}
+
+/* passes the pending phoneme items to the spho PU as far as they fit, once
+ * all PUs before it are done */
+static void ctrlPhonInject(ctrl_subobj_t * ctrl)
+{
+    picoos_uint16 blen;
+    picoos_bool put = FALSE;
+
+    if (!ctrlInjectReady(ctrl, ctrl->sphoPU)) {
+        return;
+    }
+    while ((ctrl->phonPos < ctrl->phonLen) && (PICO_OK == picodata_cbPutItem(
+            ctrl->procCbOut[ctrl->sphoPU - 1], ctrl->phonItems + ctrl->phonPos,
+            ctrl->phonLen - ctrl->phonPos, &blen))) {
+        ctrl->phonPos += blen;
+        put = TRUE;
+    }
+    if (put) {
+        ctrl->procStatus[ctrl->sphoPU] = PICODATA_PU_BUSY;
+        ctrl->curPU = ctrl->sphoPU;
+    }
+    if (ctrl->phonPos >= ctrl->phonLen) {
+        ctrl->phonLen = 0;
+        ctrl->phonPos = 0;
+    }
+}
+
+#if defined(PICOCTRL_ITEM_CAPTURE)
+/*----------------------------------------------------------
+ *  item capture and replay
+ *  the items put to the input of a PU are written to a file,
+ *  each preceded by the time since the capture started. A
+ *  file thus written is put to the input of the same type of
+ *  PU again once the PUs before it are idle; these do no work
+ *  while the file is replayed.
+ * ---------------------------------------------------------*/
+/* index of the PU of type 'puType', ctrl->numProcUnits if there is none */
+static picoos_uint8 ctrlFindPU(ctrl_subobj_t * ctrl, picoos_uint8 puType)
+{
+    picoos_uint8 i;
+
+    for (i = 0; (i < ctrl->numProcUnits) && (ctrl->procType[i] != puType); i++) {
+        /* continue */
+    }
+    return i;
+}
+
+/* stops the capture and closes its file */
+static void ctrlCapStop(register picodata_ProcessingUnit this)
+{
+    ctrl_subobj_t * ctrl = (ctrl_subobj_t *) this->subObj;
+
+    picodata_cbSetTap(ctrl->procCbOut[ctrl->capPU - 1], NULL, NULL);
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+    if ((NULL != ctrl->fc) && (ctrl->capPU == ctrl->numProcUnits - 1)) {
+        /* hand the input of the last PU back to the frame cache */
+        picodata_cbSetTap(ctrl->procCbOut[ctrl->capPU - 1], ctrlFcTap, ctrl->fc);
+    }
+#endif
+    picoos_CloseBinary(this->common, &ctrl->capFile);
+    ctrl->capFile = NULL;
+}
+
+/* writes an item put to the input of the captured PU */
+static void ctrlCapTap(void * tapObj, const picoos_uint8 * item,
+        picoos_uint16 len)
+{
+    picodata_ProcessingUnit this = (picodata_ProcessingUnit) tapObj;
+    ctrl_subobj_t * ctrl = (ctrl_subobj_t *) this->subObj;
+    picoos_uint8 stamp[CTRL_CAP_STAMPSIZE];
+    picopal_uint32 sec, usec;
+    picoos_uint32 time, pos = 0;
+    picoos_int32 n1 = CTRL_CAP_STAMPSIZE, n2 = len;
+
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+    if ((NULL != ctrl->fc) && (ctrl->capPU == ctrl->numProcUnits - 1)) {
+        ctrlFcTap(ctrl->fc, item, len);
+    }
+#endif
+    picoos_get_timer(&sec, &usec);
+    time = (sec - ctrl->capSec) * 1000000 + usec - ctrl->capUsec;
+    picoos_write_mem_pi_uint16(stamp, &pos, (picoos_uint16) (time & 0xffff));
+    picoos_write_mem_pi_uint16(stamp, &pos, (picoos_uint16) (time >> 16));
+    if (!picoos_WriteBytes(ctrl->capFile, (picoos_char *) stamp, &n1)
+            || !picoos_WriteBytes(ctrl->capFile, (const picoos_char *) item, &n2)
+            || (CTRL_CAP_STAMPSIZE != n1) || (len != n2)) {
+        picoos_emRaiseWarning(this->common->em, PICO_EXC_CANT_OPEN_FILE, NULL,
+                (picoos_char *) "item capture stopped, cannot write");
+        ctrlCapStop(this);
+    }
+}
+
+/* closes the replayed file */
+static void ctrlRepStop(register picodata_ProcessingUnit this)
+{
+    ctrl_subobj_t * ctrl = (ctrl_subobj_t *) this->subObj;
+
+    picoos_CloseBinary(this->common, &ctrl->repFile);
+    ctrl->repFile = NULL;
+    ctrl->repLen = 0;
+}
+
+/* reads the next item of the replayed file into ctrl->repItem; FALSE at the
+ * end of the file */
+static picoos_bool ctrlRepRead(register picodata_ProcessingUnit this)
+{
+    ctrl_subobj_t * ctrl = (ctrl_subobj_t *) this->subObj;
+    picoos_uint32 n, len = 0;
+    picoos_bool ok;
+
+    n = CTRL_CAP_STAMPSIZE + PICODATA_ITEM_HEADSIZE;
+    picoos_ReadBytes(ctrl->repFile, ctrl->repItem, &n);
+    if (0 == n) {
+        return FALSE;
+    }
+    ok = (CTRL_CAP_STAMPSIZE + PICODATA_ITEM_HEADSIZE == n);
+    if (ok) {
+        /* the time stamp is only of interest for analysis */
+        picoos_mem_copy(ctrl->repItem + CTRL_CAP_STAMPSIZE, ctrl->repItem,
+                PICODATA_ITEM_HEADSIZE);
+        len = ctrl->repItem[PICODATA_ITEMIND_LEN];
+        if (len > 0) {
+            n = len;
+            picoos_ReadBytes(ctrl->repFile,
+                    ctrl->repItem + PICODATA_ITEM_HEADSIZE, &n);
+            ok = (n == len);
+        }
+    }
+    if (!ok) {
+        picoos_emRaiseWarning(this->common->em, PICO_EXC_FILE_CORRUPT, NULL,
+                (picoos_char *) "replayed items truncated");
+        return FALSE;
+    }
+    ctrl->repLen = (picoos_uint16) (PICODATA_ITEM_HEADSIZE + len);
+    return TRUE;
+}
+
+/* passes the replayed items to their PU as far as they fit, once all PUs
+ * before it are done */
+static void ctrlRepInject(register picodata_ProcessingUnit this)
+{
+    ctrl_subobj_t * ctrl = (ctrl_subobj_t *) this->subObj;
+    picoos_uint16 blen;
+    picoos_bool put = FALSE;
+
+    if (!ctrlInjectReady(ctrl, ctrl->repPU)) {
+        return;
+    }
+    while (TRUE) {
+        if ((0 == ctrl->repLen) && !ctrlRepRead(this)) {
+            ctrlRepStop(this);
+            break;
+        }
+        if (PICO_OK != picodata_cbPutItem(ctrl->procCbOut[ctrl->repPU - 1],
+                ctrl->repItem, ctrl->repLen, &blen)) {
+            break;
+        }
+        ctrl->repLen = 0;
+        put = TRUE;
+    }
+    if (put) {
+        ctrl->procStatus[ctrl->repPU] = PICODATA_PU_BUSY;
+        ctrl->curPU = ctrl->repPU;
+    }
+}
+#endif
+
+/* phonemes or replayed items are waiting to be put to their PU */
+static picoos_bool ctrlItemsPending(ctrl_subobj_t * ctrl)
+{
+#if defined(PICOCTRL_ITEM_CAPTURE)
+    if (NULL != ctrl->repFile) {
+        return TRUE;
+    }
+#endif
+    return (ctrl->phonLen > 0);
+}
+
+/* ends the text fed without a final '\0', before items are put to a later
+ * PU */
+static pico_status_t ctrlFinishText(ctrl_subobj_t * ctrl,
+        picodata_CharBuffer cbIn)
+{
+    if (ctrl->textOpen) {
+        if (PICO_OK != picodata_cbPutCh(cbIn, NULLC)) {
+            return PICO_EXC_BUF_OVERFLOW;
+        }
+        ctrl->procStatus[0] = PICODATA_PU_BUSY;
+        ctrl->textOpen = FALSE;
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+        if (NULL != ctrl->fc) {
+            /* the unit being captured is cut short */
+            ctrl->fc->capturing = FALSE;
+            ctrl->fc->unitStart = TRUE;
+        }
+#endif
+    }
+    return PICO_OK;
+}
+
 /**
  * performs Control PU initialization
  * @param    this : pointer to Control PU
@@ -101,6 +914,23 @@ static pico_status_t ctrlInitialize(register picodata_ProcessingUnit this, picoo
     ctrl = (ctrl_subobj_t *) this->subObj;
     ctrl->curPU = 0;
     ctrl->lastItemTypeProduced=0;    /*no item produced by default*/
+    ctrl->textOpen = FALSE;
+    ctrl->phonLen = 0;
+    ctrl->phonPos = 0;
+#if defined(PICOCTRL_ITEM_CAPTURE)
+    /* a capture goes on, a replay is dropped */
+    if (NULL != ctrl->repFile) {
+        ctrlRepStop(this);
+    }
+#endif
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+    if (NULL != ctrl->fc) {
+        /* the cached units are kept */
+        ctrl->fc->replay = NULL;
+        ctrl->fc->unitStart = TRUE;
+        ctrl->fc->capturing = FALSE;
+    }
+#endif
     status = PICO_OK;
     for (i = 0; i < ctrl->numProcUnits; i++) {
         if (PICO_OK == status) {
@@ -147,6 +977,20 @@ static picodata_step_result_t ctrlStep(register picodata_ProcessingUnit this,
     *bytesOutput = 0;
     ctrl->lastItemTypeProduced=0; /*no item produced by default*/
 
+    if (ctrl->phonLen > 0) {
+        ctrlPhonInject(ctrl);
+    }
+#if defined(PICOCTRL_ITEM_CAPTURE)
+    if (NULL != ctrl->repFile) {
+        ctrlRepInject(this);
+    }
+#endif
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+    if ((NULL != ctrl->fc) && (NULL != ctrl->fc->replay)) {
+        ctrlFcReplay(ctrl);
+    }
+#endif
+
     /* --------------------- */
     /* do step of current pu */
     /* --------------------- */
@@ -169,6 +1013,11 @@ static picodata_step_result_t ctrlStep(register picodata_ProcessingUnit this,
             *bytesOutput = puBytesOutput;
         }
     }
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+    if (NULL != ctrl->fc) {
+        ctrlFcCheckCapture(ctrl);
+    }
+#endif
     /* recalculate state depending on pu status returned from curPU */
     switch (status) {
         case PICODATA_PU_ATOMIC:
@@ -192,7 +1041,10 @@ static picodata_step_result_t ctrlStep(register picodata_ProcessingUnit this,
                 /* still data to process below */
                 ctrl->curPU++;
             } else if (0 == ctrl->curPU) { /* all pu's are idle */
-                /* nothing to do */
+                if (ctrlItemsPending(ctrl)) {
+                    /* phonemes or replayed items to be put in the next step */
+                    return PICODATA_PU_BUSY;
+                }
             } else { /* find non-idle pu above */
                 PICODBG_DEBUG((
                     "find non-idle pu above from pu %d with status %d",
@@ -269,6 +1121,20 @@ static pico_status_t ctrlSubObjDeallocate(register picodata_ProcessingUnit this,
     }
     ctrl = (ctrl_subobj_t *) this->subObj;
     mm = mm;        /* fix warning "var not used in this function"*/
+    if (NULL != ctrl->phonTransducer) {
+        picotrns_disposeSimpleTransducer(&ctrl->phonTransducer, this->common->mm);
+    }
+    if (NULL != ctrl->phonItems) {
+        picoos_deallocate(this->common->mm, (void *) &ctrl->phonItems);
+    }
+#if defined(PICOCTRL_ITEM_CAPTURE)
+    if (NULL != ctrl->capFile) {
+        ctrlCapStop(this);
+    }
+    if (NULL != ctrl->repFile) {
+        ctrlRepStop(this);
+    }
+#endif
     /* deallocate members (procCbOut and procUnit) */
     for (i = ctrl->numProcUnits-1; i >= 0; i--) {
         picodata_disposeProcessingUnit(this->common->mm,&ctrl->procUnit[i]);
@@ -332,6 +1198,9 @@ static pico_status_t ctrlAddPU(register picodata_ProcessingUnit this,
         }
     }
     ctrl->procStatus[newPU] = PICODATA_PU_IDLE;
+#if defined(PICOCTRL_ITEM_CAPTURE)
+    ctrl->procType[newPU] = (picoos_uint8) puType;
+#endif
     /*...............*/
     switch (puType) {
     case PICODATA_PUTYPE_TOK:
@@ -361,6 +1230,7 @@ static pico_status_t ctrlAddPU(register picodata_ProcessingUnit this,
         break;
     case PICODATA_PUTYPE_SPHO:
             PICODBG_DEBUG(("creating SentPhoUnit for pu %i", newPU));
+            ctrl->sphoPU = newPU;
             ctrl->procUnit[newPU] = picospho_newSentPhoUnit(this->common->mm,
                     this->common, cbIn, ctrl->procCbOut[newPU], this->voice);
             break;
@@ -447,6 +1317,22 @@ picodata_ProcessingUnit picoctrl_newControl(picoos_MemoryManager mm,
         ctrl->procCbOut[i] = NULL;
     }
     ctrl->numProcUnits = 0;
+    ctrl->textOpen = FALSE;
+    ctrl->sphoPU = 0;
+    ctrl->phonTransducer = NULL;
+    ctrl->phonItems = NULL;
+    ctrl->phonLen = 0;
+    ctrl->phonPos = 0;
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+    ctrl->fc = NULL;
+#endif
+#if defined(PICOCTRL_ITEM_CAPTURE)
+    ctrl->capFile = NULL;
+    ctrl->capPU = 0;
+    ctrl->repFile = NULL;
+    ctrl->repPU = 0;
+    ctrl->repLen = 0;
+#endif
 
     if (
             (PICO_OK == ctrlAddPU(this,PICODATA_PUTYPE_TOK, FALSE, /*last*/FALSE)) &&
@@ -502,6 +1388,9 @@ typedef struct picoctrl_engine {
     picorsrc_Voice voice;
     picodata_ProcessingUnit control;
     picodata_CharBuffer cbIn, cbOut;
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+    void *fc_mem;
+#endif
 } picoctrl_engine_t;
 
 #ifndef MAGIC_MASK
@@ -594,6 +1483,9 @@ picoctrl_Engine picoctrl_newEngine(picoos_MemoryManager mm,
         this->control = NULL;
         this->cbIn = NULL;
         this->cbOut = NULL;
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+        this->fc_mem = NULL;
+#endif
 
         this->raw_mem = picoos_allocate(mm, PICOCTRL_DEFAULT_ENGINE_SIZE);
         if (NULL == this->raw_mem) {
@@ -635,6 +1527,17 @@ picoctrl_Engine picoctrl_newEngine(picoos_MemoryManager mm,
         done = (NULL != this->cbIn) && (NULL != this->cbOut)
                 && (NULL != this->control);
     }
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+    if (done) {
+        this->fc_mem = picoos_allocate(mm, PICOCTRL_FRAME_CACHE_SIZE);
+        if (NULL == this->fc_mem) {
+            PICODBG_WARN(("no memory for frame cache, running without"));
+        } else {
+            ctrlFcAttach((ctrl_subobj_t *) this->control->subObj,
+                    this->fc_mem, PICOCTRL_FRAME_CACHE_SIZE);
+        }
+    }
+#endif
     if (done) {
         SET_MAGIC_NUMBER(this);
     } else {
@@ -674,6 +1577,11 @@ void picoctrl_disposeEngine(picoos_MemoryManager mm, picorsrc_ResourceManager rm
         if(NULL != (*this)->raw_mem) {
             picoos_deallocate(mm,&((*this)->raw_mem));
         }
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+        if(NULL != (*this)->fc_mem) {
+            picoos_deallocate(mm,&((*this)->fc_mem));
+        }
+#endif
         (*this)->magic ^= 0xFFFEFDFC;
         picoos_deallocate(mm,(void **)this);
     }
@@ -724,18 +1632,210 @@ picoos_Common picoctrl_engGetCommon(picoctrl_Engine this) {
 pico_status_t picoctrl_engFeedText(picoctrl_Engine this,
         picoos_char * text,
         picoos_int16 textSize, picoos_int16 * bytesPut) {
+    ctrl_subobj_t * ctrl;
+    pico_status_t status = PICO_OK;
+
     if (NULL == this) {
         return PICO_ERR_OTHER;
     }
+    ctrl = (ctrl_subobj_t *) this->control->subObj;
     PICODBG_DEBUG(("get \"%.100s\"", text));
     *bytesPut = 0;
-    while ((*bytesPut < textSize) && (PICO_OK == picodata_cbPutCh(this->cbIn, text[*bytesPut]))) {
-        (*bytesPut)++;
+    if (ctrlItemsPending(ctrl)) {
+        /* phonemes or items put before are spoken first */
+        return PICO_OK;
+    }
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+    if (NULL != ctrl->fc) {
+        status = ctrlFcFeedText(ctrl, this->cbIn, text, textSize, bytesPut);
+    } else
+#endif
+    {
+        while ((*bytesPut < textSize) && (PICO_OK == picodata_cbPutCh(this->cbIn, text[*bytesPut]))) {
+            (*bytesPut)++;
+        }
+    }
+    if (*bytesPut > 0) {
+        /* the first PU has input to process */
+        ctrl->procStatus[0] = PICODATA_PU_BUSY;
+        ctrl->textOpen = (NULLC != text[*bytesPut - 1]);
     }
 
-    return PICO_OK;
+    return status;
 }/*picoctrl_engFeedText*/
 
+/**
+ * feeds a phonetic transcription into 'engine', bypassing text analysis
+ * @param    this : handle of the engine
+ * @param    phonemes : the transcription (see pico_putPhonemes)
+ * @param    size : size of 'phonemes'
+ * @return    PICO_OK : the transcription was accepted
+ * @return    PICO_EXC_BUF_OVERFLOW : phonemes put before are still pending
+ * @return    PICO_EXC_MAX_NUM_EXCEED : transcription too long
+ * @return    PICO_ERR_INVALID_ARGUMENT : illegal transcription
+ * @return    PICO_EXC_OUT_OF_MEM : no memory for phoneme input
+ * @callgraph
+ * @callergraph
+ */
+pico_status_t picoctrl_engFeedPhonemes(picoctrl_Engine this,
+        const picoos_char * phonemes, picoos_int16 size)
+{
+    ctrl_subobj_t * ctrl;
+    pico_status_t status;
+
+    if (NULL == this) {
+        return PICO_ERR_OTHER;
+    }
+    ctrl = (ctrl_subobj_t *) this->control->subObj;
+    if (ctrlItemsPending(ctrl)) {
+        return PICO_EXC_BUF_OVERFLOW;
+    }
+    if (NULL == ctrl->phonItems) {
+        /* allocated on first use only */
+        ctrl->phonTransducer = picotrns_newSimpleTransducer(this->common->mm,
+                this->common, 10*(PICOTRNS_MAX_NUM_POSSYM+2));
+        if (NULL != ctrl->phonTransducer) {
+            ctrl->phonItems = picoos_allocate(this->common->mm,
+                    PICOCTRL_PHONEME_BUFSIZE);
+        }
+        if (NULL == ctrl->phonItems) {
+            if (NULL != ctrl->phonTransducer) {
+                picotrns_disposeSimpleTransducer(&ctrl->phonTransducer,
+                        this->common->mm);
+            }
+            return PICO_EXC_OUT_OF_MEM;
+        }
+    }
+    status = ctrlPhonParse(this->control, phonemes, size);
+    if (PICO_OK == status) {
+        status = ctrlFinishText(ctrl, this->cbIn);
+        if (PICO_OK != status) {
+            ctrl->phonLen = 0;
+        }
+    }
+    return status;
+}/*picoctrl_engFeedPhonemes*/
+
+#if defined(PICOCTRL_ITEM_CAPTURE)
+/**
+ * starts writing the items put to the input of the PU of type 'puType' to
+ * the file 'fileName' (see PICOCTRL_ITEM_CAPTURE); a capture running before
+ * is stopped
+ * @param    this : handle of the engine
+ * @param    puType : type of the PU (picodata_putype_t), not the tokenizer
+ * @param    fileName : name of the file to be created
+ * @return    PICO_OK : capture started
+ * @return    PICO_ERR_INVALID_ARGUMENT : no PU of that type, or the tokenizer
+ * @return    PICO_EXC_CANT_OPEN_FILE : file could not be written
+ * @callgraph
+ * @callergraph
+ */
+pico_status_t picoctrl_engStartCapture(picoctrl_Engine this,
+        picoos_uint8 puType, picoos_char * fileName)
+{
+    ctrl_subobj_t * ctrl;
+    picoos_uint8 head[CTRL_CAP_HEADSIZE] = {'P', 'I', 'C', 'I', 1, 0, 0, 0};
+    picoos_int32 n = CTRL_CAP_HEADSIZE;
+    picoos_uint8 pu;
+
+    if (NULL == this) {
+        return PICO_ERR_OTHER;
+    }
+    ctrl = (ctrl_subobj_t *) this->control->subObj;
+    if (NULL != ctrl->capFile) {
+        ctrlCapStop(this->control);
+    }
+    pu = ctrlFindPU(ctrl, puType);
+    if ((0 == pu) || (pu >= ctrl->numProcUnits)) {
+        return PICO_ERR_INVALID_ARGUMENT;
+    }
+    if (!picoos_CreateBinary(this->common, &ctrl->capFile, fileName)) {
+        ctrl->capFile = NULL;
+        return PICO_EXC_CANT_OPEN_FILE;
+    }
+    head[5] = puType;
+    if (!picoos_WriteBytes(ctrl->capFile, (picoos_char *) head, &n)
+            || (CTRL_CAP_HEADSIZE != n)) {
+        picoos_CloseBinary(this->common, &ctrl->capFile);
+        ctrl->capFile = NULL;
+        return PICO_EXC_CANT_OPEN_FILE;
+    }
+    ctrl->capPU = pu;
+    picoos_get_timer(&ctrl->capSec, &ctrl->capUsec);
+    picodata_cbSetTap(ctrl->procCbOut[pu - 1], ctrlCapTap, this->control);
+    return PICO_OK;
+}/*picoctrl_engStartCapture*/
+
+/**
+ * stops the capture started by picoctrl_engStartCapture, if any
+ * @param    this : handle of the engine
+ * @return    PICO_OK : capture stopped
+ * @callgraph
+ * @callergraph
+ */
+pico_status_t picoctrl_engStopCapture(picoctrl_Engine this)
+{
+    if (NULL == this) {
+        return PICO_ERR_OTHER;
+    }
+    if (NULL != ((ctrl_subobj_t *) this->control->subObj)->capFile) {
+        ctrlCapStop(this->control);
+    }
+    return PICO_OK;
+}/*picoctrl_engStopCapture*/
+
+/**
+ * puts the items of a file written by picoctrl_engStartCapture to the
+ * input of the PU they were captured at, once the PUs before it are done;
+ * text fed meanwhile is refused
+ * @param    this : handle of the engine
+ * @param    fileName : name of the capture file
+ * @return    PICO_OK : replay started
+ * @return    PICO_EXC_BUF_OVERFLOW : a replay or phonemes are still pending
+ * @return    PICO_EXC_CANT_OPEN_FILE : file could not be opened
+ * @return    PICO_EXC_UNEXPECTED_FILE_TYPE : not a capture file of this engine
+ * @callgraph
+ * @callergraph
+ */
+pico_status_t picoctrl_engReplay(picoctrl_Engine this, picoos_char * fileName)
+{
+    ctrl_subobj_t * ctrl;
+    picoos_uint8 head[CTRL_CAP_HEADSIZE];
+    picoos_uint32 n = CTRL_CAP_HEADSIZE;
+    picoos_uint8 pu = 0;
+    pico_status_t status;
+
+    if (NULL == this) {
+        return PICO_ERR_OTHER;
+    }
+    ctrl = (ctrl_subobj_t *) this->control->subObj;
+    if ((NULL != ctrl->repFile) || (ctrl->phonLen > 0)) {
+        return PICO_EXC_BUF_OVERFLOW;
+    }
+    if (!picoos_OpenBinary(this->common, &ctrl->repFile, fileName)) {
+        ctrl->repFile = NULL;
+        return PICO_EXC_CANT_OPEN_FILE;
+    }
+    picoos_ReadBytes(ctrl->repFile, head, &n);
+    if ((CTRL_CAP_HEADSIZE == n) && ('P' == head[0]) && ('I' == head[1])
+            && ('C' == head[2]) && ('I' == head[3]) && (1 == head[4])) {
+        pu = ctrlFindPU(ctrl, head[5]);
+    }
+    if ((0 == pu) || (pu >= ctrl->numProcUnits)) {
+        ctrlRepStop(this->control);
+        return PICO_EXC_UNEXPECTED_FILE_TYPE;
+    }
+    status = ctrlFinishText(ctrl, this->cbIn);
+    if (PICO_OK != status) {
+        ctrlRepStop(this->control);
+        return status;
+    }
+    ctrl->repPU = pu;
+    ctrl->repLen = 0;
+    return PICO_OK;
+}/*picoctrl_engReplay*/
+#endif
+
 /**
  * gets engine output bytes
  * @param    this : handle of the engine
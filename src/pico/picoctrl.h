@@ -31,6 +31,9 @@
 #include "picoos.h"
 #include "picorsrc.h"
 #include "picodata.h"
+#include "picotrns.h"
+#include "picosa.h"
+#include "picopr.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -44,7 +47,49 @@ extern "C" {
 /* temporarily increased for preprocessing
 #define PICOCTRL_DEFAULT_ENGINE_SIZE 200000
 */
-#define PICOCTRL_DEFAULT_ENGINE_SIZE 1000000
+/* the engine memory includes the optional caches of the PUs, so that
+   enlarging them does not leave too little for the PUs themselves */
+#if !defined(PICOCTRL_DEFAULT_ENGINE_SIZE)
+#define PICOCTRL_DEFAULT_ENGINE_SIZE (997000 + PICOSA_G2P_CACHE_ENGINE_SIZE \
+        + PICOTRNS_CACHE_ENGINE_SIZE + PICOPR_COMPILE_ENGINE_SIZE)
+#endif
+
+/**
+ * Frame cache: bytes taken from the system memory for keeping the item
+ * stream which the cep PU hands to sig (FRAME_PAR items) for recently
+ * spoken text units; 0 disables the cache.
+ *
+ * A text unit is text terminated by '\\0', fed to picoctrl_engFeedText in
+ * one call while the engine is not processing earlier text. When the same
+ * unit is fed again, its stream is replayed to sig and all PUs before it are
+ * skipped, which roughly halves the time to speak it. Sig goes on applying
+ * the pitch and volume set by earlier commands. The stream takes about 16 KB
+ * per second of speech, half as much as the 16 bit samples at 16 kHz.
+ * If the memory is not available the engine works without the cache.
+ */
+#if !defined(PICOCTRL_FRAME_CACHE_SIZE)
+#define PICOCTRL_FRAME_CACHE_SIZE 0
+#endif
+
+#if (PICOCTRL_FRAME_CACHE_SIZE > 0)
+/* longest text unit (in bytes, without the '\\0') that is cached */
+#if !defined(PICOCTRL_FRAME_CACHE_MAX_TEXT)
+#define PICOCTRL_FRAME_CACHE_MAX_TEXT 128
+#endif
+/* longest item stream (in bytes) that is cached for a unit */
+#if !defined(PICOCTRL_FRAME_CACHE_MAX_STREAM)
+#define PICOCTRL_FRAME_CACHE_MAX_STREAM (PICOCTRL_FRAME_CACHE_SIZE / 2)
+#endif
+#endif
+
+/* bytes of items a call of picoctrl_engFeedPhonemes may produce */
+#if !defined(PICOCTRL_PHONEME_BUFSIZE)
+#define PICOCTRL_PHONEME_BUFSIZE 1024
+#endif
+/* longest word (in bytes of X-SAMPA) taken by picoctrl_engFeedPhonemes */
+#if !defined(PICOCTRL_PHONEME_MAX_WORD)
+#define PICOCTRL_PHONEME_MAX_WORD 64
+#endif
 
 typedef struct picoctrl_engine * picoctrl_Engine;
 
@@ -68,6 +113,38 @@ pico_status_t picoctrl_engFeedText(
         picoos_int16  textSize,
         picoos_int16 * bytesPut);
 
+pico_status_t picoctrl_engFeedPhonemes(
+        picoctrl_Engine engine,
+        const picoos_char * phonemes,
+        picoos_int16 size);
+
+/**
+ * Item capture and replay, compiled in if PICOCTRL_ITEM_CAPTURE is defined.
+ *
+ * picoctrl_engStartCapture writes the items put to the input of one PU to a
+ * file, e.g. to benchmark that PU and the ones after it on real input, or to
+ * keep the front end results for some text. picoctrl_engReplay puts them to
+ * the input of the same type of PU of an engine again; the PUs before it do
+ * no work for them. The file consists of an 8 byte header ("PICI", version
+ * 1, the picodata_putype_t of the PU, 2 bytes 0) followed by one record per
+ * item: the microseconds since the capture started (uint32, little endian)
+ * and the item (head and content). The time is not used by the replay; it
+ * is 0 unless picopal is built with IMPLEMENT_TIMER=1.
+ */
+#if defined(PICOCTRL_ITEM_CAPTURE)
+pico_status_t picoctrl_engStartCapture(
+        picoctrl_Engine engine,
+        picoos_uint8 puType,
+        picoos_char * fileName);
+
+pico_status_t picoctrl_engStopCapture(
+        picoctrl_Engine engine);
+
+pico_status_t picoctrl_engReplay(
+        picoctrl_Engine engine,
+        picoos_char * fileName);
+#endif
+
 pico_status_t picoctrl_engReset(
         picoctrl_Engine engine,
         picoos_int32 resetMode);
@@ -75,6 +75,9 @@ typedef struct picodata_char_buffer
     picodata_cbSubResetMethod subReset;
     picodata_cbSubDeallocateMethod subDeallocate;
     void * subObj;
+
+    picodata_cbTapMethod tap;
+    void * tapObj;
 } char_buffer_t;
 
 
@@ -125,6 +128,9 @@ picodata_CharBuffer picodata_newCharBuffer(picoos_MemoryManager mm,
     this->subDeallocate = NULL;
     this->subObj = NULL;
 
+    this->tap = NULL;
+    this->tapObj = NULL;
+
     picodata_cbReset(this);
     return this;
 }
@@ -338,8 +344,20 @@ pico_status_t picodata_cbPutItem(register picodata_CharBuffer this,
         const picoos_uint8 *buf, const picoos_uint16 blenmax,
         picoos_uint16 *blen)
 {
+    pico_status_t status;
 
-        return this->putItem(this,buf,blenmax,blen);
+    status = this->putItem(this,buf,blenmax,blen);
+    if ((PICO_OK == status) && (NULL != this->tap)) {
+        this->tap(this->tapObj, buf, *blen);
+    }
+    return status;
+}
+
+void picodata_cbSetTap(register picodata_CharBuffer this,
+        picodata_cbTapMethod tap, void * tapObj)
+{
+    this->tap = tap;
+    this->tapObj = tapObj;
 }
 
 /* unsafe, just for measuring purposes */
@@ -328,6 +328,15 @@ pico_status_t picodata_cbPutItem(register picodata_CharBuffer this,
 /* unsafe, just for measuring purposes */
 picoos_uint8 picodata_cbGetFrontItemType(register picodata_CharBuffer this);
 
+/* sets a tap which is called with each item successfully put to the
+   CharBuffer by picodata_cbPutItem (e.g. to record the item stream
+   between two PUs); a NULL 'tap' removes it */
+typedef void (* picodata_cbTapMethod) (void * tapObj,
+        const picoos_uint8 *item, picoos_uint16 len);
+
+void picodata_cbSetTap(register picodata_CharBuffer this,
+        picodata_cbTapMethod tap, void * tapObj);
+
 /* ***************************************************************
  *                   items: support function                     *
  *****************************************************************/
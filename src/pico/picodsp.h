@@ -43,7 +43,12 @@ extern "C" {
 #define PICODSP_ENVSPEC_K2            2
 #define PICODSP_GETEXC_K1             1024
 #define PICODSP_FIXRESP_NORM          4096.0f
+#if defined(PICODSP_NARROWBAND)
+/*compensates the lower energy of the half-size impulse responses*/
+#define PICODSP_END_FLOAT_NORM        1.3f*1.5f*16.0f
+#else
 #define PICODSP_END_FLOAT_NORM        1.5f*16.0f
+#endif
 #define PICODSP_FIX_SCALE1            0x4000000
 #define PICODSP_FIX_SCALE2            0x4000
 #define PICODSP_SHIFT_FACT1           10
@@ -64,9 +69,18 @@ extern "C" {
 #define PICODSP_COS_TABLE_LEN4 (2048)
 #define PICODSP_PI_SHIFT (4)            /* -log2(PICODSP_COS_TABLE_LEN2/0x4000) */
 
+/* Narrowband output: define PICODSP_NARROWBAND to synthesize directly at
+   8 kHz. The cepstra are still converted on the 16 kHz model grid, but only
+   the lower half of the linear spectrum is used and all synthesis FFTs,
+   windows and frame shifts are halved. */
 #define PICODSP_V_CUTOFF_FREQ  4500
 #define PICODSP_UV_CUTOFF_FREQ 300
-#define PICODSP_SAMP_FREQ      16000
+#define PICODSP_MODEL_SAMP_FREQ 16000
+#if defined(PICODSP_NARROWBAND)
+#define PICODSP_SAMP_FREQ      8000
+#else
+#define PICODSP_SAMP_FREQ      PICODSP_MODEL_SAMP_FREQ
+#endif
 #define PICODSP_FREQ_WARP_FACT 0.42f
 
 /*----------------------------CEP/PHASE CONSTANTS----------------------------*/
@@ -75,7 +89,16 @@ extern "C" {
 #define CEPST_BUFF_SIZE     3
 #define PHASE_BUFF_SIZE     5
 /*----------------------------FFT CONSTANTS----------------------------*/
-#define PICODSP_FFTSIZE     (256)
+/* FFT size of the model spectrum (mel to linear conversion, 16 kHz) */
+#define PICODSP_MODEL_FFTSIZE     (256)
+#define PICODSP_MODEL_HFFTSIZE_P1 (PICODSP_MODEL_FFTSIZE/2+1)
+
+/* FFT size of the synthesis (output sampling frequency) */
+#if defined(PICODSP_NARROWBAND)
+#define PICODSP_FFTSIZE     (PICODSP_MODEL_FFTSIZE/2)
+#else
+#define PICODSP_FFTSIZE     PICODSP_MODEL_FFTSIZE
+#endif
 
 #define PICODSP_H_FFTSIZE   (PICODSP_FFTSIZE/2)
 
@@ -84,6 +107,11 @@ extern "C" {
 #define PICODSP_H_FFTSIZE   (PICODSP_FFTSIZE/2)
 #define PICODSP_HFFTSIZE_P1 (PICODSP_H_FFTSIZE+1)
 
+/* size of the phase vector: voiced phases may extend beyond the
+   narrowband Nyquist frequency */
+#define PICODSP_ANGSIZE     ((PICODSP_HFFTSIZE_P1 > PICODSP_PHASEORDER+1) ? \
+                             PICODSP_HFFTSIZE_P1 : PICODSP_PHASEORDER+1)
+
 #define FAST_DEVICE(aCount, aAction) \
 { \
     int count_ = (aCount); \
@@ -1735,12 +1735,21 @@ void cftb1st(picoos_int32 n, PICOFFTSG_FFTTYPE *a)
     wd3r = PICODSP_WGT_SHIFT;
     wd3i = 0;
 
-    wk1r  = (PICOFFTSG_FFTTYPE) (0.998795449734  *PICODSP_WGT_SHIFT);
-    wk1i  = (PICOFFTSG_FFTTYPE) (0.049067676067  *PICODSP_WGT_SHIFT);
-    ss1   = (PICOFFTSG_FFTTYPE) (0.098135352135  *PICODSP_WGT_SHIFT);
-    wk3i  = (PICOFFTSG_FFTTYPE) (-0.146730467677 *PICODSP_WGT_SHIFT);
-    wk3r  = (PICOFFTSG_FFTTYPE) (0.989176511765  *PICODSP_WGT_SHIFT);
-    ss3   = (PICOFFTSG_FFTTYPE) (-0.293460935354 *PICODSP_WGT_SHIFT);
+    if (n == 128) { /* narrowband synthesis */
+        wk1r  = (PICOFFTSG_FFTTYPE) (0.995184726672  *PICODSP_WGT_SHIFT);
+        wk1i  = (PICOFFTSG_FFTTYPE) (0.098017140330  *PICODSP_WGT_SHIFT);
+        ss1   = (PICOFFTSG_FFTTYPE) (0.196034280659  *PICODSP_WGT_SHIFT);
+        wk3i  = (PICOFFTSG_FFTTYPE) (-0.290284677254 *PICODSP_WGT_SHIFT);
+        wk3r  = (PICOFFTSG_FFTTYPE) (0.956940335732  *PICODSP_WGT_SHIFT);
+        ss3   = (PICOFFTSG_FFTTYPE) (-0.580569354509 *PICODSP_WGT_SHIFT);
+    } else {
+        wk1r  = (PICOFFTSG_FFTTYPE) (0.998795449734  *PICODSP_WGT_SHIFT);
+        wk1i  = (PICOFFTSG_FFTTYPE) (0.049067676067  *PICODSP_WGT_SHIFT);
+        ss1   = (PICOFFTSG_FFTTYPE) (0.098135352135  *PICODSP_WGT_SHIFT);
+        wk3i  = (PICOFFTSG_FFTTYPE) (-0.146730467677 *PICODSP_WGT_SHIFT);
+        wk3r  = (PICOFFTSG_FFTTYPE) (0.989176511765  *PICODSP_WGT_SHIFT);
+        ss3   = (PICOFFTSG_FFTTYPE) (-0.293460935354 *PICODSP_WGT_SHIFT);
+    }
 
     i = 0;
     for (;;) {
@@ -3145,11 +3154,19 @@ void rftbsub(picoos_int32 n, PICOFFTSG_FFTTYPE *a)
     PICOFFTSG_FFTTYPE w1r, w1i, wkr, wki, wdr, wdi, ss, xr, xi, yr, yi;
     wkr = 0;
     wki = 0;
-    wdi=(PICOFFTSG_FFTTYPE)(0.012270614505*PICODSP_WGT_SHIFT);
-    wdr=(PICOFFTSG_FFTTYPE)(0.000150590655*PICODSP_WGT_SHIFT);
-    w1r=(PICOFFTSG_FFTTYPE)(0.999698817730*PICODSP_WGT_SHIFT);
-    w1i=(PICOFFTSG_FFTTYPE)(0.024541229010*PICODSP_WGT_SHIFT);
-    ss=(PICOFFTSG_FFTTYPE)(0.049082458019*PICODSP_WGT_SHIFT);
+    if (n == 128) { /* narrowband synthesis */
+        wdi=(PICOFFTSG_FFTTYPE)(0.024533837164*PICODSP_WGT_SHIFT);
+        wdr=(PICOFFTSG_FFTTYPE)(0.000602271897*PICODSP_WGT_SHIFT);
+        w1r=(PICOFFTSG_FFTTYPE)(0.998795456205*PICODSP_WGT_SHIFT);
+        w1i=(PICOFFTSG_FFTTYPE)(0.049067674327*PICODSP_WGT_SHIFT);
+        ss=(PICOFFTSG_FFTTYPE)(0.098135348655*PICODSP_WGT_SHIFT);
+    } else {
+        wdi=(PICOFFTSG_FFTTYPE)(0.012270614505*PICODSP_WGT_SHIFT);
+        wdr=(PICOFFTSG_FFTTYPE)(0.000150590655*PICODSP_WGT_SHIFT);
+        w1r=(PICOFFTSG_FFTTYPE)(0.999698817730*PICODSP_WGT_SHIFT);
+        w1i=(PICOFFTSG_FFTTYPE)(0.024541229010*PICODSP_WGT_SHIFT);
+        ss=(PICOFFTSG_FFTTYPE)(0.049082458019*PICODSP_WGT_SHIFT);
+    }
 
     i = n >> 1;
     for (;;) {
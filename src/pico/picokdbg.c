@@ -115,7 +115,7 @@ picokdbg_Dbg picokdbg_getDbg(picoknow_KnowledgeBase this) {
     if (NULL == this) {
         return NULL;
     } else {
-        return (picokdbg_Dbg)this->subObj;
+        return (picokdbg_Dbg) picoknow_getSubObj(this);
     }
 }
 
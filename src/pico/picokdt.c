@@ -208,6 +208,10 @@ typedef enum {
     PICOKDT_NRINPMT_PAM  = 60
 } kdt_nrinpmaptables_t;
 
+/* number of graph attributes (left/right context and current graph) at
+   the start of the G2P input vector */
+#define PICOKDT_NRGRAPHATT_G2P 9
+
 /* number of outmaptables for each tree, at least one, possibly empty,
    output map table for each tree */
 typedef enum {
@@ -256,8 +260,29 @@ typedef struct {
     /* direct output vector (no output mapping) */
     picoos_uint8 dset;    /* TRUE if class set, FALSE otherwise */
     picoos_uint16 dclass;
+
+#if defined(PICOKDT_COMPILED)
+    /* generated classifier for this kb, NULL if none matches */
+    picokdt_compiledClassify_t compiled;
+#endif
+#if defined(PICOKDT_DECODE)
+    /* expanded tree (cf. kdtDtDecode), NULL if not expanded */
+    struct kdt_dnode *dnodes;
+    struct kdt_dsubset *dsubsets;
+    picoos_uint32 *dforks;
+    picoos_uint8 *dmask;
+    picoos_uint32 dsize;    /* bytes allocated for the d* arrays */
+#endif
 } kdt_subobj_t;
 
+#if defined(PICOKDT_DECODE)
+static void kdtDtDecode(picoos_Common common, kdt_subobj_t *dtp);
+#endif
+#if defined(PICOKDT_COMPILED)
+static void kdtDtFindCompiled(register picoknow_KnowledgeBase this,
+                              kdt_subobj_t *dtp);
+#endif
+
 /* subobj specific for each decision tree type */
 typedef struct {
     kdt_subobj_t dt;
@@ -275,6 +300,19 @@ typedef struct {
     kdt_subobj_t dt;
     picoos_uint16 invec[PICOKDT_NRATT_G2P];    /* input vector */
     picoos_uint8 inveclen;  /* nr of ele set in invec; must be =nrattributes */
+#if (PICOKDT_G2P_MAXWORDLEN > 0)
+    /* word context, cf. picokdt_dtG2PsetWord */
+    picoos_uint8 wordok;    /* FALSE if the outside values cannot be mapped */
+    picoos_uint16 outsideval[PICOKDT_NRGRAPHATT_G2P]; /* mapped DEFCH */
+    picoos_uint16 eowval[PICOKDT_NRGRAPHATT_G2P];     /* mapped EOW_DEFCH */
+    const picoos_uint8 *wgraph;     /* word set, NULL if none */
+    picoos_uint16 wgraphlen;
+    picoos_uint8 wnrchars;          /* nr of utf8 chars in word */
+    picoos_uint8 wcharnr[PICOKDT_G2P_MAXWORDLEN]; /* utf8 char count (from 1)
+                                                     at each byte position */
+    picoos_uint16 wval[PICOKDT_NRGRAPHATT_G2P][PICOKDT_G2P_MAXWORDLEN];
+                                    /* mapped attribute value of each char */
+#endif
 } kdtg2p_subobj_t;
 
 typedef struct {
@@ -295,6 +333,13 @@ typedef struct {
     picoos_uint8 inveclen;  /* nr of ele set in invec; must be =nrattributes */
 } kdtpam_subobj_t;
 
+#if (PICOKDT_G2P_MAXWORDLEN > 0)
+static picoos_uint8 kdtG2PMapGraphAttr(kdtg2p_subobj_t *dtg2p,
+                                       const picoos_uint8 iAttr,
+                                       const picoos_uint8 *utf8char,
+                                       picoos_uint16 *val);
+#endif
+
 
 static pico_status_t kdtDtInitialize(register picoknow_KnowledgeBase this,
                                      picoos_Common common,
@@ -383,6 +428,16 @@ static pico_status_t kdtDtInitialize(register picoknow_KnowledgeBase this,
         }
         dtp->dset = 0;
         dtp->dclass = 0;
+#if defined(PICOKDT_COMPILED)
+        dtp->compiled = NULL;
+#endif
+#if defined(PICOKDT_DECODE)
+        dtp->dnodes = NULL;
+        dtp->dsubsets = NULL;
+        dtp->dforks = NULL;
+        dtp->dmask = NULL;
+        dtp->dsize = 0;
+#endif
         PICODBG_DEBUG(("tree init: nratt: %d, posomt: %d, postree: %d",
                        dtp->nrattributes, (dtp->outmaptable - dtp->inpmaptable),
                        (dtp->tree - dtp->inpmaptable)));
@@ -522,6 +577,20 @@ static pico_status_t kdtG2PInitialize(register picoknow_KnowledgeBase this,
         dtg2p->invec[i] = 0;
     }
     dtg2p->inveclen = 0;
+#if (PICOKDT_G2P_MAXWORDLEN > 0)
+    /* values of graph attributes outside the word are the same for all
+       words */
+    dtg2p->wgraph = NULL;
+    dtg2p->wordok = TRUE;
+    for (i = 0; i < PICOKDT_NRGRAPHATT_G2P; i++) {
+        if (!kdtG2PMapGraphAttr(dtg2p, i, PICOKDT_OUTSIDEGRAPH_DEFSTR,
+                                &(dtg2p->outsideval[i]))
+            || !kdtG2PMapGraphAttr(dtg2p, i, PICOKDT_OUTSIDEGRAPH_EOW_DEFSTR,
+                                   &(dtg2p->eowval[i]))) {
+            dtg2p->wordok = FALSE;
+        }
+    }
+#endif
     PICODBG_DEBUG(("g2p tree initialized"));
     return PICO_OK;
 }
@@ -632,6 +701,14 @@ static pico_status_t kdtPamInitialize(register picoknow_KnowledgeBase this,
 static pico_status_t kdtSubObjDeallocate(register picoknow_KnowledgeBase this,
                                          picoos_MemoryManager mm) {
     if (NULL != this) {
+#if defined(PICOKDT_DECODE)
+        /* all dt subobjs start with kdt_subobj_t */
+        if ((NULL != this->subObj)
+            && (NULL != ((kdt_subobj_t *)this->subObj)->dnodes)) {
+            picoos_deallocate(mm,
+                    (void *) &(((kdt_subobj_t *)this->subObj)->dnodes));
+        }
+#endif
         picoos_deallocate(mm, (void *) &this->subObj);
     }
     return PICO_OK;
@@ -710,6 +787,17 @@ pico_status_t picokdt_specializeDtKnowledgeBase(picoknow_KnowledgeBase this,
         picoos_deallocate(common->mm, (void *) &this->subObj);
         return picoos_emRaiseException(common->em, status, NULL, NULL);
     }
+#if defined(PICOKDT_COMPILED)
+    kdtDtFindCompiled(this, (kdt_subobj_t *)this->subObj);
+    if (NULL != ((kdt_subobj_t *)this->subObj)->compiled) {
+        return PICO_OK;    /* no need to expand */
+    }
+#endif
+#if defined(PICOKDT_DECODE)
+    if (PICOKDT_DECODE_TREES & (1 << kdttype)) {
+        kdtDtDecode(common, (kdt_subobj_t *)this->subObj);
+    }
+#endif
     return PICO_OK;
 }
 
@@ -719,27 +807,41 @@ pico_status_t picokdt_specializeDtKnowledgeBase(picoknow_KnowledgeBase this,
 /* ************************************************************/
 
 picokdt_DtPosP picokdt_getDtPosP(picoknow_KnowledgeBase this) {
-    return ((NULL == this) ? NULL : ((picokdt_DtPosP) this->subObj));
+    return ((NULL == this) ? NULL : ((picokdt_DtPosP) picoknow_getSubObj(this)));
 }
 
 picokdt_DtPosD picokdt_getDtPosD(picoknow_KnowledgeBase this) {
-    return ((NULL == this) ? NULL : ((picokdt_DtPosD) this->subObj));
+    return ((NULL == this) ? NULL : ((picokdt_DtPosD) picoknow_getSubObj(this)));
 }
 
 picokdt_DtG2P  picokdt_getDtG2P (picoknow_KnowledgeBase this) {
-    return ((NULL == this) ? NULL : ((picokdt_DtG2P) this->subObj));
+    return ((NULL == this) ? NULL : ((picokdt_DtG2P) picoknow_getSubObj(this)));
 }
 
 picokdt_DtPHR  picokdt_getDtPHR (picoknow_KnowledgeBase this) {
-    return ((NULL == this) ? NULL : ((picokdt_DtPHR) this->subObj));
+    return ((NULL == this) ? NULL : ((picokdt_DtPHR) picoknow_getSubObj(this)));
 }
 
 picokdt_DtACC  picokdt_getDtACC (picoknow_KnowledgeBase this) {
-    return ((NULL == this) ? NULL : ((picokdt_DtACC) this->subObj));
+    return ((NULL == this) ? NULL : ((picokdt_DtACC) picoknow_getSubObj(this)));
 }
 
 picokdt_DtPAM  picokdt_getDtPAM (picoknow_KnowledgeBase this) {
-    return ((NULL == this) ? NULL : ((picokdt_DtPAM) this->subObj));
+    return ((NULL == this) ? NULL : ((picokdt_DtPAM) picoknow_getSubObj(this)));
+}
+
+picoos_uint32 picokdt_getDecodedSize(picoknow_KnowledgeBase this) {
+#if defined(PICOKDT_DECODE)
+    kdt_subobj_t *dtp;
+
+    dtp = (NULL == this) ? NULL : (kdt_subobj_t *) picoknow_getSubObj(this);
+    if ((NULL != dtp) && (NULL != dtp->dnodes)) {
+        return dtp->dsize;
+    }
+#else
+    this = this;        /* avoid warning "var not used in this function"*/
+#endif
+    return 0;
 }
 
 
@@ -984,6 +1086,372 @@ static picoos_uint32 kdtGetShiftVal(register kdt_subobj_t *this,
 }
 
 
+#if defined(PICOKDT_COMPILED)
+
+/* ************************************************************/
+/* generated decision tree classifiers */
+/* ************************************************************/
+
+/* Name    :   kdtDtFindCompiled
+   Function:   sets dtp->compiled to the generated classifier of the kb,
+               if its kb id, size and checksum match
+*/
+static void kdtDtFindCompiled(register picoknow_KnowledgeBase this,
+                              kdt_subobj_t *dtp) {
+    picoos_uint32 i, checksum;
+    picoos_uint16 t;
+
+    dtp->compiled = NULL;
+    checksum = 0x811C9DC5;
+    for (i = 0; i < this->size; i++) {
+        checksum = (checksum ^ this->base[i]) * 0x01000193;
+    }
+    for (t = 0; t < picokdt_nrCompiledTrees; t++) {
+        if ((picokdt_compiledTrees[t].kbid == this->id)
+            && (picokdt_compiledTrees[t].size == this->size)
+            && (picokdt_compiledTrees[t].checksum == checksum)) {
+            dtp->compiled = picokdt_compiledTrees[t].classify;
+            PICODBG_INFO(("kb id %d: using compiled tree", this->id));
+            return;
+        }
+    }
+    PICODBG_INFO(("kb id %d: no matching compiled tree, interpreting",
+                  this->id));
+}
+
+#endif /* PICOKDT_COMPILED */
+
+#if defined(PICOKDT_DECODE)
+
+/* ************************************************************/
+/* decision tree expansion */
+/* ************************************************************/
+
+/* max number of pending subtrees while expanding a tree; a tree whose
+   expansion needs more is classified from the packed form */
+#if !defined(PICOKDT_DECODE_MAXSTACK)
+#define PICOKDT_DECODE_MAXSTACK 512
+#endif
+
+/* fork entries with this bit set contain a decision, else a node index */
+#define KDT_DFORK_DECISION 0x80000000
+
+/* expanded node; type eNTerminal is used for all nodes that do not
+   lead to a solution (terminal node or invalid question) */
+typedef struct kdt_dnode {
+    picoos_uint8 type;        /* kdt_nodetypes_t */
+    picoos_uint8 question;    /* attribute index */
+    picoos_uint16 nrforks;
+    picoos_int32 cut;         /* eNContinuous: threshold,
+                                 eNDiscrete: index of first subset */
+    picoos_uint32 forks;      /* index of first fork in dforks */
+} kdt_dnode_t;
+
+/* expanded subset of a discrete node, nrforks-1 per node */
+typedef struct kdt_dsubset {
+    picoos_uint8 type;        /* kdt_subsettypes_t */
+    picoos_int32 lo;          /* first value */
+    picoos_int32 hi;          /* eTwoValues: second value, else end of range */
+    picoos_uint32 maskpos;    /* eBitMask: bit index of value lo in dmask */
+} kdt_dsubset_t;
+
+typedef struct {
+    picoos_uint32 bitpos;     /* absolute bit position in treebody */
+    picoos_uint32 ind;        /* node index assigned to it */
+} kdt_dpending_t;
+
+typedef struct {
+    picoos_uint32 nrnodes;
+    picoos_uint32 nrforks;
+    picoos_uint32 nrsubsets;
+    picoos_uint32 nrmaskbits;
+} kdt_dcount_t;
+
+
+/* Name    :   kdtDecodeWalk
+   Function:   walks all nodes reachable from the root in the same order
+               kdtAskTree would read them; counts the elements, and if
+               fill is TRUE also stores them in the d* arrays
+   Returns :   TRUE if okay, FALSE if the tree cannot be expanded
+*/
+static picoos_uint8 kdtDecodeWalk(register kdt_subobj_t *this,
+                                  kdt_dpending_t *stack,
+                                  const picoos_uint32 bodybits,
+                                  const picoos_uint8 fill,
+                                  kdt_dcount_t *cnt) {
+    picoos_uint32 sp, maxnodes, iByteNo, bitpos, ind, val, fork;
+    picoos_int8 iBitNo;
+    picoos_int32 i, k, iForks;
+    picoos_uint8 iNodeType, iQuestion;
+    kdt_dnode_t node;
+    kdt_dsubset_t sub;
+
+    cnt->nrnodes = 1;
+    cnt->nrforks = 0;
+    cnt->nrsubsets = 0;
+    cnt->nrmaskbits = 0;
+    /* every node uses at least 2 type bits and 1 decide bit in its
+       parent; more nodes than that means shared subtrees or a loop */
+    maxnodes = (bodybits / 3) + 1;
+    stack[0].bitpos = 0;
+    stack[0].ind = 0;
+    sp = 1;
+
+    while (sp > 0) {
+        sp--;
+        bitpos = stack[sp].bitpos;
+        ind = stack[sp].ind;
+        if (bitpos >= bodybits) {
+            return FALSE;
+        }
+        iByteNo = bitpos / 8;
+        iBitNo = 7 - (bitpos % 8);
+
+        iNodeType = kdtGetShiftVal(this, PICOKDT_NODETYPE_NRBITS,
+                                   &iByteNo, &iBitNo);
+        iQuestion = kdtGetShiftVal(this, this->vfields[eQuestion],
+                                   &iByteNo, &iBitNo);
+        node.type = iNodeType;
+        node.question = iQuestion;
+        node.nrforks = 0;
+        node.cut = 0;
+        node.forks = cnt->nrforks;
+        iForks = 0;
+
+        if (iQuestion >= this->nrattributes) {
+            node.type = eNTerminal;
+        } else {
+            switch (iNodeType) {
+                case eNBinary:
+                    iForks = 2;
+                    break;
+                case eNContinuous:
+                    iForks = 2;
+                    node.cut =
+                        kdtGetShiftVal(this,
+                                       kdtGetQFieldsVal(this, iQuestion, eCut),
+                                       &iByteNo, &iBitNo);
+                    break;
+                case eNDiscrete:
+                    iForks =
+                        kdtGetShiftVal(this,
+                                       kdtGetQFieldsVal(this, iQuestion,
+                                                        eForkCount),
+                                       &iByteNo, &iBitNo);
+                    node.cut = cnt->nrsubsets;
+                    for (i = 0; i < iForks-1; i++) {
+                        sub.type = kdtGetShiftVal(this,
+                                                  PICOKDT_SUBSETTYPE_NRBITS,
+                                                  &iByteNo, &iBitNo);
+                        sub.lo = kdtGetShiftVal(this,
+                                        kdtGetQFieldsVal(this, iQuestion,
+                                                         eBitNo),
+                                        &iByteNo, &iBitNo);
+                        sub.hi = sub.lo;
+                        sub.maskpos = 0;
+                        if (sub.type != eOneValue) {
+                            val = kdtGetShiftVal(this,
+                                          kdtGetQFieldsVal(this, iQuestion,
+                                                           eBitCount),
+                                          &iByteNo, &iBitNo);
+                            if (sub.type == eTwoValues) {
+                                sub.hi = val;
+                            } else {
+                                sub.hi = sub.lo + val;
+                            }
+                            if (sub.type == eBitMask) {
+                                sub.maskpos = cnt->nrmaskbits;
+                                for (k = 0; k < (picoos_int32)val; k++) {
+                                    if (kdtGetShiftVal(this, 1, &iByteNo,
+                                                       &iBitNo) && fill) {
+                                        this->dmask[(sub.maskpos + k) / 8] |=
+                                            (1 << ((sub.maskpos + k) % 8));
+                                    }
+                                }
+                                cnt->nrmaskbits += val;
+                            }
+                        }
+                        if (fill) {
+                            this->dsubsets[cnt->nrsubsets] = sub;
+                        }
+                        cnt->nrsubsets++;
+                    }
+                    break;
+                default:
+                    node.type = eNTerminal;
+                    break;
+            }
+        }
+        if (iForks > 0) {
+            node.nrforks = iForks;
+        }
+
+        for (i = 0; i < iForks; i++) {
+            if (kdtGetShiftVal(this, PICOKDT_ISDECIDE_NRBITS,
+                               &iByteNo, &iBitNo)) {
+                fork = KDT_DFORK_DECISION |
+                    kdtGetShiftVal(this, this->vfields[eDecide],
+                                   &iByteNo, &iBitNo);
+            } else {
+                val = kdtGetShiftVal(this,
+                                     kdtGetQFieldsVal(this, iQuestion, eJump),
+                                     &iByteNo, &iBitNo);
+                if ((sp >= PICOKDT_DECODE_MAXSTACK)
+                    || (cnt->nrnodes >= maxnodes)) {
+                    return FALSE;
+                }
+                /* jumps are relative to the end of the jump field */
+                stack[sp].bitpos = (iByteNo * 8) + (7 - iBitNo) + val;
+                stack[sp].ind = cnt->nrnodes;
+                sp++;
+                fork = cnt->nrnodes++;
+            }
+            if (fill) {
+                this->dforks[cnt->nrforks] = fork;
+            }
+            cnt->nrforks++;
+        }
+
+        if (fill) {
+            this->dnodes[ind] = node;
+        }
+    }
+    return TRUE;
+}
+
+
+/* Name    :   kdtDtDecode
+   Function:   expands the tree of dtp into the d* arrays (one allocation,
+               nodes first); on failure the tree stays unexpanded
+*/
+static void kdtDtDecode(picoos_Common common, kdt_subobj_t *dtp) {
+    kdt_dpending_t *stack;
+    kdt_dcount_t cnt;
+    picoos_uint32 bodybits, nodesize, subsetsize, forksize, masksize, i;
+    picoos_uint8 *p, *b;
+    picoos_uint8 ok;
+
+    dtp->dnodes = NULL;
+    /* TREEBODYSIZE4 precedes the treebody */
+    b = dtp->treebody - 4;
+    bodybits = (((picoos_uint32)b[3] << 24) | ((picoos_uint32)b[2] << 16) |
+                ((picoos_uint32)b[1] << 8) | b[0]) * 8;
+
+    stack = picoos_allocate(common->mm,
+                            PICOKDT_DECODE_MAXSTACK * sizeof(kdt_dpending_t));
+    if (NULL == stack) {
+        PICODBG_WARN(("no memory to expand tree, using packed tree"));
+        return;
+    }
+    ok = kdtDecodeWalk(dtp, stack, bodybits, FALSE, &cnt);
+    if (ok) {
+        nodesize = cnt.nrnodes * sizeof(kdt_dnode_t);
+        subsetsize = cnt.nrsubsets * sizeof(kdt_dsubset_t);
+        forksize = cnt.nrforks * sizeof(picoos_uint32);
+        masksize = (cnt.nrmaskbits + 7) / 8;
+        p = picoos_allocate(common->mm,
+                            nodesize + subsetsize + forksize + masksize);
+        if (NULL == p) {
+            PICODBG_WARN(("no memory to expand tree, using packed tree"));
+            ok = FALSE;
+        } else {
+            dtp->dnodes = (kdt_dnode_t *)p;
+            dtp->dsubsets = (kdt_dsubset_t *)(p + nodesize);
+            dtp->dforks = (picoos_uint32 *)(p + nodesize + subsetsize);
+            dtp->dmask = p + nodesize + subsetsize + forksize;
+            for (i = 0; i < masksize; i++) {
+                dtp->dmask[i] = 0;
+            }
+            ok = kdtDecodeWalk(dtp, stack, bodybits, TRUE, &cnt);
+            if (ok) {
+                dtp->dsize = nodesize + subsetsize + forksize + masksize;
+                PICODBG_INFO(("tree type %d expanded: %d nodes, %d forks, "
+                              "%d subsets, %d bytes (packed %d bytes)",
+                              dtp->type, cnt.nrnodes, cnt.nrforks,
+                              cnt.nrsubsets, dtp->dsize, bodybits / 8));
+            } else {
+                picoos_deallocate(common->mm, (void *) &dtp->dnodes);
+            }
+        }
+    } else {
+        PICODBG_WARN(("tree type %d cannot be expanded, using packed tree",
+                      dtp->type));
+    }
+    picoos_deallocate(common->mm, (void *) &stack);
+}
+
+
+/* Name    :   kdtAskDecoded
+   Function:   Tree traversal on the expanded tree, equivalent to calling
+               kdtAskTree until it returns <= 0
+   Returns :   =0    solution found
+               <0    error, no solution found
+*/
+static picoos_int8 kdtAskDecoded(register kdt_subobj_t *this,
+                                 const picoos_uint16 *invec,
+                                 const kdt_nratt_t invecmax) {
+    const kdt_dnode_t *node;
+    const kdt_dsubset_t *sub;
+    picoos_int32 iVal, iID, i;
+    picoos_uint32 fork;
+
+    node = this->dnodes;
+    while (TRUE) {
+        if ((node->type == eNTerminal) || (node->question >= invecmax)) {
+            break;
+        }
+        iVal = invec[node->question];
+        switch (node->type) {
+            case eNBinary:
+                iID = iVal;
+                break;
+            case eNContinuous:
+                iID = (iVal <= node->cut) ? 0 : 1;
+                break;
+            default: /* eNDiscrete */
+                iID = node->nrforks - 1;
+                sub = this->dsubsets + node->cut;
+                for (i = 0; i < node->nrforks - 1; i++, sub++) {
+                    if (sub->type == eOneValue) {
+                        if (iVal == sub->lo) {
+                            iID = i;
+                            break;
+                        }
+                    } else if (sub->type == eTwoValues) {
+                        if ((iVal == sub->lo) || (iVal == sub->hi)) {
+                            iID = i;
+                            break;
+                        }
+                    } else if ((iVal >= sub->lo) && (iVal < sub->hi)) {
+                        if ((sub->type == eWithoutBitMask) ||
+                            (this->dmask[(sub->maskpos + (iVal - sub->lo)) / 8]
+                             & (1 << ((sub->maskpos + (iVal - sub->lo)) % 8)))) {
+                            iID = i;
+                            break;
+                        }
+                    }
+                }
+                break;
+        }
+        if ((iID < 0) || (iID >= node->nrforks)) {
+            break;
+        }
+        fork = this->dforks[node->forks + iID];
+        if (fork & KDT_DFORK_DECISION) {
+            this->dclass = (picoos_uint16)fork;
+            this->dset = TRUE;
+            return 0;    /* solution found */
+        }
+        node = this->dnodes + fork;
+    }
+    this->dset = FALSE;
+    PICODBG_TRACE(("problem determining class"));
+    return -1;
+}
+
+#endif /* PICOKDT_DECODE */
+
+
 /* Name    :   kdtAskTree
    Function:   Tree Traversal routine
    Input   :   iByteNo ofsset to the first byte containing the bits
@@ -1011,6 +1479,26 @@ static picoos_int8 kdtAskTree(register kdt_subobj_t *this,
 
     PICODBG_TRACE(("start"));
 
+#if defined(PICOKDT_COMPILED)
+    if (NULL != this->compiled) {
+        /* generated classifier: whole traversal in one call */
+        iDecision = this->compiled(invec);
+        if (iDecision < 0) {
+            this->dset = FALSE;
+            return -1;
+        }
+        this->dclass = iDecision;
+        this->dset = TRUE;
+        return 0;
+    }
+#endif
+#if defined(PICOKDT_DECODE)
+    if (NULL != this->dnodes) {
+        /* expanded tree: whole traversal in one call */
+        return kdtAskDecoded(this, invec, invecmax);
+    }
+#endif
+
     /* get node type, value should be in kdt_nodetype_t range */
     iNodeType = kdtGetShiftVal(this, PICOKDT_NODETYPE_NRBITS, iByteNo, iBitNo);
     PICODBG_TRACE(("iNodeType: %d", iNodeType));
@@ -2033,6 +2521,70 @@ static picoos_uint16 kdtGetUTF8Nr(const picoos_uint8 *utfgraph,
 }
 
 
+/* set the G2P attributes following the graph attributes (POS, vowel
+   info, stress flag and phone history), cf. picokdt_dtG2PconstructInVec */
+static picoos_uint8 kdtG2PSetFixedAttrs(kdtg2p_subobj_t *dtg2p,
+                                        const picoos_uint8 pos,
+                                        const picoos_uint8 nrvow,
+                                        const picoos_uint8 ordvow,
+                                        picoos_uint8 *primstressflag,
+                                        const picoos_uint16 phonech1,
+                                        const picoos_uint16 phonech2,
+                                        const picoos_uint16 phonech3) {
+    picoos_uint16 fallback = 0;
+    picoos_uint16 inval;
+    picoos_uint8 iAttr;
+    picoos_uint8 retval;
+
+    retval = TRUE;
+    inval = 0;
+    for (iAttr = 9; iAttr < PICOKDT_NRATT_G2P; iAttr++) {
+        switch (iAttr) {
+            case 9:     /* word POS, Fix1 */
+                inval = pos;
+                break;
+            case 10:    /* nr of vowel-like graphs in word, if vowel, Fix2  */
+                inval = nrvow;
+                break;
+            case 11:    /* order of current vowel-like graph in word, Fix2 */
+                inval = ordvow;
+                break;
+            case 12:    /* primary stress mark, Fix2 */
+                if (*primstressflag == 1) {
+                    /*already set previously*/
+                    inval = 1;
+                } else {
+                    inval = 0;
+                }
+                break;
+            case 13:    /* phone chunk right context +1, Hist */
+                inval = phonech1;
+                break;
+            case 14:    /* phone chunk right context +2, Hist */
+                inval = phonech2;
+                break;
+            case 15:    /* phone chunk right context +3, Hist */
+                inval = phonech3;
+                break;
+        }
+
+        PICODBG_TRACE(("invec %d %d", iAttr, inval));
+
+        if (!kdtMapInFixed(&(dtg2p->dt), iAttr, inval,
+                           &(dtg2p->invec[iAttr]), &fallback)) {
+            if (fallback) {
+                dtg2p->invec[iAttr] = fallback;
+            } else {
+                PICODBG_WARN(("setting attribute %d to zero", iAttr));
+                dtg2p->invec[iAttr] = 0;
+                retval = FALSE;
+            }
+        }
+    }
+    return retval;
+}
+
+
 picoos_uint8 picokdt_dtG2PconstructInVec(const picokdt_DtG2P this,
                                          const picoos_uint8 *graph,
                                          const picoos_uint16 graphlen,
@@ -2048,7 +2600,6 @@ picoos_uint8 picokdt_dtG2PconstructInVec(const picokdt_DtG2P this,
     picoos_uint16 fallback = 0;
     picoos_uint8 iAttr;
     picoos_uint8 utf8char[PICOBASE_UTF8_MAXLEN + 1];
-    picoos_uint16 inval;
     picoos_int16 cinv;
     picoos_uint8 retval;
     picoos_int32 utfgraphlen;
@@ -2056,7 +2607,6 @@ picoos_uint8 picokdt_dtG2PconstructInVec(const picokdt_DtG2P this,
 
     dtg2p = (kdtg2p_subobj_t *)this;
     retval = TRUE;
-    inval = 0;
 
     PICODBG_TRACE(("in:  [%d,%d,%d|%d,%d|%d|%d,%d,%d]", graphlen, count, pos,
                    nrvow, ordvow, *primstressflag, phonech1, phonech2,
@@ -2163,48 +2713,9 @@ picoos_uint8 picokdt_dtG2PconstructInVec(const picokdt_DtG2P this,
     }
 
     /* other attributes, MapInFixed */
-    for (iAttr = 9; iAttr < PICOKDT_NRATT_G2P; iAttr++) {
-        switch (iAttr) {
-            case 9:     /* word POS, Fix1 */
-                inval = pos;
-                break;
-            case 10:    /* nr of vowel-like graphs in word, if vowel, Fix2  */
-                inval = nrvow;
-                break;
-            case 11:    /* order of current vowel-like graph in word, Fix2 */
-                inval = ordvow;
-                break;
-            case 12:    /* primary stress mark, Fix2 */
-                if (*primstressflag == 1) {
-                    /*already set previously*/
-                    inval = 1;
-                } else {
-                    inval = 0;
-                }
-                break;
-            case 13:    /* phone chunk right context +1, Hist */
-                inval = phonech1;
-                break;
-            case 14:    /* phone chunk right context +2, Hist */
-                inval = phonech2;
-                break;
-            case 15:    /* phone chunk right context +3, Hist */
-                inval = phonech3;
-                break;
-        }
-
-        PICODBG_TRACE(("invec %d %d", iAttr, inval));
-
-        if (!kdtMapInFixed(&(dtg2p->dt), iAttr, inval,
-                           &(dtg2p->invec[iAttr]), &fallback)) {
-            if (fallback) {
-                dtg2p->invec[iAttr] = fallback;
-            } else {
-                PICODBG_WARN(("setting attribute %d to zero", iAttr));
-                dtg2p->invec[iAttr] = 0;
-                retval = FALSE;
-            }
-        }
+    if (!kdtG2PSetFixedAttrs(dtg2p, pos, nrvow, ordvow, primstressflag,
+                             phonech1, phonech2, phonech3)) {
+        retval = FALSE;
     }
 
     PICODBG_TRACE(("out: [%d,%d%,%d,%d|%d|%d,%d,%d,%d|%d,%d,%d,%d|"
@@ -2220,6 +2731,143 @@ picoos_uint8 picokdt_dtG2PconstructInVec(const picokdt_DtG2P this,
 }
 
 
+#if (PICOKDT_G2P_MAXWORDLEN > 0)
+
+/* map a graph attribute as picokdt_dtG2PconstructInVec does, using the
+   fallback value if the graph is not in the map table; returns FALSE
+   (and val 0) if there is no fallback value */
+static picoos_uint8 kdtG2PMapGraphAttr(kdtg2p_subobj_t *dtg2p,
+                                       const picoos_uint8 iAttr,
+                                       const picoos_uint8 *utf8char,
+                                       picoos_uint16 *val) {
+    picoos_uint16 fallback = 0;
+
+    if (!kdtMapInGraph(&(dtg2p->dt), iAttr, utf8char, PICOBASE_UTF8_MAXLEN,
+                       val, &fallback)) {
+        *val = fallback;
+        return (fallback != 0);
+    }
+    return TRUE;
+}
+
+
+picoos_uint8 picokdt_dtG2PsetWord(const picokdt_DtG2P this,
+                                  const picoos_uint8 *graph,
+                                  const picoos_uint16 graphlen) {
+    kdtg2p_subobj_t *dtg2p;
+    picoos_uint8 utf8char[PICOBASE_UTF8_MAXLEN + 1];
+    picoos_uint32 pos, start;
+    picoos_uint8 iAttr, n;
+
+    dtg2p = (kdtg2p_subobj_t *)this;
+    dtg2p->wgraph = NULL;
+    if (!dtg2p->wordok || (graphlen == 0)
+        || (graphlen > PICOKDT_G2P_MAXWORDLEN)) {
+        return FALSE;
+    }
+
+    /* decode the word once, mapping every char for every graph
+       attribute; anything unusual is left to the per-position path so
+       that it is handled (and reported) exactly as before */
+    pos = 0;
+    n = 0;
+    while (pos < graphlen) {
+        start = pos;
+        if (!picobase_get_next_utf8char(graph, graphlen, &pos, utf8char)) {
+            return FALSE;
+        }
+        while (start < pos) {
+            dtg2p->wcharnr[start++] = n + 1;
+        }
+        for (iAttr = 0; iAttr < PICOKDT_NRGRAPHATT_G2P; iAttr++) {
+            if (!kdtG2PMapGraphAttr(dtg2p, iAttr, utf8char,
+                                    &(dtg2p->wval[iAttr][n]))) {
+                return FALSE;
+            }
+        }
+        n++;
+    }
+    if ((pos != graphlen) || (picobase_utf8_length(graph, graphlen) != n)) {
+        return FALSE;
+    }
+    dtg2p->wgraph = graph;
+    dtg2p->wgraphlen = graphlen;
+    dtg2p->wnrchars = n;
+    return TRUE;
+}
+
+
+picoos_uint8 picokdt_dtG2PconstructWordInVec(const picokdt_DtG2P this,
+                                             const picoos_uint8 count,
+                                             const picoos_uint8 pos,
+                                             const picoos_uint8 nrvow,
+                                             const picoos_uint8 ordvow,
+                                             picoos_uint8 *primstressflag,
+                                             const picoos_uint16 phonech1,
+                                             const picoos_uint16 phonech2,
+                                             const picoos_uint16 phonech3) {
+    kdtg2p_subobj_t *dtg2p;
+    picoos_uint8 iAttr;
+    picoos_int16 cinv;
+    picoos_uint16 utfcount;
+    picoos_uint16 utfgraphlen;
+
+    dtg2p = (kdtg2p_subobj_t *)this;
+    if (NULL == dtg2p->wgraph) {
+        PICODBG_ERROR(("no word set"));
+        return FALSE;
+    }
+    if (count >= dtg2p->wgraphlen) {
+        return picokdt_dtG2PconstructInVec(this, dtg2p->wgraph,
+                                           dtg2p->wgraphlen, count, pos,
+                                           nrvow, ordvow, primstressflag,
+                                           phonech1, phonech2, phonech3);
+    }
+
+    dtg2p->inveclen = 0;
+    utfgraphlen = dtg2p->wnrchars;
+    utfcount = dtg2p->wcharnr[count];
+
+    /* graph attributes left (context -4/-3/-2/-1) and current */
+    cinv = 4;
+    for (iAttr = 0; iAttr < 5; iAttr++) {
+        if ((utfcount > cinv) && (utfcount <= utfgraphlen)) {
+            dtg2p->invec[iAttr] = dtg2p->wval[iAttr][utfcount-cinv-1];
+        } else if ((utfcount == cinv) && (iAttr != 4)) {
+            dtg2p->invec[iAttr] = dtg2p->eowval[iAttr];
+        } else {
+            dtg2p->invec[iAttr] = dtg2p->outsideval[iAttr];
+        }
+        cinv--;
+    }
+
+    /* graph attributes right (context 1/2/3/4) */
+    cinv = utfgraphlen;
+    for (iAttr = 5; iAttr < PICOKDT_NRGRAPHATT_G2P; iAttr++) {
+        if ((utfcount > 0) && (utfcount <= (cinv - 1))) {
+            dtg2p->invec[iAttr] =
+                dtg2p->wval[iAttr][utfcount+utfgraphlen-cinv];
+        } else if (utfcount == cinv) {
+            dtg2p->invec[iAttr] = dtg2p->eowval[iAttr];
+        } else {
+            dtg2p->invec[iAttr] = dtg2p->outsideval[iAttr];
+        }
+        cinv--;
+    }
+
+    /* other attributes, MapInFixed */
+    if (!kdtG2PSetFixedAttrs(dtg2p, pos, nrvow, ordvow, primstressflag,
+                             phonech1, phonech2, phonech3)) {
+        dtg2p->inveclen = PICOKDT_NRINPMT_G2P;
+        return FALSE;
+    }
+    dtg2p->inveclen = PICOKDT_NRINPMT_G2P;
+    return TRUE;
+}
+
+#endif /* PICOKDT_G2P_MAXWORDLEN > 0 */
+
+
 
 
 picoos_uint8 picokdt_dtG2Pclassify(const picokdt_DtG2P this,
@@ -2479,6 +3127,49 @@ picoos_uint8 picokdt_dtPAMclassify(const picokdt_DtPAM this) {
 }
 
 
+void picokdt_dtPAMclassifyBatch(const picokdt_DtPAM *these,
+                                const picoos_uint8 nrtrees,
+                                picoos_uint8 *classified) {
+    picoos_uint32 iByteNo[PICOKDT_MAXBATCH];
+    picoos_int8 iBitNo[PICOKDT_MAXBATCH];
+    picoos_int8 rv[PICOKDT_MAXBATCH];
+    kdtpam_subobj_t *dtpam;
+    picoos_uint8 first, n, i, active;
+
+    for (first = 0; first < nrtrees; first += n) {
+        n = nrtrees - first;
+        if (n > PICOKDT_MAXBATCH) {
+            n = PICOKDT_MAXBATCH;
+        }
+        for (i = 0; i < n; i++) {
+            iByteNo[i] = 0;
+            iBitNo[i] = 7;
+            rv[i] = 1;
+        }
+        /* one node of each unfinished tree per round */
+        active = n;
+        while (active > 0) {
+            for (i = 0; i < n; i++) {
+                if (rv[i] > 0) {
+                    dtpam = (kdtpam_subobj_t *)these[first + i];
+                    rv[i] = kdtAskTree(&(dtpam->dt), dtpam->invec,
+                                       PICOKDT_NRATT_PAM,
+                                       &iByteNo[i], &iBitNo[i]);
+                    if (rv[i] <= 0) {
+                        active--;
+                    }
+                }
+            }
+        }
+        for (i = 0; i < n; i++) {
+            dtpam = (kdtpam_subobj_t *)these[first + i];
+            PICODBG_DEBUG(("done: %d", dtpam->dt.dclass));
+            classified[first + i] = ((rv[i] == 0) && dtpam->dt.dset);
+        }
+    }
+}
+
+
 picoos_uint8 picokdt_dtPAMdecomposeOutClass(const picokdt_DtPAM this,
                                             picokdt_classify_result_t *dtres) {
     kdtpam_subobj_t *dtpam;
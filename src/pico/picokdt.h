@@ -77,6 +77,38 @@ pico_status_t picokdt_specializeDtKnowledgeBase(picoknow_KnowledgeBase this,
                                                 picoos_Common common,
                                                 const picokdt_kdttype_t type);
 
+/* define PICOKDT_DECODE to expand the bit-packed trees into aligned
+   node, fork and subset arrays when the kb is specialized, so that
+   classification no longer extracts bit fields. PICOKDT_DECODE_TREES
+   selects the tree types to expand, one bit per picokdt_kdttype_t
+   (e.g. (1 << PICOKDT_KDTTYPE_G2P)); the RAM used by each expanded
+   tree is returned by picokdt_getDecodedSize. Trees that cannot be expanded
+   are classified from the packed form as usual */
+#if defined(PICOKDT_DECODE)
+#if !defined(PICOKDT_DECODE_TREES)
+#define PICOKDT_DECODE_TREES 0x3F
+#endif
+#endif
+
+/* define PICOKDT_COMPILED to use the classifiers generated by
+   tools/picokdt_compile.py (picokdt_compiled.c) for all trees whose kb
+   id, size and checksum match the loaded kb; other trees are
+   interpreted as usual */
+#if defined(PICOKDT_COMPILED)
+/* returns the decision for invec, or -1 if no solution is found */
+typedef picoos_int32 (* picokdt_compiledClassify_t)(const picoos_uint16 *invec);
+
+typedef struct {
+    picoos_uint8 kbid;          /* picoknow_kb_id_t of the tree kb */
+    picoos_uint32 size;         /* kb size in bytes */
+    picoos_uint32 checksum;     /* 32 bit FNV-1a over the kb bytes */
+    picokdt_compiledClassify_t classify;
+} picokdt_compiled_t;
+
+extern const picokdt_compiled_t picokdt_compiledTrees[];
+extern const picoos_uint16 picokdt_nrCompiledTrees;
+#endif
+
 
 /* ************************************************************/
 /* decision tree types (opaque) and get Tree functions */
@@ -98,6 +130,11 @@ picokdt_DtPHR  picokdt_getDtPHR (picoknow_KnowledgeBase this);
 picokdt_DtACC  picokdt_getDtACC (picoknow_KnowledgeBase this);
 picokdt_DtPAM  picokdt_getDtPAM (picoknow_KnowledgeBase this);
 
+/* bytes of RAM used by the expanded form of decision tree kb 'this'
+   (cf. PICOKDT_DECODE), 0 if the tree is classified from the packed
+   form; e.g. to choose PICOKDT_DECODE_TREES */
+picoos_uint32 picokdt_getDecodedSize(picoknow_KnowledgeBase this);
+
 
 /* number of attributes (= input vector size) for each tree type */
 typedef enum {
@@ -252,6 +289,38 @@ picoos_uint8 picokdt_dtPosDconstructInVec(const picokdt_DtPosD this,
                                           const picoos_uint16 * input);
 
 
+/* longest word (in bytes) picokdt_dtG2PsetWord accepts; 0 disables the
+   word context */
+#if !defined(PICOKDT_G2P_MAXWORDLEN)
+#define PICOKDT_G2P_MAXWORDLEN 128
+#endif
+
+#if (PICOKDT_G2P_MAXWORDLEN > 0)
+/* set the word for following calls of picokdt_dtG2PconstructWordInVec:
+   the word is decoded and its graphs mapped once, instead of once per
+   position by picokdt_dtG2PconstructInVec. graph must not change while
+   the word is in use
+   returns:       TRUE if okay, FALSE if the word cannot be set (too
+                  long, invalid UTF8 or unmappable graph); use
+                  picokdt_dtG2PconstructInVec in that case
+*/
+picoos_uint8 picokdt_dtG2PsetWord(const picokdt_DtG2P this,
+                                  const picoos_uint8 *graph,
+                                  const picoos_uint16 graphlen);
+
+/* same as picokdt_dtG2PconstructInVec for the word set with
+   picokdt_dtG2PsetWord */
+picoos_uint8 picokdt_dtG2PconstructWordInVec(const picokdt_DtG2P this,
+                                             const picoos_uint8 count,
+                                             const picoos_uint8 pos,
+                                             const picoos_uint8 nrvow,
+                                             const picoos_uint8 ordvow,
+                                             picoos_uint8 *primstressflag,
+                                             const picoos_uint16 phonech1,
+                                             const picoos_uint16 phonech2,
+                                             const picoos_uint16 phonech3);
+#endif
+
 /* classify a previously constructed input vector using tree 'this'
    treeout:       direct tree output value
    returns:       TRUE if okay, FALSE otherwise
@@ -449,6 +518,19 @@ picoos_uint8 picokdt_dtPAMconstructInVec(const picokdt_DtPAM this,
 */
 picoos_uint8 picokdt_dtPAMclassify(const picokdt_DtPAM this);
 
+/* max number of trees classified together by picokdt_dtPAMclassifyBatch */
+#define PICOKDT_MAXBATCH 8
+
+/* classify nrtrees trees, each with the input vector previously
+   constructed in it, interleaving the traversal steps of the trees
+   so that their node accesses overlap
+   classified:    nrtrees values, classified[i] is set to the value
+                  picokdt_dtPAMclassify(these[i]) would return
+*/
+void picokdt_dtPAMclassifyBatch(const picokdt_DtPAM *these,
+                                const picoos_uint8 nrtrees,
+                                picoos_uint8 *classified);
+
 /* decompose the tree output and return the class in dtres
    dtres:         phones vector classification result
    returns:       TRUE if okay, FALSE otherwise
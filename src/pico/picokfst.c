@@ -54,6 +54,15 @@ extern "C" {
 
 typedef struct kfst_subobj * kfst_SubObj;
 
+#if defined(PICOKFST_EXPAND)
+/* entry of an expanded pair or input epsilon list: output symbol and pair
+   class resp. end state; each list is terminated by sym == PICOKFST_SYMID_ILLEG */
+typedef struct kfst_xpair {
+    picokfst_symid_t sym;
+    picoos_int16 val;
+} kfst_xpair_t;
+#endif
+
 typedef struct kfst_subobj{
     picoos_uint8 * fstStream;         /* the byte stream base address */
     picoos_int32 hdrLen;              /* length of file header */
@@ -67,6 +76,15 @@ typedef struct kfst_subobj{
     picoos_int32 transTabPos;         /* absolute address of the start of the transition table */
     picoos_int32 inEpsStateTabPos;    /* absolute address of the start of the input epsilon transition table */
     picoos_int32 accStateTabPos;      /* absolute address of the table of accepting states */
+#if defined(PICOKFST_EXPAND)
+    /* expanded FST (cf. kfstExpand), NULL if not expanded; all tables are
+       held in the allocation starting at symTab */
+    picoos_int32 maxSym;              /* largest input symbol with pairs */
+    picoos_int16 * symTab;            /* [0..maxSym]: start of pair list in xpairs, or -1 */
+    picoos_int16 * inEpsTab;          /* [0..nrStates-1]: start of input epsilon list in xpairs, or -1 */
+    kfst_xpair_t * xpairs;            /* pair and input epsilon lists */
+    picokfst_state_t * trans;         /* [nrStates * nrClasses]: end states */
+#endif
 } kfst_subobj_t;
 
 
@@ -181,10 +199,161 @@ static pico_status_t kfstInitialize(register picoknow_KnowledgeBase this,
 }
 
 
+#if defined(PICOKFST_EXPAND)
+
+/* ************************************************************/
+/* FST expansion */
+/* ************************************************************/
+
+/* copies the symbol list (pairs of numbers terminated by
+   PICOKFST_SYMID_ILLEG) at stream position 'pos' to 'xpairs' (if not NULL)
+   starting at index '*nr'; '*nr' is advanced past the terminator */
+static void kfstExpandList(kfst_subobj_t * kfst, picoos_uint32 pos,
+        kfst_xpair_t * xpairs, picoos_int32 * nr)
+{
+    picoos_int32 sym;
+    picoos_int32 val;
+
+    BytesToNum(kfst->fstStream,& pos,& sym);
+    while (sym != PICOKFST_SYMID_ILLEG) {
+        BytesToNum(kfst->fstStream,& pos,& val);
+        if (NULL != xpairs) {
+            xpairs[*nr].sym = (picokfst_symid_t)sym;
+            xpairs[*nr].val = (picoos_int16)val;
+        }
+        (*nr)++;
+        BytesToNum(kfst->fstStream,& pos,& sym);
+    }
+    if (NULL != xpairs) {
+        xpairs[*nr].sym = PICOKFST_SYMID_ILLEG;
+        xpairs[*nr].val = -1;
+    }
+    (*nr)++;
+}
+
+/* walks the pair alphabet and the input epsilon table; with 'kfst->symTab'
+   NULL, only determines 'kfst->maxSym' and the number of list entries
+   '*nrxpairs', otherwise fills symTab, inEpsTab and xpairs. Returns FALSE
+   if the FST contains input symbols that cannot be indexed */
+static picoos_bool kfstExpandLists(kfst_subobj_t * kfst, picoos_int32 * nrxpairs)
+{
+    picoos_uint32 pos;
+    picoos_int32 h;
+    picoos_int32 offs;
+    picoos_int32 inSymCellPos;
+    picoos_int32 inSym;
+    picoos_int32 nextSameHashInSymOffs;
+    picoos_int32 i;
+
+    (*nrxpairs) = 0;
+    if (NULL != kfst->symTab) {
+        for (i = 0; i <= kfst->maxSym; i++) {
+            kfst->symTab[i] = -1;
+        }
+    } else {
+        kfst->maxSym = -1;
+    }
+    for (h = 0; h < kfst->alphaHashTabSize; h++) {
+        pos = kfst->alphaHashTabPos + (h * 4);
+        FixedBytesToSignedNum(kfst->fstStream,4,& pos,& offs);
+        if (offs > 0) {
+            inSymCellPos = kfst->alphaHashTabPos + offs;
+            do {
+                pos = inSymCellPos;
+                BytesToNum(kfst->fstStream,& pos,& inSym);
+                BytesToNum(kfst->fstStream,& pos,& nextSameHashInSymOffs);
+                if ((inSym < 0) || (inSym % kfst->alphaHashTabSize != h)) {
+                    return FALSE;
+                }
+                if (NULL != kfst->symTab) {
+                    if (kfst->symTab[inSym] < 0) {
+                        /* the byte stream search stops at the first cell */
+                        kfst->symTab[inSym] = (picoos_int16)(*nrxpairs);
+                    }
+                } else if (inSym > kfst->maxSym) {
+                    kfst->maxSym = inSym;
+                }
+                kfstExpandList(kfst, pos, kfst->xpairs, nrxpairs);
+                inSymCellPos = inSymCellPos + nextSameHashInSymOffs;
+            } while (nextSameHashInSymOffs > 0);
+        }
+    }
+    for (i = 0; i < kfst->nrStates; i++) {
+        pos = kfst->inEpsStateTabPos + i * 4;
+        FixedBytesToSignedNum(kfst->fstStream,4,& pos,& offs);
+        if (offs > 0) {
+            if (NULL != kfst->inEpsTab) {
+                kfst->inEpsTab[i] = (picoos_int16)(*nrxpairs);
+            }
+            kfstExpandList(kfst, kfst->inEpsStateTabPos + offs, kfst->xpairs, nrxpairs);
+        } else if (NULL != kfst->inEpsTab) {
+            kfst->inEpsTab[i] = -1;
+        }
+    }
+    return TRUE;
+}
+
+/* expands the pair alphabet into a table of pair lists indexed by input
+   symbol, the input epsilon transitions into lists indexed by state, and
+   the transition table into a dense state x class matrix of end states.
+   If this is not possible, the FST is used from the byte stream */
+static void kfstExpand(picoos_Common common, kfst_subobj_t * kfst)
+{
+    picoos_int32 nrxpairs;
+    picoos_int32 nrtrans;
+    picoos_uint32 size;
+    picoos_uint32 pos;
+    picoos_uint32 endState;
+    picoos_int32 i;
+    picoos_uint8 * mem;
+
+    kfst->symTab = NULL;
+    kfst->inEpsTab = NULL;
+    kfst->xpairs = NULL;
+    kfst->trans = NULL;
+    if ((kfst->nrStates <= 0) || (kfst->nrClasses <= 0)
+        || (kfst->nrStates > 32767) || (kfst->alphaHashTabSize <= 0)
+        || (kfst->transTabEntrySize > 2)
+        || !kfstExpandLists(kfst, & nrxpairs) || (nrxpairs > 32767)) {
+        PICODBG_WARN(("cannot expand FST, using byte stream"));
+        return;
+    }
+    nrtrans = kfst->nrStates * kfst->nrClasses;
+    size = (kfst->maxSym + 1 + kfst->nrStates) * sizeof(picoos_int16)
+            + nrxpairs * sizeof(kfst_xpair_t)
+            + nrtrans * sizeof(picokfst_state_t);
+    mem = (picoos_uint8 *) picoos_allocate(common->mm, size);
+    if (NULL == mem) {
+        PICODBG_WARN(("no memory to expand FST, using byte stream"));
+        return;
+    }
+    kfst->symTab = (picoos_int16 *) mem;
+    kfst->inEpsTab = kfst->symTab + (kfst->maxSym + 1);
+    kfst->xpairs = (kfst_xpair_t *) (kfst->inEpsTab + kfst->nrStates);
+    kfst->trans = (picokfst_state_t *) (kfst->xpairs + nrxpairs);
+    kfstExpandLists(kfst, & nrxpairs);
+    pos = kfst->transTabPos;
+    for (i = 0; i < nrtrans; i++) {
+        FixedBytesToUnsignedNum(kfst->fstStream,kfst->transTabEntrySize,& pos,& endState);
+        kfst->trans[i] = (picokfst_state_t)endState;
+    }
+    PICODBG_INFO(("expanded FST: %d states, %d classes, %d symbols, %d bytes",
+                  kfst->nrStates, kfst->nrClasses, kfst->maxSym + 1, size));
+}
+
+#endif /* PICOKFST_EXPAND */
+
+
 static pico_status_t kfstSubObjDeallocate(register picoknow_KnowledgeBase this,
         picoos_MemoryManager mm)
 {
     if (NULL != this) {
+#if defined(PICOKFST_EXPAND)
+        if ((NULL != this->subObj)
+            && (NULL != ((kfst_subobj_t *)this->subObj)->symTab)) {
+            picoos_deallocate(mm, (void *) &((kfst_subobj_t *)this->subObj)->symTab);
+        }
+#endif
         picoos_deallocate(mm, (void *) &this->subObj);
     }
     return PICO_OK;
@@ -215,6 +384,11 @@ pico_status_t picokfst_specializeFSTKnowledgeBase(picoknow_KnowledgeBase this,
         if (PICO_OK != status) {
             picoos_deallocate(common->mm,(void **)&this->subObj);
         }
+#if defined(PICOKFST_EXPAND)
+        else {
+            kfstExpand(common, (kfst_subobj_t *) this->subObj);
+        }
+#endif
     }
     return PICO_OK;
 }
@@ -232,7 +406,7 @@ picokfst_FST picokfst_getFST(picoknow_KnowledgeBase this)
     if (NULL == this) {
         return NULL;
     } else {
-        return (picokfst_FST) this->subObj;
+        return (picokfst_FST) picoknow_getSubObj(this);
     }
 }
 
@@ -282,6 +456,16 @@ extern void picokfst_kfstStartPairSearch (picokfst_FST this, picokfst_symid_t in
     kfst_SubObj fst = (kfst_SubObj) this;
     (*searchState) =  -1;
     (*inSymFound) = 0;
+#if defined(PICOKFST_EXPAND)
+    if (NULL != fst->symTab) {
+        /* search state is index into fst->xpairs */
+        if ((inSym >= 0) && (inSym <= fst->maxSym) && (fst->symTab[inSym] >= 0)) {
+            (*searchState) = fst->symTab[inSym];
+            (*inSymFound) = 1;
+        }
+        return;
+    }
+#endif
     h = inSym % fst->alphaHashTabSize;
     pos = fst->alphaHashTabPos + (h * 4);
     FixedBytesToSignedNum(fst->fstStream,4,& pos,& offs);
@@ -318,6 +502,19 @@ extern void picokfst_kfstGetNextPair (picokfst_FST this, picoos_int32 * searchSt
         (*pairFound) = 0;
         (*outSym) = PICOKFST_SYMID_ILLEG;
         (*pairClass) =  -1;
+#if defined(PICOKFST_EXPAND)
+    } else if (NULL != fst->symTab) {
+        (*outSym) = fst->xpairs[*searchState].sym;
+        if ((*outSym) != PICOKFST_SYMID_ILLEG) {
+            (*pairClass) = (picokfst_class_t)fst->xpairs[*searchState].val;
+            (*pairFound) = 1;
+            (*searchState)++;
+        } else {
+            (*pairFound) = 0;
+            (*pairClass) =  -1;
+            (*searchState) =  -1;
+        }
+#endif
     } else {
         pos = (*searchState);
         BytesToNum(fst->fstStream,& pos,& val);
@@ -350,6 +547,10 @@ extern void picokfst_kfstGetTrans (picokfst_FST this, picokfst_state_t startStat
     kfst_SubObj fst = (kfst_SubObj) this;
     if ((startState < 1) || (startState > fst->nrStates) || (transClass < 1) || (transClass > fst->nrClasses)) {
         (*endState) = 0;
+#if defined(PICOKFST_EXPAND)
+    } else if (NULL != fst->trans) {
+        (*endState) = fst->trans[(startState - 1) * fst->nrClasses + transClass - 1];
+#endif
     } else {
         index = (startState - 1) * fst->nrClasses + transClass - 1;
         pos = fst->transTabPos + (index * fst->transTabEntrySize);
@@ -370,6 +571,16 @@ extern void picokfst_kfstStartInEpsTransSearch (picokfst_FST this, picokfst_stat
     kfst_SubObj fst = (kfst_SubObj) this;
     (*searchState) =  -1;
     (*inEpsTransFound) = 0;
+#if defined(PICOKFST_EXPAND)
+    if ((NULL != fst->inEpsTab) && (startState > 0) && (startState <= fst->nrStates)) {
+        /* search state is index into fst->xpairs */
+        if (fst->inEpsTab[startState - 1] >= 0) {
+            (*searchState) = fst->inEpsTab[startState - 1];
+            (*inEpsTransFound) = 1;
+        }
+        return;
+    }
+#endif
     if ((startState > 0) && (startState <= fst->nrStates)) {
         pos = fst->inEpsStateTabPos + (startState - 1) * 4;
         FixedBytesToSignedNum(fst->fstStream,4,& pos,& offs);
@@ -395,6 +606,19 @@ extern void picokfst_kfstGetNextInEpsTrans (picokfst_FST this, picoos_int32 * se
         (*inEpsTransFound) = 0;
         (*outSym) = PICOKFST_SYMID_ILLEG;
         (*endState) = 0;
+#if defined(PICOKFST_EXPAND)
+    } else if (NULL != fst->inEpsTab) {
+        (*outSym) = fst->xpairs[*searchState].sym;
+        if ((*outSym) != PICOKFST_SYMID_ILLEG) {
+            (*endState) = (picokfst_state_t)fst->xpairs[*searchState].val;
+            (*inEpsTransFound) = 1;
+            (*searchState)++;
+        } else {
+            (*inEpsTransFound) = 0;
+            (*endState) = 0;
+            (*searchState) =  -1;
+        }
+#endif
     } else {
         pos = (*searchState);
         BytesToNum(fst->fstStream,& pos,& val);
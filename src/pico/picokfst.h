@@ -98,6 +98,13 @@ pico_status_t picokfst_specializeFSTKnowledgeBase(picoknow_KnowledgeBase this,
 /* FST type */
 typedef struct picokfst_fst * picokfst_FST;
 
+/* define PICOKFST_EXPAND to expand each FST into RAM when the kb is
+   specialized: pair lists indexed by input symbol, input epsilon
+   transitions indexed by state, and a dense state x class table of end
+   states, so that the access methods below no longer decode the byte
+   stream. The RAM used is reported with PICODBG_INFO; FSTs that cannot
+   be expanded are used from the byte stream as usual */
+
 /* return kb FST for usage in PU */
 picokfst_FST picokfst_getFST(picoknow_KnowledgeBase this);
 
@@ -137,14 +137,180 @@ extern "C" {
 
 typedef struct klex_subobj *klex_SubObj;
 
+#if defined(PICOKLEX_HASHINDEX)
+/* hash index slot: entry offset in lexblocks (PICOKLEX_IND_SIZE bytes)
+   and 8 bits of the graph hash to skip most non-matching entries */
+#define KLEX_HASH_EMPTY    0xFFFFFFFF
+#define KLEX_HASH_OFSMASK  0x00FFFFFF
+/* Bloom filter: bits per distinct graph and nr of bits set per graph */
+#define KLEX_BLOOM_BITS_PER_GRAPH 8
+#define KLEX_BLOOM_NRHASH  3
+#endif
+
 typedef struct klex_subobj
 {
     picoos_uint16 nrblocks; /* nr lexblocks = nr eles in searchind */
     picoos_uint8 *searchind;
     picoos_uint8 *lexblocks;
+#if defined(PICOKLEX_HASHINDEX)
+    picoos_uint32 *hashind;  /* hashMask+1 slots, or NULL */
+    picoos_uint32 hashMask;
+    picoos_uint8 *bloom;     /* bloomMask+1 bits */
+    picoos_uint32 bloomMask;
+#endif
 } klex_subobj_t;
 
 
+#if defined(PICOKLEX_HASHINDEX)
+
+static picoos_int8 klex_lexMatch(picoos_uint8 *lexentry,
+                                 const picoos_uint8 *graph,
+                                 const picoos_uint16 graphlen);
+
+/* FNV-1a hash of a grapheme string */
+static picoos_uint32 klex_graphHash(const picoos_uint8 *graph,
+                                    const picoos_uint16 graphlen)
+{
+    picoos_uint32 h = 2166136261u;
+    picoos_uint16 i;
+
+    for (i = 0; i < graphlen; i++) {
+        h = (h ^ graph[i]) * 16777619u;
+    }
+    return h;
+}
+
+/* returns TRUE if the Bloom filter bit for hash 'h' and probe 'i' is set;
+   if 'set' is TRUE the bit is set first */
+static picoos_uint8 klex_bloomBit(klex_SubObj klex, picoos_uint32 h,
+                                  picoos_uint8 i, picoos_uint8 set)
+{
+    picoos_uint32 bit;
+
+    /* double hashing, second hash from the rotated first one */
+    bit = (h + i * (((h >> 17) | (h << 15)) | 1)) & klex->bloomMask;
+    if (set) {
+        klex->bloom[bit >> 3] |= (picoos_uint8)(1 << (bit & 7));
+    }
+    return (klex->bloom[bit >> 3] >> (bit & 7)) & 1;
+}
+
+/* builds the hash index over all lexentries; the first entry of each
+   run of entries with the same graph is indexed, like the search index
+   lookup would find it */
+static void klexInitHashIndex(klex_SubObj klex, picoos_Common common)
+{
+    picoos_uint32 lexpos, blockend, lexend, prevpos, n, size, h, slot;
+    picoos_uint8 i, pass;
+
+    klex->hashind = NULL;
+    klex->bloom = NULL;
+    lexend = (picoos_uint32)klex->nrblocks * PICOKLEX_LEXBLOCK_SIZE;
+    /* a slot holds offsets below KLEX_HASH_OFSMASK only (the mask itself
+       would be taken for an empty slot), larger lexicons use the search
+       index */
+    if (lexend > KLEX_HASH_OFSMASK) {
+        PICODBG_WARN(("lexicon too large for lex hash index (%d bytes), using search index",
+                      lexend));
+        return;
+    }
+
+    /* pass 0 counts distinct graphs, pass 1 fills the tables */
+    n = 0;
+    for (pass = 0; pass < 2; pass++) {
+        prevpos = KLEX_HASH_EMPTY;
+        for (blockend = PICOKLEX_LEXBLOCK_SIZE; blockend <= lexend;
+             blockend += PICOKLEX_LEXBLOCK_SIZE) {
+            lexpos = blockend - PICOKLEX_LEXBLOCK_SIZE;
+            while ((lexpos < blockend) && (klex->lexblocks[lexpos] != 0)) {
+                if ((prevpos == KLEX_HASH_EMPTY) ||
+                    (klex_lexMatch(&(klex->lexblocks[prevpos]),
+                                   &(klex->lexblocks[lexpos + 1]),
+                                   klex->lexblocks[lexpos] - 1) != 0)) {
+                    if (pass == 0) {
+                        n++;
+                    } else {
+                        h = klex_graphHash(&(klex->lexblocks[lexpos + 1]),
+                                           klex->lexblocks[lexpos] - 1);
+                        for (i = 0; i < KLEX_BLOOM_NRHASH; i++) {
+                            klex_bloomBit(klex, h, i, TRUE);
+                        }
+                        slot = h & klex->hashMask;
+                        while (klex->hashind[slot] != KLEX_HASH_EMPTY) {
+                            slot = (slot + 1) & klex->hashMask;
+                        }
+                        klex->hashind[slot] = (h & ~KLEX_HASH_OFSMASK) | lexpos;
+                    }
+                    prevpos = lexpos;
+                }
+                lexpos += klex->lexblocks[lexpos];
+                lexpos += klex->lexblocks[lexpos];
+            }
+        }
+        if (pass == 0) {
+            if (n == 0) {
+                return;
+            }
+            /* load factor at most 2/3 */
+            size = 1;
+            while (size < n + n / 2) {
+                size <<= 1;
+            }
+            klex->hashind = picoos_allocate(common->mm, size * sizeof(picoos_uint32));
+            klex->hashMask = size - 1;
+            size = 8;
+            while (size < n * KLEX_BLOOM_BITS_PER_GRAPH) {
+                size <<= 1;
+            }
+            klex->bloom = picoos_allocate(common->mm, size / 8);
+            klex->bloomMask = size - 1;
+            if ((NULL == klex->hashind) || (NULL == klex->bloom)) {
+                PICODBG_WARN(("no memory for lex hash index, using search index"));
+                picoos_deallocate(common->mm, (void *) &klex->hashind);
+                picoos_deallocate(common->mm, (void *) &klex->bloom);
+                return;
+            }
+            for (h = 0; h <= klex->hashMask; h++) {
+                klex->hashind[h] = KLEX_HASH_EMPTY;
+            }
+            for (h = 0; h < size / 8; h++) {
+                klex->bloom[h] = 0;
+            }
+        }
+    }
+    PICODBG_DEBUG(("lex hash index: %d graphs, %d slots", n, klex->hashMask + 1));
+}
+
+/* returns the position of the first lexentry with graph 'graph', or
+   KLEX_HASH_EMPTY if there is none */
+static picoos_uint32 klex_hashLookup(klex_SubObj klex,
+                                     const picoos_uint8 *graph,
+                                     const picoos_uint16 graphlen)
+{
+    picoos_uint32 h, slot;
+    picoos_uint8 i;
+
+    h = klex_graphHash(graph, graphlen);
+    for (i = 0; i < KLEX_BLOOM_NRHASH; i++) {
+        if (!klex_bloomBit(klex, h, i, FALSE)) {
+            return KLEX_HASH_EMPTY;
+        }
+    }
+    slot = h & klex->hashMask;
+    while (klex->hashind[slot] != KLEX_HASH_EMPTY) {
+        if ((((klex->hashind[slot] ^ h) & ~KLEX_HASH_OFSMASK) == 0) &&
+            (klex_lexMatch(&(klex->lexblocks[klex->hashind[slot] & KLEX_HASH_OFSMASK]),
+                           graph, graphlen) == 0)) {
+            return klex->hashind[slot] & KLEX_HASH_OFSMASK;
+        }
+        slot = (slot + 1) & klex->hashMask;
+    }
+    return KLEX_HASH_EMPTY;
+}
+
+#endif
+
+
 static pico_status_t klexInitialize(register picoknow_KnowledgeBase this,
                                     picoos_Common common)
 {
@@ -171,6 +337,9 @@ static pico_status_t klexInitialize(register picoknow_KnowledgeBase this,
         }
         klex->lexblocks = this->base + PICOKLEX_LEX_NRBLOCKS_SIZE +
                              (klex->nrblocks * (PICOKLEX_LEX_SIE_SIZE));
+#if defined(PICOKLEX_HASHINDEX)
+        klexInitHashIndex(klex, common);
+#endif
         return PICO_OK;
     } else {
         return picoos_emRaiseException(common->em, PICO_EXC_FILE_CORRUPT,
@@ -183,6 +352,12 @@ static pico_status_t klexSubObjDeallocate(register picoknow_KnowledgeBase this,
                                           picoos_MemoryManager mm)
 {
     if (NULL != this) {
+#if defined(PICOKLEX_HASHINDEX)
+        if (NULL != this->subObj) {
+            picoos_deallocate(mm, (void *) &(((klex_SubObj) this->subObj)->hashind));
+            picoos_deallocate(mm, (void *) &(((klex_SubObj) this->subObj)->bloom));
+        }
+#endif
         picoos_deallocate(mm, (void *) &this->subObj);
     }
     return PICO_OK;
@@ -234,7 +409,7 @@ picoklex_Lex picoklex_getLex(picoknow_KnowledgeBase this)
     if (NULL == this) {
         return NULL;
     } else {
-        return (picoklex_Lex) this->subObj;
+        return (picoklex_Lex) picoknow_getSubObj(this);
     }
 }
 
@@ -512,12 +687,26 @@ picoos_uint8 picoklex_lexLookup(const picoklex_Lex this,
         /* no searchindex, no lexblock */
         PICODBG_WARN(("no searchindex, no lexblock"));
         return FALSE;
-    } else {
-        lbnr = klex_getLexblockNr(klex, tgraph);
-        PICODBG_ASSERT(lbnr < klex->nrblocks);
-        lbc = klex_getLexblockRange(klex, lbnr);
-        PICODBG_ASSERT((lbc >= 1) && (lbc <= klex->nrblocks));
     }
+#if defined(PICOKLEX_HASHINDEX)
+    if (NULL != klex->hashind) {
+        /* one probe instead of search index and block scan; further
+           entries with the same graph follow directly */
+        lexposStart = klex_hashLookup(klex, graph, graphlen);
+        if (lexposStart == KLEX_HASH_EMPTY) {
+            return FALSE;
+        }
+        klex_lexblockLookup(klex, lexposStart,
+                            (picoos_uint32)klex->nrblocks * PICOKLEX_LEXBLOCK_SIZE,
+                            graph, graphlen, lexres);
+        PICODBG_DEBUG(("hash lookup done, %d found", lexres->nrres));
+        return (lexres->nrres > 0);
+    }
+#endif
+    lbnr = klex_getLexblockNr(klex, tgraph);
+    PICODBG_ASSERT(lbnr < klex->nrblocks);
+    lbc = klex_getLexblockRange(klex, lbnr);
+    PICODBG_ASSERT((lbc >= 1) && (lbc <= klex->nrblocks));
     PICODBG_DEBUG(("lexblock nr: %d (#%d)", lbnr, lbc));
 
     lexposStart = lbnr * PICOKLEX_LEXBLOCK_SIZE;
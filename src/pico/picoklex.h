@@ -56,6 +56,12 @@ pico_status_t picoklex_specializeLexKnowledgeBase(picoknow_KnowledgeBase this,
 /* lexicon type */
 typedef struct picoklex_lex * picoklex_Lex;
 
+/* define PICOKLEX_HASHINDEX to build, when a lexicon is loaded, a hash
+   table of entry offsets keyed on the full grapheme string plus a Bloom
+   filter for words not in the lexicon. Costs 6 to 12 bytes RAM per
+   distinct lexicon graph (about 144KB for en-US); lookups fall back to
+   the search index if the tables cannot be allocated */
+
 /* return kb lex for usage in PU */
 picoklex_Lex picoklex_getLex(picoknow_KnowledgeBase this);
 
@@ -56,10 +56,39 @@ extern picoknow_KnowledgeBase picoknow_newKnowledgeBase(picoos_MemoryManager mm)
         this->size = 0;
         this->subObj = NULL;
         this->subDeallocate = NULL;
+#if defined(PICOKNOW_LAZY_INIT)
+        this->specialize = NULL;
+        this->common = NULL;
+#endif
     }
     return this;
 }
 
+#if defined(PICOKNOW_LAZY_INIT)
+extern void * picoknow_getSubObj(picoknow_KnowledgeBase this)
+{
+    picoknow_kbSpecialize specialize;
+
+    if (NULL == this) {
+        return NULL;
+    }
+    if (NULL != this->specialize) {
+        specialize = this->specialize;
+        this->specialize = NULL;
+        PICODBG_DEBUG(("specializing kb id=%i on first use", this->id));
+        if (PICO_OK != specialize(this, this->common)) {
+            /* e.g. out of memory; try again on the next use */
+            if (NULL != this->subObj) {
+                this->subDeallocate(this, this->common->mm);
+                this->subObj = NULL;
+            }
+            this->specialize = specialize;
+        }
+    }
+    return this->subObj;
+}
+#endif
+
 extern void picoknow_disposeKnowledgeBase(picoos_MemoryManager mm, picoknow_KnowledgeBase * this)
 {
     picoos_uint8 id;
@@ -166,6 +166,13 @@ typedef struct picoknow_knowledge_base * picoknow_KnowledgeBase;
 
 typedef pico_status_t (* picoknow_kbSubDeallocate) (register picoknow_KnowledgeBase this, picoos_MemoryManager mm);
 
+/* define PICOKNOW_LAZY_INIT to specialize each kb when its sub-object is
+   first asked for (by the picok*_get* functions, e.g. when a PU that uses
+   the kb is initialized) instead of when its resource is loaded; kbs that
+   are never used then neither take time nor memory. Without it all kbs are
+   specialized eagerly, as the resource is loaded. */
+typedef pico_status_t (* picoknow_kbSpecialize) (register picoknow_KnowledgeBase this, picoos_Common common);
+
 typedef struct picoknow_knowledge_base {
     /* public */
     picoknow_KnowledgeBase next;
@@ -176,12 +183,24 @@ typedef struct picoknow_knowledge_base {
     /* protected */
     picoknow_kbSubDeallocate subDeallocate;
     void * subObj;
+#if defined(PICOKNOW_LAZY_INIT)
+    picoknow_kbSpecialize specialize; /* pending specialization, or NULL */
+    picoos_Common common;
+#endif
 } picoknow_knowledge_base_t;
 
 extern picoknow_KnowledgeBase picoknow_newKnowledgeBase(picoos_MemoryManager mm);
 
 extern void picoknow_disposeKnowledgeBase(picoos_MemoryManager mm, picoknow_KnowledgeBase * this);
 
+/* returns the sub-object of 'this' (NULL if 'this' is NULL), specializing
+   the kb first if that is pending */
+#if defined(PICOKNOW_LAZY_INIT)
+extern void * picoknow_getSubObj(picoknow_KnowledgeBase this);
+#else
+#define picoknow_getSubObj(this) ((NULL == (this)) ? NULL : (this)->subObj)
+#endif
+
 #ifdef __cplusplus
 }
 #endif
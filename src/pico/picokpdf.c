@@ -89,6 +89,36 @@ extern "C" {
 /* pdf loading */
 /* ************************************************************/
 
+#if defined(PICOKPDF_PREDECODE)
+/**
+ * expands the nibble coded dur pdf into PICOKPDF_DUR_DEC_ELEMS bytes per
+ * frame (phone duration and number of frames for 5 states, already mapped
+ * through phonquant/statequant); leaves decoded at NULL if out of memory
+ */
+static void kpdfDURPredecode(picokpdf_pdfdur_t *pdfdur, picoos_Common common)
+{
+    picoos_uint16 f;
+    picoos_uint8 *item, *dec;
+
+    pdfdur->decoded = picoos_allocate(common->mm, (picoos_uint32)pdfdur->numframes *
+                                      PICOKPDF_DUR_DEC_ELEMS * sizeof(picoos_uint8));
+    if (NULL == pdfdur->decoded) {
+        PICODBG_WARN(("no memory for predecoded dur pdf, using packed pdf"));
+        return;
+    }
+    for (f = 0; f < pdfdur->numframes; f++) {
+        item = &(pdfdur->content[(picoos_uint32)f * pdfdur->vecsize]);
+        dec = &(pdfdur->decoded[(picoos_uint32)f * PICOKPDF_DUR_DEC_ELEMS]);
+        dec[0] = pdfdur->phonquant[(item[0] & 0xF0) >> 4];
+        dec[1] = pdfdur->statequant[item[0] & 0x0F];
+        dec[2] = pdfdur->statequant[(item[1] & 0xF0) >> 4];
+        dec[3] = pdfdur->statequant[item[1] & 0x0F];
+        dec[4] = pdfdur->statequant[(item[2] & 0xF0) >> 4];
+        dec[5] = pdfdur->statequant[item[2] & 0x0F];
+    }
+}
+#endif
+
 static pico_status_t kpdfDURInitialize(register picoknow_KnowledgeBase this,
                                        picoos_Common common) {
     picokpdf_pdfdur_t *pdfdur;
@@ -124,6 +154,9 @@ static pico_status_t kpdfDURInitialize(register picoknow_KnowledgeBase this,
         return picoos_emRaiseException(common->em, PICO_EXC_FILE_CORRUPT,
                                        NULL, NULL);
     }
+#if defined(PICOKPDF_PREDECODE)
+    kpdfDURPredecode(pdfdur, common);
+#endif
     PICODBG_DEBUG(("dur pdf initialized"));
     return PICO_OK;
 }
@@ -141,6 +174,81 @@ static picoos_uint8 convScaleFactorToBig(picoos_uint8 pow, picoos_uint8 bigpow)
     return pow;
 }
 
+#if defined(PICOKPDF_PREDECODE)
+/**
+ * reads the cc'th packed mean of a mul pdf vector and scales it by
+ * 2^meanpowUm[pc], keeping the sign
+ */
+static picoos_int32 kpdfMULMean(picokpdf_pdfmul_t *pdfmul, picoos_uint8 *p,
+                                picoos_uint8 pc)
+{
+    picoos_int32 mean;
+
+    mean = ((picoos_int32) ((picoos_int16) (*(p + 1) << 8)) | *p);
+    if (mean >= 0) {
+        mean <<= pdfmul->meanpowUm[pc];
+    } else {
+        mean = -(-mean << pdfmul->meanpowUm[pc]);
+    }
+    return mean;
+}
+
+/**
+ * expands the packed mul pdf into ceporder x PICOKPDF_DEC_ELEMS int32 per
+ * frame, so that all values a frame contributes to one cepstral dimension
+ * are adjacent: (mean, ivar) for static, delta and delta delta. Sparse
+ * delta means not present in the pdf are stored as 0. Leaves decoded at
+ * NULL if out of memory
+ */
+static void kpdfMULPredecode(picokpdf_pdfmul_t *pdfmul, picoos_Common common)
+{
+    picoos_uint16 f;
+    picoos_uint8 c, s, ind, ceporder, numdeltas;
+    picoos_uint8 *vec;
+    picoos_uint32 ivarstart;
+    picoos_int32 *dec;
+
+    ceporder = pdfmul->ceporder;
+    pdfmul->decoded = picoos_allocate(common->mm, (picoos_uint32)pdfmul->numframes *
+                                      ceporder * PICOKPDF_DEC_ELEMS * sizeof(picoos_int32));
+    if (NULL == pdfmul->decoded) {
+        PICODBG_WARN(("no memory for predecoded mul pdf, using packed pdf"));
+        return;
+    }
+    numdeltas = (pdfmul->numdeltas == 0xFF) ? 0 : pdfmul->numdeltas;
+    ivarstart = (pdfmul->numdeltas == 0xFF) ? ceporder * 6 : ceporder * 2 + numdeltas * 3;
+    for (f = 0; f < pdfmul->numframes; f++) {
+        vec = pdfmul->content + (picoos_uint32)f * pdfmul->vecsize + pdfmul->numvuv;
+        dec = pdfmul->decoded + (picoos_uint32)f * ceporder * PICOKPDF_DEC_ELEMS;
+        for (c = 0; c < ceporder; c++) {
+            for (s = 0; s < KPDF_NUMSTREAMS; s++) {
+                if (pdfmul->numdeltas == 0xFF) {
+                    dec[c * PICOKPDF_DEC_ELEMS + 2 * s] = kpdfMULMean(pdfmul,
+                            vec + (s * ceporder + c) * 2, s * ceporder + c);
+                } else if (s == 0) {
+                    dec[c * PICOKPDF_DEC_ELEMS] = kpdfMULMean(pdfmul, vec + c * 2, c);
+                } else {
+                    dec[c * PICOKPDF_DEC_ELEMS + 2 * s] = 0;
+                }
+                dec[c * PICOKPDF_DEC_ELEMS + 2 * s + 1] = (picoos_int32) (vec[ivarstart
+                        + s * ceporder + c]) << (pdfmul->ivarpow[s * ceporder + c]);
+            }
+        }
+        /* sparse delta and delta delta means: index ind < ceporder is the
+         * delta of dimension ind, ind >= ceporder the delta delta of
+         * dimension ind-ceporder */
+        for (s = 0; s < numdeltas; s++) {
+            ind = vec[ceporder * 2 + s];
+            if (ind < 2 * ceporder) {
+                c = (ind < ceporder) ? ind : ind - ceporder;
+                dec[c * PICOKPDF_DEC_ELEMS + ((ind < ceporder) ? 2 : 4)] = kpdfMULMean(
+                        pdfmul, vec + ceporder * 2 + numdeltas + s * 2, ceporder + ind);
+            }
+        }
+    }
+}
+#endif
+
 static pico_status_t kpdfMULInitialize(register picoknow_KnowledgeBase this,
                                        picoos_Common common) {
     picokpdf_pdfmul_t *pdfmul;
@@ -242,10 +350,37 @@ static pico_status_t kpdfMULInitialize(register picoknow_KnowledgeBase this,
         return picoos_emRaiseException(common->em, PICO_EXC_FILE_CORRUPT,
                                        NULL, NULL);
     }
+#if defined(PICOKPDF_PREDECODE)
+    kpdfMULPredecode(pdfmul, common);
+#endif
     PICODBG_DEBUG(("mul pdf initialized"));
     return PICO_OK;
 }
 
+#if defined(PICOKPDF_PREDECODE)
+/**
+ * converts the little endian content offsets of the phs pdf into native
+ * uint32; leaves decoded at NULL if out of memory
+ */
+static void kpdfPHSPredecode(picokpdf_pdfphs_t *pdfphs, picoos_Common common)
+{
+    picoos_uint16 i;
+    picoos_uint8 *p;
+
+    pdfphs->decoded = picoos_allocate(common->mm, (picoos_uint32)pdfphs->numvectors *
+                                      sizeof(picoos_uint32));
+    if (NULL == pdfphs->decoded) {
+        PICODBG_WARN(("no memory for predecoded phs pdf, using packed pdf"));
+        return;
+    }
+    for (i = 0; i < pdfphs->numvectors; i++) {
+        p = pdfphs->indexBase + (picoos_uint32)i * sizeof(picoos_uint32);
+        pdfphs->decoded[i] = ((picoos_uint32)p[3] << 24) | ((picoos_uint32)p[2] << 16) |
+                             ((picoos_uint32)p[1] << 8) | (picoos_uint32)p[0];
+    }
+}
+#endif
+
 static pico_status_t kpdfPHSInitialize(register picoknow_KnowledgeBase this,
                                        picoos_Common common) {
     picokpdf_pdfphs_t *pdfphs;
@@ -264,6 +399,9 @@ static pico_status_t kpdfPHSInitialize(register picoknow_KnowledgeBase this,
     pos += 2;
     pdfphs->indexBase = &(this->base[pos]);
     pdfphs->contentBase = pdfphs->indexBase + pdfphs->numvectors * sizeof(picoos_uint32);
+#if defined(PICOKPDF_PREDECODE)
+    kpdfPHSPredecode(pdfphs, common);
+#endif
     PICODBG_DEBUG(("phs pdf initialized"));
     return PICO_OK;
 }
@@ -280,6 +418,9 @@ static pico_status_t kpdfMULSubObjDeallocate(register picoknow_KnowledgeBase thi
         pdfmul = (picokpdf_pdfmul_t *)this->subObj;
         picoos_deallocate(mm,(void *) &(pdfmul->meanpowUm));
         picoos_deallocate(mm,(void *) &(pdfmul->ivarpow));
+#if defined(PICOKPDF_PREDECODE)
+        picoos_deallocate(mm,(void *) &(pdfmul->decoded));
+#endif
         picoos_deallocate(mm, (void *) &(this->subObj));
     }
     return PICO_OK;
@@ -288,6 +429,11 @@ static pico_status_t kpdfMULSubObjDeallocate(register picoknow_KnowledgeBase thi
 static pico_status_t kpdfDURSubObjDeallocate(register picoknow_KnowledgeBase this,
                                           picoos_MemoryManager mm) {
     if (NULL != this) {
+#if defined(PICOKPDF_PREDECODE)
+        if (NULL != this->subObj) {
+            picoos_deallocate(mm, (void *) &(((picokpdf_pdfdur_t *)this->subObj)->decoded));
+        }
+#endif
         picoos_deallocate(mm, (void *) &this->subObj);
     }
     return PICO_OK;
@@ -296,6 +442,11 @@ static pico_status_t kpdfDURSubObjDeallocate(register picoknow_KnowledgeBase thi
 static pico_status_t kpdfPHSSubObjDeallocate(register picoknow_KnowledgeBase this,
                                           picoos_MemoryManager mm) {
     if (NULL != this) {
+#if defined(PICOKPDF_PREDECODE)
+        if (NULL != this->subObj) {
+            picoos_deallocate(mm, (void *) &(((picokpdf_pdfphs_t *)this->subObj)->decoded));
+        }
+#endif
         picoos_deallocate(mm, (void *) &this->subObj);
     }
     return PICO_OK;
@@ -361,15 +512,15 @@ pico_status_t picokpdf_specializePdfKnowledgeBase(picoknow_KnowledgeBase this,
 /* ************************************************************/
 
 picokpdf_PdfDUR picokpdf_getPdfDUR(picoknow_KnowledgeBase this) {
-    return ((NULL == this) ? NULL : ((picokpdf_PdfDUR) this->subObj));
+    return ((NULL == this) ? NULL : ((picokpdf_PdfDUR) picoknow_getSubObj(this)));
 }
 
 picokpdf_PdfMUL picokpdf_getPdfMUL(picoknow_KnowledgeBase this) {
-    return ((NULL == this) ? NULL : ((picokpdf_PdfMUL) this->subObj));
+    return ((NULL == this) ? NULL : ((picokpdf_PdfMUL) picoknow_getSubObj(this)));
 }
 
 picokpdf_PdfPHS picokpdf_getPdfPHS(picoknow_KnowledgeBase this) {
-    return ((NULL == this) ? NULL : ((picokpdf_PdfPHS) this->subObj));
+    return ((NULL == this) ? NULL : ((picokpdf_PdfPHS) picoknow_getSubObj(this)));
 }
 
 
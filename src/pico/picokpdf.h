@@ -71,6 +71,19 @@ extern "C" {
 
 #define PICOKPDF_BIG_POW 12
 
+/* define PICOKPDF_PREDECODE to expand the pdfs into natively typed tables
+ * when the knowledge base is loaded. This removes the shift/sign decoding
+ * from every pdf access at the cost of RAM (about 24 bytes per mul pdf
+ * frame and cepstral dimension); if the tables cannot be allocated the
+ * packed pdfs are used as usual */
+
+/* per mul frame and dimension: mean and ivar for static, delta and
+ * delta delta, i.e. KPDF_NUMSTREAMS x (mean, ivar) */
+#define PICOKPDF_DEC_ELEMS 6
+
+/* per dur frame: phone duration and number of frames for 5 states */
+#define PICOKPDF_DUR_DEC_ELEMS 6
+
 typedef enum {
     PICOKPDF_KPDFTYPE_DUR,
     PICOKPDF_KPDFTYPE_MUL,
@@ -105,6 +118,9 @@ typedef struct picokpdf_pdfdur {
     picoos_uint8 statequantlen;
     picoos_uint8 *statequant;
     picoos_uint8 *content;
+#if defined(PICOKPDF_PREDECODE)
+    picoos_uint8 *decoded;    /* numframes x PICOKPDF_DUR_DEC_ELEMS values, or NULL */
+#endif
 } picokpdf_pdfdur_t;
 
 /* subobj specific for pdf mul type */
@@ -122,6 +138,9 @@ typedef struct picokpdf_pdfmul {
     picoos_uint8 *meanpowUm;  /* KPDF_NUMSTREAMS x ceporder values */
     picoos_uint8 *ivarpow;    /* KPDF_NUMSTREAMS x ceporder values */
     picoos_uint8 *content;
+#if defined(PICOKPDF_PREDECODE)
+    picoos_int32 *decoded;    /* numframes x ceporder x PICOKPDF_DEC_ELEMS values, or NULL */
+#endif
 } picokpdf_pdfmul_t;
 
 /* subobj specific for pdf phs type */
@@ -129,6 +148,9 @@ typedef struct picokpdf_pdfphs {
     picoos_uint16 numvectors;
     picoos_uint8 *indexBase;
     picoos_uint8 *contentBase;
+#if defined(PICOKPDF_PREDECODE)
+    picoos_uint32 *decoded;   /* numvectors content offsets, or NULL */
+#endif
 } picokpdf_pdfphs_t;
 
 /* return kb pdf for usage in PU */
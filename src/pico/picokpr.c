@@ -262,7 +262,7 @@ picokpr_Preproc picokpr_getPreproc(picoknow_KnowledgeBase this)
     if (NULL == this) {
         return NULL;
     } else {
-        return (picokpr_Preproc) this->subObj;
+        return (picokpr_Preproc) picoknow_getSubObj(this);
     }
 }
 
@@ -271,6 +271,11 @@ picokpr_Preproc picokpr_getPreproc(picoknow_KnowledgeBase this)
 /* knowledge base access routines for strings in StrArr */
 /* *****************************************************************************/
 
+extern picoos_int32 picokpr_getStrArrLen(picokpr_Preproc preproc)
+{
+    return ((kpr_SubObj)preproc)->rStrArrLen;
+}
+
 extern picokpr_VarStrPtr picokpr_getVarStrPtr(picokpr_Preproc preproc, picokpr_StrArrOffset ofs)
 {
     picoos_uint8 * p = (picoos_uint8 *)&(((kpr_SubObj)preproc)->rStrArr[ofs]);
@@ -427,6 +432,11 @@ extern picokpr_OutItemArrOffset picokpr_getOutItemArgOfs(picokpr_Preproc preproc
 /* knowledge base access routines for tokens in TokArr */
 /* *****************************************************************************/
 
+extern picoos_int32 picokpr_getTokArrLen(picokpr_Preproc preproc)
+{
+    return ((kpr_SubObj)preproc)->rTokArrLen;
+}
+
 extern picokpr_TokSetNP picokpr_getTokSetNP(picokpr_Preproc preproc, picokpr_TokArrOffset ofs)
 {
     picoos_uint32 c/*, b*/;
@@ -95,6 +95,7 @@ picokpr_Preproc picokpr_getPreproc(picoknow_KnowledgeBase this);
 /* *****************************************************************************/
 
 /* knowledge base access routines for strings in StrArr */
+extern picoos_int32 picokpr_getStrArrLen(picokpr_Preproc preproc);
 extern picokpr_VarStrPtr picokpr_getVarStrPtr(picokpr_Preproc preproc, picokpr_StrArrOffset ofs);
 extern picoos_bool picokpr_isEqual (picokpr_Preproc preproc, picoos_uchar str[], picoos_int32 len__9, picokpr_StrArrOffset str2);
 extern picoos_bool picokpr_isEqualHead (picokpr_Preproc preproc, picoos_uchar str[], picoos_int32 len__10, picokpr_StrArrOffset head);
@@ -116,6 +117,7 @@ extern picokpr_OutItemArrOffset picokpr_getOutItemArgOfs(picokpr_Preproc preproc
 extern picokpr_OutItemArrOffset picokpr_getOutItemNextOfs(picokpr_Preproc preproc, picokpr_OutItemArrOffset ofs);
 
 /* knowledge base access routines for tokens in TokArr */
+extern picoos_int32 picokpr_getTokArrLen(picokpr_Preproc preproc);
 extern picokpr_TokSetNP picokpr_getTokSetNP(picokpr_Preproc preproc, picokpr_TokArrOffset ofs);
 extern picokpr_TokSetWP picokpr_getTokSetWP(picokpr_Preproc preproc, picokpr_TokArrOffset ofs);
 extern picokpr_TokArrOffset picokpr_getTokNextOfs(picokpr_Preproc preproc, picokpr_TokArrOffset ofs);
@@ -108,7 +108,7 @@ pico_status_t picoktab_specializeIdsKnowledgeBase(picoknow_KnowledgeBase this,
 
 picoktab_FixedIds picoktab_getFixedIds(picoknow_KnowledgeBase this)
 {
-    return ((NULL == this) ? NULL : ((picoktab_FixedIds) this->subObj));
+    return ((NULL == this) ? NULL : ((picoktab_FixedIds) picoknow_getSubObj(this)));
 }
 
 
@@ -189,6 +189,17 @@ static picoos_uint32 ktab_propOffset (const picoktab_Graphs this, picoos_uint32
 #define KTAB_GRAPH_PROPSET_PUNCT         ((picoos_uint8)'\x080')
 
 
+/* load-time graph cache: ASCII chars are resolved in a direct table,
+   non-ASCII chars that have a graph entry of their own (no FROM..TO range)
+   in an open addressing hash keyed by the packed UTF8 bytes. The cache is
+   read-only after loading, so it can be shared by several engines */
+#define KTAB_GRAPHCACHE_ASCII  128
+
+typedef struct ktab_graphcacheent {
+    picoos_uint32 key;  /* packed UTF8 bytes, 0 for an empty slot */
+    picoktab_graphprops_t props;
+} ktab_graphcacheent_t;
+
 typedef struct ktabgraphs_subobj *ktabgraphs_SubObj;
 
 typedef struct ktabgraphs_subobj {
@@ -197,9 +208,126 @@ typedef struct ktabgraphs_subobj {
 
     picoos_uint8 * offsetTable;
     picoos_uint8 * graphTable;
+
+    picoktab_graphprops_t asciiCache[KTAB_GRAPHCACHE_ASCII];
+    ktab_graphcacheent_t * hashCache; /* hashMask+1 entries, or NULL */
+    picoos_uint32 hashMask;
 } ktabgraphs_subobj_t;
 
 
+static picoos_uint32 ktab_graphSearch(const picoktab_Graphs this, picoos_uchar * utf8graph);
+static void ktab_getStrProp (const picoktab_Graphs this, picoos_uint32 graphsOffset, picoos_uint32 propOffset, picoos_uchar * str);
+
+/* packs the bytes of a zero terminated, single UTF8 char into one key;
+   returns 0 if 'utf8graph' is not exactly one char */
+static picoos_uint32 ktab_graphKey(const picoos_uchar * utf8graph)
+{
+    picoos_uint32 key = 0;
+    picoos_uint8 i, len;
+
+    len = picobase_det_utf8_length(utf8graph[0]);
+    for (i = 0; (i < len) && (utf8graph[i] != 0); i++) {
+        key = (key << 8) | utf8graph[i];
+    }
+    if ((i < len) || (utf8graph[i] != 0)) {
+        return 0;
+    }
+    return key;
+}
+
+static picoos_uint32 ktab_graphHash(picoos_uint32 key, picoos_uint32 mask)
+{
+    return (key ^ (key >> 7) ^ (key >> 16)) & mask;
+}
+
+static picoos_uint32 ktab_graphOffsetAt(ktabgraphs_subobj_t * g, picoos_uint32 m)
+{
+    if (g->sizeOffset == 1) {
+        return g->offsetTable[m];
+    } else {
+        return g->offsetTable[g->sizeOffset*m] + 256*g->offsetTable[g->sizeOffset*m + 1];
+    }
+}
+
+static void ktab_fillGraphProps(const picoktab_Graphs this, picoos_uint32 graphsOffset,
+                                picoktab_graphprops_t * props)
+{
+    props->graphsOffset = graphsOffset;
+    props->hasTokenType = props->hasTokenSubType = props->hasPunct = FALSE;
+    props->hasGraphsubs1 = props->hasGraphsubs2 = FALSE;
+    props->tokenType = PICODATA_ITEMINFO1_TOKTYPE_UNDEFINED;
+    props->tokenSubType = -1;
+    props->graphsubs1[0] = props->graphsubs2[0] = 0;
+    if (graphsOffset > 0) {
+        props->hasTokenType = picoktab_getIntPropTokenType(this, graphsOffset, &props->tokenType);
+        props->hasTokenSubType = picoktab_getIntPropTokenSubType(this, graphsOffset, &props->tokenSubType);
+        props->hasPunct = picoktab_getIntPropPunct(this, graphsOffset, &props->punctInfo1, &props->punctInfo2);
+        props->hasGraphsubs1 = picoktab_getStrPropGraphsubs1(this, graphsOffset, props->graphsubs1);
+        props->hasGraphsubs2 = picoktab_getStrPropGraphsubs2(this, graphsOffset, props->graphsubs2);
+    }
+}
+
+/* builds the graph cache; the hash part is optional and silently left
+   out if there is not enough memory */
+static void ktabGraphsInitCache(register picoknow_KnowledgeBase this,
+                                picoos_Common common)
+{
+    ktabgraphs_subobj_t * g = (ktabgraphs_subobj_t *) this->subObj;
+    picoktab_Graphs graphs = (picoktab_Graphs) this->subObj;
+    picobase_utf8char from;
+    picoos_uint32 m, n, size, graphsOffset, key, h;
+
+    g->hashCache = NULL;
+    g->hashMask = 0;
+
+    from[1] = 0;
+    g->asciiCache[0].graphsOffset = 0;
+    for (m = 1; m < KTAB_GRAPHCACHE_ASCII; m++) {
+        from[0] = (picoos_uchar) m;
+        ktab_fillGraphProps(graphs, ktab_graphSearch(graphs, from), &(g->asciiCache[m]));
+    }
+
+    /* count single non-ASCII graphs, i.e. entries without TO field */
+    n = 0;
+    for (m = 0; m < g->nrOffset; m++) {
+        graphsOffset = ktab_graphOffsetAt(g, m);
+        if (((g->graphTable[graphsOffset] & KTAB_GRAPH_PROPSET_TO) == 0)
+                && (g->graphTable[graphsOffset+1] >= KTAB_GRAPHCACHE_ASCII)) {
+            n++;
+        }
+    }
+    if (n == 0) {
+        return;
+    }
+    size = 1;
+    while (size < 2 * n) {
+        size <<= 1;
+    }
+    g->hashCache = picoos_allocate(common->mm, size * sizeof(ktab_graphcacheent_t));
+    if (NULL == g->hashCache) {
+        PICODBG_WARN(("no memory for graph hash cache"));
+        return;
+    }
+    g->hashMask = size - 1;
+    for (h = 0; h < size; h++) {
+        g->hashCache[h].key = 0;
+    }
+    for (m = 0; m < g->nrOffset; m++) {
+        graphsOffset = ktab_graphOffsetAt(g, m);
+        if (((g->graphTable[graphsOffset] & KTAB_GRAPH_PROPSET_TO) == 0)
+                && (g->graphTable[graphsOffset+1] >= KTAB_GRAPHCACHE_ASCII)) {
+            ktab_getStrProp(graphs, graphsOffset, 1, from);
+            key = ktab_graphKey(from);
+            h = ktab_graphHash(key, g->hashMask);
+            while ((g->hashCache[h].key != 0) && (g->hashCache[h].key != key)) {
+                h = (h + 1) & g->hashMask;
+            }
+            g->hashCache[h].key = key;
+            /* resolve like an uncached lookup would */
+            ktab_fillGraphProps(graphs, ktab_graphSearch(graphs, from), &(g->hashCache[h].props));
+        }
+    }
+}
 
 static pico_status_t ktabGraphsInitialize(register picoknow_KnowledgeBase this,
                                           picoos_Common common) {
@@ -216,12 +344,16 @@ static pico_status_t ktabGraphsInitialize(register picoknow_KnowledgeBase this,
     ktabgraphs->sizeOffset  = (int)(this->base[KTAB_START_GRAPHS_SIZE_OFFSET]);
     ktabgraphs->offsetTable = &(this->base[KTAB_START_GRAPHS_OFFSET_TABLE]);
     ktabgraphs->graphTable  = &(this->base[KTAB_START_GRAPHS_GRAPH_TABLE]);
+    ktabGraphsInitCache(this, common);
     return PICO_OK;
 }
 
 static pico_status_t ktabGraphsSubObjDeallocate(register picoknow_KnowledgeBase this,
                                                 picoos_MemoryManager mm) {
     if (NULL != this) {
+        if (NULL != this->subObj) {
+            picoos_deallocate(mm, (void *) &(((ktabgraphs_subobj_t *) this->subObj)->hashCache));
+        }
         picoos_deallocate(mm, (void *) &this->subObj);
     }
     return PICO_OK;
@@ -248,7 +380,7 @@ picoktab_Graphs picoktab_getGraphs(picoknow_KnowledgeBase this) {
     if (NULL == this) {
         return NULL;
     } else {
-        return (picoktab_Graphs) this->subObj;
+        return (picoktab_Graphs) picoknow_getSubObj(this);
     }
 }
 
@@ -366,7 +498,47 @@ static picoos_uint32 ktab_propOffset(const picoktab_Graphs this,
 }
 
 
+const picoktab_graphprops_t * picoktab_getGraphProps(const picoktab_Graphs this,
+                                                     const picoos_uchar * utf8graph)
+{
+    ktabgraphs_subobj_t * g = (ktabgraphs_SubObj)this;
+    picoos_uint32 key, h;
+
+    if (utf8graph[0] < KTAB_GRAPHCACHE_ASCII) {
+        if ((utf8graph[0] > 0) && (utf8graph[1] == 0)) {
+            return &(g->asciiCache[utf8graph[0]]);
+        }
+        return NULL;
+    }
+    key = ktab_graphKey(utf8graph);
+    if ((NULL != g->hashCache) && (key != 0)) {
+        h = ktab_graphHash(key, g->hashMask);
+        while (g->hashCache[h].key != 0) {
+            if (g->hashCache[h].key == key) {
+                return &(g->hashCache[h].props);
+            }
+            h = (h + 1) & g->hashMask;
+        }
+    }
+    return NULL;
+}
+
+
 picoos_uint32 picoktab_graphOffset (const picoktab_Graphs this, picoos_uchar * utf8graph)
+{
+    const picoktab_graphprops_t * props;
+
+    props = picoktab_getGraphProps(this, utf8graph);
+    if (NULL != props) {
+        return props->graphsOffset;
+    }
+    return ktab_graphSearch(this, utf8graph);
+}
+
+
+/* binary search in the graph table, used to build the graph cache and for
+   graphs not in the cache */
+static picoos_uint32 ktab_graphSearch (const picoktab_Graphs this, picoos_uchar * utf8graph)
 {  ktabgraphs_subobj_t * g = (ktabgraphs_SubObj)this;
    picoos_int32 a, b, m;
    picoos_uint32 graphsOffset;
@@ -735,7 +907,7 @@ picoktab_Phones picoktab_getPhones(picoknow_KnowledgeBase this) {
     if (NULL == this) {
         return NULL;
     } else {
-        return (picoktab_Phones) this->subObj;
+        return (picoktab_Phones) picoknow_getSubObj(this);
     }
 }
 
@@ -955,7 +1127,7 @@ picoktab_Pos picoktab_getPos(picoknow_KnowledgeBase this) {
     if (NULL == this) {
         return NULL;
     } else {
-        return (picoktab_Pos) this->subObj;
+        return (picoktab_Pos) picoknow_getSubObj(this);
     }
 }
 
@@ -37,6 +37,7 @@
 
 #include "picoos.h"
 #include "picoknow.h"
+#include "picobase.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -73,6 +74,22 @@ picoktab_FixedIds picoktab_getFixedIds(picoknow_KnowledgeBase this);
 
 typedef struct picoktab_graphs *picoktab_Graphs;
 
+/* properties of a graph as decoded into the load-time graph cache */
+typedef struct picoktab_graphprops {
+    picoos_uint32 graphsOffset;  /* as picoktab_graphOffset, 0 if not in table */
+    picoos_bool hasTokenType;
+    picoos_bool hasTokenSubType;
+    picoos_bool hasPunct;
+    picoos_bool hasGraphsubs1;
+    picoos_bool hasGraphsubs2;
+    picoos_uint8 tokenType;
+    picoos_int8 tokenSubType;
+    picoos_uint8 punctInfo1;
+    picoos_uint8 punctInfo2;
+    picobase_utf8char graphsubs1;
+    picobase_utf8char graphsubs2;
+} picoktab_graphprops_t;
+
 /* to be used by picorsrc only */
 pico_status_t picoktab_specializeGraphsKnowledgeBase(picoknow_KnowledgeBase this,
                                                      picoos_Common common);
@@ -86,6 +103,14 @@ picoktab_Graphs picoktab_getGraphs(picoknow_KnowledgeBase this);
 picoos_uint32 picoktab_graphOffset(const picoktab_Graphs this,
                                    picoos_uchar * utf8graph);
 
+/* cached graph access routine: returns the decoded properties of UTF8
+   char 'utf8graph' if it was resolved when the kb was loaded (all ASCII
+   chars and all non-ASCII chars with a graph entry of their own), NULL
+   otherwise; then picoktab_graphOffset and the property access routines
+   below have to be used */
+const picoktab_graphprops_t * picoktab_getGraphProps(const picoktab_Graphs this,
+                                                     const picoos_uchar * utf8graph);
+
 
 /* check if UTF8 char 'graph' has property vowellike, return non-zero
    if 'ch' has the property, 0 otherwise */
@@ -554,6 +554,9 @@ void * picoos_allocate(picoos_MemoryManager this,
 
     c->size = -(c->size);
     adr = (void *)((picoos_objsize_t)c + this->usedCellHdrSize);
+#if defined(PICOOS_CLEAR_ALLOC)
+    picoos_mem_set(adr, 0, byteSize);
+#endif
     return adr;
 }
 
@@ -719,7 +722,7 @@ static void picoos_vSetErrorMsg(picoos_char * dst, picoos_objsize_t siz,
 
                 /* knowledge bases */
             case PICO_EXC_KB_MISSING:
-                fmt = PICOOS_MSG_EXC_KB_MISSING;
+                base = PICOOS_MSG_EXC_KB_MISSING;
                 break;
 
                 /* runtime exceptions (programming problems, usually a bug. E.g. trying to access null pointer) */
@@ -1739,7 +1742,7 @@ extern picoos_bool picoos_sdfOpenOut(picoos_Common g, picoos_SDFile * sdFile,
         picoos_emRaiseWarning(g->em, PICO_EXC_UNEXPECTED_FILE_TYPE, NULL,
                 (picoos_char *) "encoding not supported");
     }
-    if (SAMPLE_FREQ_16KHZ != sdf->sf) {
+    if ((SAMPLE_FREQ_16KHZ != sdf->sf) && (SAMPLE_FREQ_8KHZ != sdf->sf)) {
         done = FALSE;
         picoos_emRaiseWarning(g->em, PICO_EXC_UNEXPECTED_FILE_TYPE, NULL,
                 (picoos_char *) "sample frequency not supported");
@@ -2301,6 +2304,25 @@ extern void picoos_get_timer(picopal_uint32 * sec, picopal_uint32 * usec)
     picopal_get_timer(sec, usec);
 }
 
+/* *****************************************************************/
+/* parallel jobs                                                   */
+/* *****************************************************************/
+
+picopal_JobPool picoos_jobpool_new(picoos_uint8 numWorkers)
+{
+    return picopal_jobpool_new(numWorkers);
+}
+
+void picoos_jobpool_run(picopal_JobPool pool, picopal_job_fn job, void * ctx, picoos_uint16 numJobs)
+{
+    picopal_jobpool_run(pool, job, ctx, numJobs);
+}
+
+void picoos_jobpool_dispose(picopal_JobPool * pool)
+{
+    picopal_jobpool_dispose(pool);
+}
+
 #ifdef __cplusplus
 }
 #endif
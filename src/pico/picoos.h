@@ -161,6 +161,10 @@ picoos_MemoryManager picoos_newMemoryManager(
 void picoos_disposeMemoryManager(picoos_MemoryManager * mm);
 
 
+/* with PICOOS_CLEAR_ALLOC defined, picoos_allocate clears the memory it
+   returns; the contents of a memory block then only depend on what was
+   allocated and written, and not on what was there before (as needed to
+   compare the memory of two engines, e.g. for a snapshot) */
 void * picoos_allocate(picoos_MemoryManager this, picoos_objsize_t byteSize);
 void picoos_deallocate(picoos_MemoryManager this, void * * adr);
 
@@ -358,6 +362,7 @@ picoos_bool  picoos_Rename(picoos_char oldName[], picoos_char newName[]);
 /* *****************************************************************/
 
 #define SAMPLE_FREQ_16KHZ (picoos_uint32) 16000
+#define SAMPLE_FREQ_8KHZ (picoos_uint32) 8000
 
 typedef enum {
     FILE_TYPE_WAV,
@@ -542,6 +547,16 @@ pico_status_t picoos_write_mem_pi_uint16 (picoos_uint8 * data, picoos_uint32 * p
 
 void picoos_get_timer(picopal_uint32 * sec, picopal_uint32 * usec);
 
+/* *****************************************************************/
+/* parallel jobs           */
+/* *****************************************************************/
+
+/* workers running sets of jobs, see picopal_jobpool_new */
+picopal_JobPool picoos_jobpool_new(picoos_uint8 numWorkers);
+/* runs job(ctx, j, worker) for j = 0..numJobs-1 on the workers of pool, see picopal_jobpool_run */
+void picoos_jobpool_run(picopal_JobPool pool, picopal_job_fn job, void * ctx, picoos_uint16 numJobs);
+void picoos_jobpool_dispose(picopal_JobPool * pool);
+
 #ifdef __cplusplus
 }
 #endif
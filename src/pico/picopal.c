@@ -547,6 +547,190 @@ void picopal_get_timer(picopal_uint32 * sec, picopal_uint32 * usec)
 #endif /* IMPLEMENT_TIMER */
 }
 
+/* *************************************************/
+/* parallel jobs                                   */
+/* *************************************************/
+
+#if defined(PICOPAL_THREADS)
+
+#include <pthread.h>
+
+#define PICOPAL_MAX_WORKERS 8
+
+typedef struct picopal_jobpool_helper {
+    picopal_JobPool pool;
+    picopal_uint8 worker;
+} picopal_jobpool_helper_t;
+
+typedef struct picopal_jobpool {
+    pthread_mutex_t lock;
+    pthread_cond_t start;       /* a set of jobs is posted, or the pool disposed */
+    pthread_cond_t done;        /* the last helper is done with the set */
+    picopal_job_fn job;
+    void * ctx;
+    picopal_uint32 numJobs;
+    picopal_uint32 nextJob;     /* next unclaimed job, claimed by atomic increment */
+    picopal_uint32 generation;  /* number of sets posted */
+    picopal_uint8 busy;         /* helpers still working on the current set */
+    picopal_uint8 quit;
+    picopal_uint8 numWorkers;   /* the caller and the helpers started */
+    pthread_t thread[PICOPAL_MAX_WORKERS];
+    picopal_jobpool_helper_t helper[PICOPAL_MAX_WORKERS];
+} picopal_jobpool_t;
+
+/* runs jobs of the current set until all are claimed */
+static void picopal_jobpool_work(picopal_JobPool pool, picopal_uint8 worker)
+{
+    picopal_uint32 j;
+
+    while ((j = __atomic_fetch_add(&pool->nextJob, 1, __ATOMIC_RELAXED))
+            < pool->numJobs) {
+        pool->job(pool->ctx, (picopal_uint16) j, worker);
+    }
+}
+
+static void * picopal_jobpool_helper_run(void * arg)
+{
+    picopal_jobpool_helper_t * h = (picopal_jobpool_helper_t *) arg;
+    picopal_JobPool pool = h->pool;
+    picopal_uint32 seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        while (!pool->quit && (pool->generation == seen)) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->quit) {
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+        picopal_jobpool_work(pool, h->worker);
+        pthread_mutex_lock(&pool->lock);
+        if (0 == --pool->busy) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+picopal_JobPool picopal_jobpool_new(picopal_uint8 numWorkers)
+{
+    picopal_JobPool pool;
+    picopal_uint8 i;
+
+    if (numWorkers > PICOPAL_MAX_WORKERS) {
+        numWorkers = PICOPAL_MAX_WORKERS;
+    }
+    if (numWorkers <= 1) {
+        return NULL;
+    }
+    pool = (picopal_JobPool) malloc(sizeof(picopal_jobpool_t));
+    if (NULL == pool) {
+        return NULL;
+    }
+    pool->generation = 0;
+    pool->busy = 0;
+    pool->quit = 0;
+    pool->numWorkers = 1;
+    if (0 != pthread_mutex_init(&pool->lock, NULL)) {
+        free(pool);
+        return NULL;
+    }
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    /* the caller of picopal_jobpool_run is worker 0 */
+    for (i = 1; i < numWorkers; i++) {
+        pool->helper[i].pool = pool;
+        pool->helper[i].worker = i;
+        if (0 != pthread_create(&pool->thread[i], NULL,
+                picopal_jobpool_helper_run, &pool->helper[i])) {
+            break;
+        }
+        pool->numWorkers++;
+    }
+    if (pool->numWorkers <= 1) {
+        picopal_jobpool_dispose(&pool);
+    }
+    return pool;
+}
+
+void picopal_jobpool_run(picopal_JobPool pool, picopal_job_fn job, void * ctx, picopal_uint16 numJobs)
+{
+    picopal_uint16 j;
+
+    if (NULL == pool) {
+        for (j = 0; j < numJobs; j++) {
+            job(ctx, j, 0);
+        }
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->job = job;
+    pool->ctx = ctx;
+    pool->numJobs = numJobs;
+    pool->nextJob = 0;
+    pool->busy = pool->numWorkers - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    picopal_jobpool_work(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void picopal_jobpool_dispose(picopal_JobPool * pool)
+{
+    picopal_uint8 i;
+
+    if (NULL == *pool) {
+        return;
+    }
+    pthread_mutex_lock(&(*pool)->lock);
+    (*pool)->quit = 1;
+    pthread_cond_broadcast(&(*pool)->start);
+    pthread_mutex_unlock(&(*pool)->lock);
+    for (i = 1; i < (*pool)->numWorkers; i++) {
+        pthread_join((*pool)->thread[i], NULL);
+    }
+    pthread_cond_destroy(&(*pool)->start);
+    pthread_cond_destroy(&(*pool)->done);
+    pthread_mutex_destroy(&(*pool)->lock);
+    free(*pool);
+    *pool = NULL;
+}
+
+#else
+
+picopal_JobPool picopal_jobpool_new(picopal_uint8 numWorkers)
+{
+    numWorkers = numWorkers; /* avoid warning "var not used in this function"*/
+    return NULL;
+}
+
+void picopal_jobpool_run(picopal_JobPool pool, picopal_job_fn job, void * ctx, picopal_uint16 numJobs)
+{
+    picopal_uint16 j;
+
+    pool = pool; /* avoid warning "var not used in this function"*/
+    for (j = 0; j < numJobs; j++) {
+        job(ctx, j, 0);
+    }
+}
+
+void picopal_jobpool_dispose(picopal_JobPool * pool)
+{
+    *pool = NULL;
+}
+
+#endif /* PICOPAL_THREADS */
+
 #ifdef __cplusplus
 }
 #endif
@@ -281,6 +281,38 @@ picopal_double picopal_quick_exp(const picopal_double y);
 
 extern void picopal_get_timer(picopal_uint32 * sec, picopal_uint32 * usec);
 
+/* *************************************************/
+/* parallel jobs                                   */
+/* *************************************************/
+
+/* a job of a set run by picopal_jobpool_run; worker is the index (0..numWorkers-1)
+   of the worker running it, e.g. to select per-worker scratch memory */
+typedef void (* picopal_job_fn)(void * ctx, picopal_uint16 job, picopal_uint8 worker);
+
+/* workers kept from picopal_jobpool_new to picopal_jobpool_dispose */
+typedef struct picopal_jobpool * picopal_JobPool;
+
+/**
+ * Creates a pool of up to numWorkers workers: the thread calling
+ * picopal_jobpool_run is worker 0, the others are threads started here that
+ * wait for jobs until the pool is disposed. Returns NULL, for which
+ * picopal_jobpool_run runs all jobs in the calling thread as worker 0, if
+ * numWorkers is 1 or less, if no thread can be started or if PICOPAL_THREADS
+ * is not defined.
+ */
+extern picopal_JobPool picopal_jobpool_new(picopal_uint8 numWorkers);
+
+/**
+ * Runs job(ctx, j, worker) for all j in 0..numJobs-1 on the workers of pool
+ * and returns when all are done. Each worker claims the next unclaimed job
+ * with an atomic increment when it is idle, so that jobs of uneven size are
+ * balanced.
+ */
+extern void picopal_jobpool_run(picopal_JobPool pool, picopal_job_fn job, void * ctx, picopal_uint16 numJobs);
+
+/* stops and joins the threads of the pool and sets it to NULL */
+extern void picopal_jobpool_dispose(picopal_JobPool * pool);
+
 #ifdef __cplusplus
 }
 #endif
@@ -432,6 +432,10 @@ static pico_status_t pam_expand_vector(register picodata_ProcessingUnit this);
 static picoos_uint8 pam_do_tree(register picodata_ProcessingUnit this,
         const picokdt_DtPAM dtpam, const picoos_uint8 *invec,
         const picoos_uint8 inveclen, picokdt_classify_result_t *dtres);
+static void pam_do_trees(register picodata_ProcessingUnit this,
+        const picokdt_DtPAM *dtpams, const picoos_uint8 nrtrees,
+        const picoos_uint8 *invec, const picoos_uint8 inveclen,
+        picoos_uint16 *classes);
 static pico_status_t pam_get_f0(register picodata_ProcessingUnit this,
         picoos_uint16 *lf0Index, picoos_uint8 nState, picoos_single *phonF0);
 static pico_status_t pam_get_duration(register picodata_ProcessingUnit this,
@@ -1397,21 +1401,32 @@ static pico_status_t pam_get_duration(register picodata_ProcessingUnit this,
         PICODBG_ERROR(("PAM durPdf access error, index overflow -> index: %d , numframes: %d", durIndex, pdf->numframes));
         return PICO_ERR_OTHER;
     }
-    /* base pointer */
-    durItem = &(pdf->content[durIndex * pdf->vecsize]);
-    if (durItem == NULL) {
-        PICODBG_ERROR(("PAM durPdf access error , frame pointer = NULL"));
-        return PICO_ERR_OTHER;
-    }
     nFrameSize = pdf->sampperframe / 16;
-    *phonDur = ((pdf->phonquant[((*durItem) & 0xF0) >> 4]) * nFrameSize);
-    numFramesState[0] = pdf->statequant[((*durItem) & 0x0F)];
-    durItem++;
-    numFramesState[1] = pdf->statequant[((*durItem) & 0xF0) >> 4];
-    numFramesState[2] = pdf->statequant[((*durItem) & 0x0F)];
-    durItem++;
-    numFramesState[3] = pdf->statequant[((*durItem) & 0xF0) >> 4];
-    numFramesState[4] = pdf->statequant[((*durItem) & 0x0F)];
+#if defined(PICOKPDF_PREDECODE)
+    if (pdf->decoded != NULL) {
+        durItem = &(pdf->decoded[durIndex * PICOKPDF_DUR_DEC_ELEMS]);
+        *phonDur = durItem[0] * nFrameSize;
+        for (nI = 0; nI < 5; nI++) {
+            numFramesState[nI] = durItem[nI + 1];
+        }
+    } else
+#endif
+    {
+        /* base pointer */
+        durItem = &(pdf->content[durIndex * pdf->vecsize]);
+        if (durItem == NULL) {
+            PICODBG_ERROR(("PAM durPdf access error , frame pointer = NULL"));
+            return PICO_ERR_OTHER;
+        }
+        *phonDur = ((pdf->phonquant[((*durItem) & 0xF0) >> 4]) * nFrameSize);
+        numFramesState[0] = pdf->statequant[((*durItem) & 0x0F)];
+        durItem++;
+        numFramesState[1] = pdf->statequant[((*durItem) & 0xF0) >> 4];
+        numFramesState[2] = pdf->statequant[((*durItem) & 0x0F)];
+        durItem++;
+        numFramesState[3] = pdf->statequant[((*durItem) & 0xF0) >> 4];
+        numFramesState[4] = pdf->statequant[((*durItem) & 0x0F)];
+    }
 
     /*modification of the duration information based on the duration modifier*/
     *phonDur = (picoos_uint16) (((picoos_single) * phonDur) * pam->dMod);
@@ -2211,14 +2226,8 @@ static pico_status_t pamPhoneProcess(register picodata_ProcessingUnit this)
             &(pam->numFramesState[0]));
 
     /*tree traversal for pitch*/
-    for (nI = 0; nI < PICOPAM_MAX_STATES_PER_PHONE; nI++) {
-        if (!pam_do_tree(this, pam->dtlfz[nI], &(pam->sPhFeats[0]),
-                PICOPAM_INVEC_SIZE, &dTreeResult)) {
-            PICODBG_WARN(("problem using pam tree lf0Tree, using fallback value"));
-            dTreeResult.class = 0;
-        }
-        pam->lf0Index[nI] = dTreeResult.class;
-    }
+    pam_do_trees(this, pam->dtlfz, PICOPAM_MAX_STATES_PER_PHONE,
+            &(pam->sPhFeats[0]), PICOPAM_INVEC_SIZE, &(pam->lf0Index[0]));
 
     /*pdf access for pitch*/
     for (nI = 0; nI < PICOPAM_MAX_STATES_PER_PHONE; nI++) {
@@ -2228,15 +2237,8 @@ static pico_status_t pamPhoneProcess(register picodata_ProcessingUnit this)
     /*update vector with duration and pitch for cep tree traversal*/
     sResult = pam_update_vector(this);
     /*cep tree traversal*/
-    for (nI = 0; nI < PICOPAM_MAX_STATES_PER_PHONE; nI++) {
-
-        if (!pam_do_tree(this, pam->dtmgc[nI], &(pam->sPhFeats[0]),
-                PICOPAM_INVEC_SIZE, &dTreeResult)) {
-            PICODBG_WARN(("problem using pam tree lf0Tree, using fallback value"));
-            dTreeResult.class = 0;
-        }
-        pam->mgcIndex[nI] = dTreeResult.class;
-    }
+    pam_do_trees(this, pam->dtmgc, PICOPAM_MAX_STATES_PER_PHONE,
+            &(pam->sPhFeats[0]), PICOPAM_INVEC_SIZE, &(pam->mgcIndex[0]));
     /*put item to output buffer*/
     sResult = pam_put_item(this, pam->outBuf, pam->outWritePos, &bWr);
     if (sResult == PICO_OK)
@@ -2812,6 +2814,68 @@ static picoos_uint8 pam_do_tree(register picodata_ProcessingUnit this,
     return dtres->set;
 }/*pam_do_tree*/
 
+/**
+ * performs the traversal of several PamTrees sharing one input vector
+ * (e.g. the trees of all states of a phone), interleaving the trees
+ * @param    this : Pam item subobject pointer
+ * @param    *dtpams : the Pam decision trees
+ * @param    nrtrees : number of trees (<= PICOPAM_MAX_STATES_PER_PHONE)
+ * @param    *invec : the input vector pointer
+ * @param    inveclen : length of the input vector
+ * @param    *classes : receives the output class of each tree, 0 as
+ *           fallback value if the tree traversal fails
+ * @callgraph
+ * @callergraph
+ */
+static void pam_do_trees(register picodata_ProcessingUnit this,
+        const picokdt_DtPAM *dtpams, const picoos_uint8 nrtrees,
+        const picoos_uint8 *invec, const picoos_uint8 inveclen,
+        picoos_uint16 *classes)
+{
+    picoos_uint8 okay[PICOPAM_MAX_STATES_PER_PHONE];
+    picoos_uint8 classified[PICOPAM_MAX_STATES_PER_PHONE];
+    picokdt_classify_result_t dtres;
+    picoos_uint8 nI;
+
+    /* construct input vectors, which are set in dtpams */
+    for (nI = 0; nI < nrtrees; nI++) {
+        okay[nI] = TRUE;
+        if (!picokdt_dtPAMconstructInVec(dtpams[nI], invec, inveclen)) {
+            /* error constructing invec */
+            PICODBG_WARN(("problem with invec"));
+            picoos_emRaiseWarning(this->common->em, PICO_WARN_INVECTOR, NULL,
+                    NULL);
+            okay[nI] = FALSE;
+        }
+    }
+    /* classify */
+    picokdt_dtPAMclassifyBatch(dtpams, nrtrees, classified);
+    for (nI = 0; nI < nrtrees; nI++) {
+        if (okay[nI] && !classified[nI]) {
+            /* error doing classification */
+            PICODBG_WARN(("problem classifying"));
+            picoos_emRaiseWarning(this->common->em, PICO_WARN_CLASSIFICATION,
+                    NULL, NULL);
+            okay[nI] = FALSE;
+        }
+        /* decompose */
+        if (okay[nI] && (!picokdt_dtPAMdecomposeOutClass(dtpams[nI], &dtres))) {
+            /* error decomposing */
+            PICODBG_WARN(("problem decomposing"));
+            picoos_emRaiseWarning(this->common->em, PICO_WARN_OUTVECTOR, NULL,
+                    NULL);
+            okay[nI] = FALSE;
+        }
+        if (okay[nI] && dtres.set) {
+            PICODBG_TRACE(("dtpam output class: %d", dtres.class));
+            classes[nI] = dtres.class;
+        } else {
+            PICODBG_WARN(("problem using pam tree, using fallback value"));
+            classes[nI] = 0;
+        }
+    }
+}/*pam_do_trees*/
+
 /**
  * returns the carrier vowel id inside a syllable
  * @param    this : Pam item subobject pointer
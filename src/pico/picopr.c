@@ -119,6 +119,16 @@ extern "C" {
 
 #define PR_FIRST_TSE_WP PR_TSEOut
 
+#if defined(PICOPR_COMPILE)
+/* first token type masks (see pr_compileFirstTypes): one bit per token type
+   as in pr_TokSetEleNP (PR_TSEBegin..PR_TSESeq), plus a bit for tokens from
+   which the production can be accepted without consuming a token */
+#define PR_FT_TYPES    (PR_TSE_MASK_BEGIN | PR_TSE_MASK_END | PR_TSE_MASK_SPACE | PR_TSE_MASK_DIGIT | \
+                        PR_TSE_MASK_LETTER | PR_TSE_MASK_CHAR | PR_TSE_MASK_SEQ)
+#define PR_FT_NULLABLE 0x80
+#define PR_FT_ALL      0xFF
+#endif
+
 #define PR_SMALLER 1
 #define PR_EQUAL   0
 #define PR_LARGER  2
@@ -293,6 +303,11 @@ typedef struct pr_subobj
     picoos_uint16 outWritePos; /* next pos to write to outBuf */
 
     picokpr_Preproc preproc[PR_MAX_NR_PREPROC];
+#if defined(PICOPR_COMPILE)
+    picoos_uint8 * firstTypes[PR_MAX_NR_PREPROC]; /* first token types per token, NULL if not available */
+    picoos_uint8 * strLC[PR_MAX_NR_PREPROC]; /* lower-cased string arrays, NULL if not available */
+    picoos_bool compiled; /* pr_compileNetworks done */
+#endif
     pr_ContextList ctxList;
     pr_ProdList prodList;
 
@@ -808,6 +823,57 @@ static picoos_bool pr_isSUC (picoos_uchar str[])
     return lis;
 }
 
+
+/* punctuation item info of the single UTF8 char 'utf8graph'; taken from the
+   graph cache if the char was resolved when the graphs kb was loaded */
+static picoos_bool pr_getGraphPunct (pr_subobj_t * pr, picoos_uchar * utf8graph, picoos_uint8 * info1, picoos_uint8 * info2)
+{
+    const picoktab_graphprops_t * props;
+    picoos_int32 id;
+
+    props = picoktab_getGraphProps(pr->graphs, utf8graph);
+    if (NULL != props) {
+        if (props->hasPunct) {
+            *info1 = props->punctInfo1;
+            *info2 = props->punctInfo2;
+        }
+        return props->hasPunct;
+    }
+    id = picoktab_graphOffset(pr->graphs, utf8graph);
+    return (id > 0) && picoktab_getIntPropPunct(pr->graphs, id, info1, info2);
+}
+
+
+/* graph substitution of the single UTF8 char 'utf8graph': returns TRUE if
+   it has one, with the first substitute char in 'subs1' and the second one,
+   if any, in 'subs2' (empty otherwise); cached like pr_getGraphPunct */
+static picoos_bool pr_getGraphSubs (pr_subobj_t * pr, picoos_uchar * utf8graph, picoos_uchar * subs1, picoos_uchar * subs2)
+{
+    const picoktab_graphprops_t * props;
+    picoos_int32 id;
+
+    subs2[0] = 0;
+    props = picoktab_getGraphProps(pr->graphs, utf8graph);
+    if (NULL != props) {
+        if (!props->hasGraphsubs1) {
+            return FALSE;
+        }
+        picoos_strlcpy(subs1, props->graphsubs1, PICOBASE_UTF8_MAXLEN+1);
+        if (props->hasGraphsubs2) {
+            picoos_strlcpy(subs2, props->graphsubs2, PICOBASE_UTF8_MAXLEN+1);
+        }
+        return TRUE;
+    }
+    id = picoktab_graphOffset(pr->graphs, utf8graph);
+    if ((id <= 0) || !picoktab_getStrPropGraphsubs1(pr->graphs, id, subs1)) {
+        return FALSE;
+    }
+    if (!picoktab_getStrPropGraphsubs2(pr->graphs, id, subs2)) {
+        subs2[0] = 0;
+    }
+    return TRUE;
+}
+
 /* *****************************************************************************/
 
 static picoos_bool pr_isCmdType (pr_ioItemPtr it, picoos_uint8 type)
@@ -1300,6 +1366,22 @@ static pr_OutItemVarPtr pr_findVariable (pr_OutItemVarPtr vars, picoos_int32 id)
 }
 
 
+/* gets the FSTs mapping phonemes when first needed, so that with
+   PICOKNOW_LAZY_INIT they are only specialized if there are phonemes */
+static void pr_getPhonemeFSTs (picodata_ProcessingUnit this, pr_subobj_t * pr)
+{
+    if (NULL == pr->xsampa_parser) {
+        pr->xsampa_parser = picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_XSAMPA_PARSE]);
+    }
+    if (NULL == pr->svoxpa_parser) {
+        pr->svoxpa_parser = picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_SVOXPA_PARSE]);
+    }
+    if (NULL == pr->xsampa2svoxpa_mapper) {
+        pr->xsampa2svoxpa_mapper = picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_XSAMPA2SVOXPA]);
+    }
+}
+
+
 static void pr_genCommands (picodata_ProcessingUnit this, pr_subobj_t * pr,
                             picokpr_Preproc network, picokpr_OutItemArrOffset outitem, pr_OutItemVarPtr vars, pr_ioItemPtr * first, pr_ioItemPtr * last)
 {
@@ -1397,6 +1479,7 @@ static void pr_genCommands (picodata_ProcessingUnit this, pr_subobj_t * pr,
                 if (lf != NULL) {
                     ldone = FALSE;
                     if (lf->head.type == PICODATA_ITEM_TOKEN) {
+                        pr_getPhonemeFSTs(this, pr);
                         if (picodata_mapPAStrToPAIds(pr->transducer, this->common, pr->xsampa_parser, pr->svoxpa_parser, pr->xsampa2svoxpa_mapper, lf->data, alphabet, pr->tmpStr1, sizeof(pr->tmpStr1)-1) == PICO_OK) {
                             pr_putItem(this, pr, & (*first),& (*last), PICODATA_ITEM_CMD, PICODATA_ITEMINFO1_CMD_PHONEME,
                                 PICODATA_ITEMINFO2_CMD_START, 0, pr->tmpStr1);
@@ -1972,14 +2055,14 @@ static picoos_int32 pr_attrVal (picokpr_Preproc network, picokpr_TokArrOffset to
     picoos_int32 n;
     picokpr_TokSetWP set;
 
+    /* the attributes are stored in the order of the set elements;
+       count the elements of the set before 'type' */
     n = 0;
     tse = PR_FIRST_TSE_WP;
-    set = picokpr_getTokSetWP(network, tok);
-    while (tse < type) {
-        if (((1<<tse) & set) != 0) {
-            n++;
-        }
-        tse = (pr_TokSetEleWP)((picoos_int32)tse+1);
+    set = picokpr_getTokSetWP(network, tok) & (((picokpr_TokSetWP)1 << type) - ((picokpr_TokSetWP)1 << tse));
+    while (set != 0) {
+        set &= set - 1;
+        n++;
     }
     return picokpr_getAttrValArrInt32(network, picokpr_getTokAttribOfs(network, tok) + n);
 }
@@ -2251,6 +2334,61 @@ static void pr_compare (picoos_uchar str1lc[], picoos_uchar str2[], picoos_int16
 }
 
 
+#if defined(PICOPR_COMPILE)
+
+/* like pr_compare, with 'str2lc' already lower-cased */
+static void pr_compareLC (picoos_uchar str1lc[], picoos_uchar str2lc[], picoos_int16 * result)
+{
+    picoos_int32 i;
+
+    i = 0;
+    while ((i < PR_MAX_DATA_LEN) && (str1lc[i] != 0) && (str1lc[i] == str2lc[i])) {
+        i++;
+    }
+    if ((i >= PR_MAX_DATA_LEN) || (str1lc[i] == 0)) {
+        *result = (str2lc[i] == 0) ? PR_EQUAL : PR_SMALLER;
+    } else if (str2lc[i] == 0) {
+        *result = PR_LARGER;
+    } else if (str1lc[i] < str2lc[i]) {
+        *result = PR_SMALLER;
+    } else {
+        *result = PR_LARGER;
+    }
+}
+
+
+/* returns the first token type mask bit of an item token type */
+static picoos_uint8 pr_firstTypeBit (picoos_uint8 toktype)
+{
+    switch (toktype) {
+        case PICODATA_ITEMINFO1_TOKTYPE_BEGIN:  return PR_TSE_MASK_BEGIN;
+        case PICODATA_ITEMINFO1_TOKTYPE_END:    return PR_TSE_MASK_END;
+        case PICODATA_ITEMINFO1_TOKTYPE_SPACE:  return PR_TSE_MASK_SPACE;
+        case PICODATA_ITEMINFO1_TOKTYPE_DIGIT:  return PR_TSE_MASK_DIGIT;
+        case PICODATA_ITEMINFO1_TOKTYPE_LETTER: return PR_TSE_MASK_LETTER;
+        case PICODATA_ITEMINFO1_TOKTYPE_CHAR:   return PR_TSE_MASK_CHAR;
+        case PICODATA_ITEMINFO1_TOKTYPE_SEQ:    return PR_TSE_MASK_SEQ;
+        default:                                return 0;
+    }
+}
+
+
+/* returns the lower-cased string at 'ofs' of 'network', NULL if not available */
+static picoos_uchar * pr_getStrLC (pr_subobj_t * pr, picokpr_Preproc network, picoos_int32 ofs)
+{
+    picoos_int32 p;
+
+    for (p=0; p<PR_MAX_NR_PREPROC; p++) {
+        if (pr->preproc[p] == network) {
+            return (NULL != pr->strLC[p]) ? &(pr->strLC[p][ofs]) : NULL;
+        }
+    }
+    return NULL;
+}
+
+#endif
+
+
 static picoos_bool pr_hasToken (picokpr_TokSetWP * tswp, picokpr_TokSetNP * tsnp)
 {
     return ((((  PR_TSE_MASK_SPACE | PR_TSE_MASK_DIGIT | PR_TSE_MASK_LETTER | PR_TSE_MASK_SEQ
@@ -2477,6 +2615,43 @@ static picoos_bool pr_getToken (picodata_ProcessingUnit this, pr_subobj_t * pr)
 }
 
 
+#if defined(PICOPR_COMPILE)
+
+/* returns FALSE if no path from the last path element can match the next
+   token, i.e. the element and its alternatives can be dropped right away */
+static picoos_bool pr_mayMatch (pr_subobj_t * pr)
+{
+    register struct pr_PathEle * with__0;
+    picoos_int32 ln;
+    picoos_int32 lid;
+    picoos_int32 p;
+
+    with__0 = & pr->ractpath.rele[pr->ractpath.rlen - 1];
+    p = 0;
+    while ((p < PR_MAX_NR_PREPROC) && (pr->preproc[p] != with__0->rnetwork)) {
+        p++;
+    }
+    if ((p >= PR_MAX_NR_PREPROC) || (NULL == pr->firstTypes[p])) {
+        return TRUE;
+    }
+    ln = (pr->ractpath.rlen - 2);
+    while ((ln >= 0) && (pr->ractpath.rele[ln].ritemid ==  -1)) {
+        ln = ln - 1;
+    }
+    if (ln >= 0) {
+        lid = pr->ractpath.rele[ln].ritemid + 1;
+    } else {
+        lid = 0;
+    }
+    if (lid >= pr->rnritems) {
+        return TRUE;
+    }
+    return ((pr->firstTypes[p][with__0->rtok] & (PR_FT_NULLABLE | pr_firstTypeBit(pr->ritems[lid+1]->head.info1))) != 0);
+}
+
+#endif
+
+
 static picoos_bool pr_getNextMultiToken (picodata_ProcessingUnit this, pr_subobj_t * pr)
 {
     picoos_int32 len;
@@ -2795,6 +2970,9 @@ static pr_MatchState pr_matchTokens (picodata_ProcessingUnit this, pr_subobj_t *
     picokpr_VarStrPtr lstrp;
     picokpr_TokSetNP npset;
     picokpr_TokSetWP wpset;
+#if defined(PICOPR_COMPILE)
+    picoos_uchar * lstrlcp;
+#endif
 
     with__0 = & pr->ractpath.rele[pr->ractpath.rlen - 1];
     npset = picokpr_getTokSetNP(with__0->rnetwork, with__0->rtok);
@@ -2802,8 +2980,18 @@ static pr_MatchState pr_matchTokens (picodata_ProcessingUnit this, pr_subobj_t *
 
     *cmpres = PR_EQUAL;
     if ((PR_TSE_MASK_STR & wpset) != 0) {
+#if defined(PICOPR_COMPILE)
+        lstrlcp = pr_getStrLC(pr, with__0->rnetwork, pr_attrVal(with__0->rnetwork, with__0->rtok, PR_TSEStr));
+        if (NULL != lstrlcp) {
+            pr_compareLC(pr->ritems[with__0->ritemid+1]->strci,lstrlcp,cmpres);
+        } else {
+            lstrp = picokpr_getVarStrPtr(with__0->rnetwork, pr_attrVal(with__0->rnetwork, with__0->rtok, PR_TSEStr));
+            pr_compare(pr->ritems[with__0->ritemid+1]->strci,lstrp,cmpres);
+        }
+#else
         lstrp = picokpr_getVarStrPtr(with__0->rnetwork, pr_attrVal(with__0->rnetwork, with__0->rtok, PR_TSEStr));
         pr_compare(pr->ritems[with__0->ritemid+1]->strci,lstrp,cmpres);
+#endif
     }
     if (((PR_TSE_MASK_LEX & wpset) == PR_TSE_MASK_LEX) && ((PR_TSE_MASK_LETTER & npset) == 0)) {
         return pr_matchMultiToken(this, pr, npset, wpset);
@@ -2916,6 +3104,12 @@ void pr_processToken (picodata_ProcessingUnit this, pr_subobj_t * pr)
             with__0 = & pr->ractpath.rele[pr->ractpath.rlen - 1];
             switch (with__0->rlState) {
                 case PR_LSInit:
+#if defined(PICOPR_COMPILE)
+                    if (!pr_mayMatch(pr)) {
+                        with__0->rlState = PR_LSGoBack;
+                        break;
+                    }
+#endif
                     npset = picokpr_getTokSetNP(with__0->rnetwork, with__0->rtok);
                     wpset = picokpr_getTokSetWP(with__0->rnetwork, with__0->rtok);
                     if ((PR_TSE_MASK_ACCEPT & npset) != 0){
@@ -3163,6 +3357,217 @@ extern void pr_treatItem (picodata_ProcessingUnit this, pr_subobj_t * pr, pr_ioI
     }
 }
 
+/* *****************************************************************************/
+/* network compilation */
+
+#if defined(PICOPR_COMPILE)
+
+/* returns a copy of the string array of 'network' with every character
+   lower-cased as in pr_compare, or NULL if this would change the length
+   of any character (or memory is exhausted) */
+static picoos_uint8 * pr_compileStrings (register picodata_ProcessingUnit this, picokpr_Preproc network)
+{
+    picoos_int32 len;
+    picoos_int32 i;
+    picoos_int32 j;
+    picoos_int32 l;
+    picokpr_VarStrPtr strp;
+    picoos_uint8 * strlc;
+    picobase_utf8char utf8char;
+    picobase_utf8char utf8lc;
+    picoos_uint8 done;
+
+    len = picokpr_getStrArrLen(network);
+    if (len <= 0) {
+        return NULL;
+    }
+    strlc = picoos_allocate(this->common->mm, len);
+    if (NULL == strlc) {
+        PICODBG_WARN(("not enough memory for lower-cased strings; comparing unchanged"));
+        return NULL;
+    }
+    strp = picokpr_getVarStrPtr(network, 0);
+    i = 0;
+    while (i < len) {
+        if (strp[i] == 0) {
+            strlc[i++] = 0;
+        } else {
+            l = picobase_det_utf8_length(strp[i]);
+            j = 0;
+            while ((j < l) && ((i + j) < len) && (strp[i + j] != 0)) {
+                utf8char[j] = strp[i + j];
+                j++;
+            }
+            utf8char[j] = 0;
+            if ((l > 0) && (j == l)) {
+                picobase_lowercase_utf8_str(utf8char, (picoos_char *)utf8lc, PICOBASE_UTF8_MAXLEN+1, &done);
+            }
+            if ((l == 0) || (j < l) || (picoos_strlen((picoos_char *)utf8lc) != (picoos_uint32)l)) {
+                PICODBG_WARN(("cannot lower-case string array in place; comparing unchanged"));
+                picoos_deallocate(this->common->mm, (void *) &strlc);
+                return NULL;
+            }
+            for (j = 0; j < l; j++) {
+                strlc[i++] = utf8lc[j];
+            }
+        }
+    }
+    return strlc;
+}
+
+
+/* returns the index of 'network' in pr->preproc */
+static picoos_int32 pr_networkIndex (pr_subobj_t * pr, picokpr_Preproc network)
+{
+    picoos_int32 p;
+
+    for (p=0; p<PR_MAX_NR_PREPROC; p++) {
+        if (pr->preproc[p] == network) {
+            return p;
+        }
+    }
+    return -1;
+}
+
+
+/* returns the token types token 'tok' of network 'p' can start with, given
+   the current estimate 'masks'; follows pr_processToken */
+static picoos_uint8 pr_firstTypesOfToken (register picodata_ProcessingUnit this, pr_subobj_t * pr,
+                                          picoos_uint8 * masks[], picoos_int32 p, picokpr_TokArrOffset tok)
+{
+    picokpr_Preproc net;
+    picokpr_Preproc tnet;
+    picokpr_TokArrOffset ttok;
+    picokpr_TokSetNP npset;
+    picokpr_TokSetWP wpset;
+    picoos_uint8 next;
+    picoos_uint8 target;
+    picoos_uint8 m;
+    picoos_int32 tp;
+
+    net = pr->preproc[p];
+    npset = picokpr_getTokSetNP(net, tok);
+    wpset = picokpr_getTokSetWP(net, tok);
+    next = ((PR_TSE_MASK_NEXT & npset) != 0) ? masks[p][picokpr_getTokNextOfs(net, tok)] : 0;
+    if ((PR_TSE_MASK_ACCEPT & npset) != 0) {
+        m = PR_FT_NULLABLE | next;
+    } else if ((PR_TSE_MASK_PROD & wpset) != 0) {
+        target = 0;
+        if ((PR_TSE_MASK_PRODEXT & wpset) != 0) {
+            if (pr_findProduction(this, pr, picokpr_getVarStrPtr(net, pr_attrVal(net, tok, PR_TSEProdExt)), &tnet, &ttok)) {
+                tp = pr_networkIndex(pr, tnet);
+                target = ((tp >= 0) && (NULL != masks[tp])) ? masks[tp][ttok] : PR_FT_ALL;
+            }
+        } else {
+            target = masks[p][picokpr_getProdATokOfs(net, pr_attrVal(net, tok, PR_TSEProd))];
+        }
+        m = target & ~PR_FT_NULLABLE;
+        if ((target & PR_FT_NULLABLE) != 0) {
+            m |= next;
+        }
+    } else if ((PR_TSE_MASK_OUT & wpset) != 0) {
+        m = next;
+    } else if (pr_hasToken(&wpset, &npset)) {
+        if (((PR_TSE_MASK_LEX & wpset) == PR_TSE_MASK_LEX) && ((PR_TSE_MASK_LETTER & npset) == 0)) {
+            m = 0; /* pr_matchMultiToken never matches */
+        } else {
+            m = npset & PR_FT_TYPES;
+        }
+    } else {
+        m = next;
+    }
+    if ((PR_TSE_MASK_ALTL & npset) != 0) {
+        m |= masks[p][picokpr_getTokAltLOfs(net, tok)];
+    }
+    if ((PR_TSE_MASK_ALTR & npset) != 0) {
+        m |= masks[p][picokpr_getTokAltROfs(net, tok)];
+    }
+    return m;
+}
+
+
+static void pr_disposeCompiledNetworks (register picodata_ProcessingUnit this, pr_subobj_t * pr)
+{
+    picoos_int32 p;
+
+    for (p=PR_MAX_NR_PREPROC-1; p>=0; p--) {
+        if (NULL != pr->strLC[p]) {
+            picoos_deallocate(this->common->mm, (void *) &pr->strLC[p]);
+        }
+        if (NULL != pr->firstTypes[p]) {
+            picoos_deallocate(this->common->mm, (void *) &pr->firstTypes[p]);
+        }
+    }
+}
+
+
+/* determines for every token of every network the token types the rest of
+   its production (including alternatives) can start with, so that
+   pr_processToken drops path elements that cannot match the next token;
+   nothing is dropped if memory is exhausted */
+static void pr_compileFirstTypes (register picodata_ProcessingUnit this, pr_subobj_t * pr)
+{
+    picoos_uint8 ** masks;
+    picoos_int32 len[PR_MAX_NR_PREPROC];
+    picoos_int32 p;
+    picoos_int32 t;
+    picoos_uint8 m;
+    picoos_bool changed;
+
+    masks = pr->firstTypes;
+    for (p=0; p<PR_MAX_NR_PREPROC; p++) {
+        len[p] = 0;
+        if (pr->preproc[p] != NULL) {
+            len[p] = picokpr_getTokArrLen(pr->preproc[p]);
+            if (len[p] > 0) {
+                masks[p] = picoos_allocate(this->common->mm, len[p]);
+                if (NULL == masks[p]) {
+                    PICODBG_WARN(("not enough memory for first token types; searching all paths"));
+                    pr_disposeCompiledNetworks(this, pr);
+                    return;
+                }
+                for (t = 0; t < len[p]; t++) {
+                    masks[p][t] = 0;
+                }
+            }
+        }
+    }
+    /* least fixpoint; tokens mostly follow the tokens leading to them */
+    do {
+        changed = FALSE;
+        for (p=0; p<PR_MAX_NR_PREPROC; p++) {
+            for (t = len[p] - 1; t >= 0; t--) {
+                m = masks[p][t] | pr_firstTypesOfToken(this, pr, masks, p, (picokpr_TokArrOffset)t);
+                if (m != masks[p][t]) {
+                    masks[p][t] = m;
+                    changed = TRUE;
+                }
+            }
+        }
+    } while (changed);
+}
+
+
+static void pr_compileNetworks (register picodata_ProcessingUnit this, pr_subobj_t * pr)
+{
+    picoos_int32 p;
+
+    for (p=0; p<PR_MAX_NR_PREPROC; p++) {
+        pr->firstTypes[p] = NULL;
+        pr->strLC[p] = NULL;
+    }
+    pr_compileFirstTypes(this, pr);
+    for (p=0; p<PR_MAX_NR_PREPROC; p++) {
+        if (pr->preproc[p] != NULL) {
+            pr->strLC[p] = pr_compileStrings(this, pr->preproc[p]);
+        }
+    }
+}
+
+
+#endif
+
+
 /* *****************************************************************************/
 /* *****************************************************************************/
 /* *****************************************************************************/
@@ -3232,11 +3637,10 @@ pico_status_t prReset(register picodata_ProcessingUnit this, picoos_int32 resetM
         return PICO_OK;
     }
 
-    pr->xsampa_parser = picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_XSAMPA_PARSE]);
-
-    pr->svoxpa_parser = picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_SVOXPA_PARSE]);
-
-    pr->xsampa2svoxpa_mapper = picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_XSAMPA2SVOXPA]);
+    /* see pr_getPhonemeFSTs */
+    pr->xsampa_parser = NULL;
+    pr->svoxpa_parser = NULL;
+    pr->xsampa2svoxpa_mapper = NULL;
 
 
 
@@ -3273,6 +3677,9 @@ pico_status_t prSubObjDeallocate(register picodata_ProcessingUnit this,
         PICODBG_INFO(("max pr_WorkMem: %i of %i", pr->maxWorkMemTop, PR_WORK_MEM_SIZE));
         PICODBG_INFO(("max pr_DynMem: %i of %i", pr->maxDynMemSize, PR_DYN_MEM_SIZE));
 
+#if defined(PICOPR_COMPILE)
+        pr_disposeCompiledNetworks(this, pr);
+#endif
         pr_disposeContextList(this);
         picoos_deallocate(this->common->mm, (void *) &this->subObj);
     }
@@ -3319,6 +3726,14 @@ picodata_ProcessingUnit picopr_newPreprocUnit(picoos_MemoryManager mm, picoos_Co
         picoos_deallocate(mm, (void *)&this);
         return NULL;
     }
+#if defined(PICOPR_COMPILE)
+    /* compiled in the first step, see prStep */
+    for (i=0; i<PR_MAX_NR_PREPROC; i++) {
+        pr->firstTypes[i] = NULL;
+        pr->strLC[i] = NULL;
+    }
+    pr->compiled = FALSE;
+#endif
     prInitialize(this, PICO_RESET_FULL);
     return this;
 }
@@ -3333,12 +3748,11 @@ picodata_step_result_t prStep(register picodata_ProcessingUnit this,
     pr_ioItemPtr it;
     picoos_int32 len, i;
     pico_status_t rv;
-    picoos_int32 id;
     picoos_uint8 info1;
     picoos_uint8 info2;
     picoos_int32 nrUtfChars;
     picoos_uint32 pos;
-    picobase_utf8char inUtf8char, outUtf8char;
+    picobase_utf8char inUtf8char, outUtf8char, out2Utf8char;
     picoos_int32 inUtf8charlen, outUtf8charlen;
     picoos_int32 lenpos;
     picoos_bool ldone;
@@ -3351,6 +3765,15 @@ picodata_step_result_t prStep(register picodata_ProcessingUnit this,
 
     if (pr->outOfMemory) return PICODATA_PU_ERROR;
 
+#if defined(PICOPR_COMPILE)
+    /* only now that all PUs of the engine have taken their memory, so that
+       the networks are searched uncompiled if the rest is too small */
+    if (!pr->compiled) {
+        pr_compileNetworks(this, pr);
+        pr->compiled = TRUE;
+    }
+#endif
+
     mode = mode;        /* avoid warning "var not used in this function"*/
     pr->nrIterations = PR_MAX_NR_ITERATIONS;
 
@@ -3380,8 +3803,7 @@ picodata_step_result_t prStep(register picodata_ProcessingUnit this,
                 if ((it->head.info1 != PICODATA_ITEMINFO1_TOKTYPE_SPACE) && (it->head.len > 0)) {
                     nrUtfChars = picobase_utf8_length(it->data, PR_MAX_DATA_LEN);
                     if ((nrUtfChars == 1)
-                        && (((id = picoktab_graphOffset(pr->graphs, it->data)) > 0))
-                        && picoktab_getIntPropPunct(pr->graphs, id, &info1, &info2)) {
+                        && pr_getGraphPunct(pr, it->data, &info1, &info2)) {
                         /* single punctuation chars have to be delivered as PICODATA_ITEM_PUNC items
                            instead as PICODATA_ITEM_WORDGRAPH items */
                         pr->outBuf[pr->outWritePos++] = PICODATA_ITEM_PUNC;
@@ -3411,7 +3833,7 @@ picodata_step_result_t prStep(register picodata_ProcessingUnit this,
                                     */
                                     split = TRUE;
                                 }
-                                else if (((id = picoktab_graphOffset(pr->graphs, inUtf8char)) > 0) && picoktab_getStrPropGraphsubs1(pr->graphs, id, outUtf8char)) {
+                                else if (pr_getGraphSubs(pr, inUtf8char, outUtf8char, out2Utf8char)) {
                                     if (split) {
                                         /* split the token, eg. start a new item */
                                         pr->outBuf[pr->outWritePos++] = PICODATA_ITEM_WORDGRAPH;
@@ -3425,10 +3847,10 @@ picodata_step_result_t prStep(register picodata_ProcessingUnit this,
                                         pr->outBuf[pr->outWritePos++] = outUtf8char[i];
                                         pr->outBuf[lenpos]++;
                                     }
-                                    if (picoktab_getStrPropGraphsubs2(pr->graphs, id, outUtf8char)) {
-                                        outUtf8charlen = picobase_det_utf8_length(outUtf8char[0]);
+                                    if (out2Utf8char[0] != 0) {
+                                        outUtf8charlen = picobase_det_utf8_length(out2Utf8char[0]);
                                         for (i=0; i<outUtf8charlen; i++) {
-                                            pr->outBuf[pr->outWritePos++] = outUtf8char[i];
+                                            pr->outBuf[pr->outWritePos++] = out2Utf8char[i];
                                             pr->outBuf[lenpos]++;
                                         }
                                     }
@@ -55,6 +55,20 @@ picodata_ProcessingUnit picopr_newPreprocUnit(
 
 #define PICOPR_OUTBUF_SIZE 256
 
+/* define PICOPR_COMPILE to compile the preprocessing networks when the
+   unit is created: for each network token, a bit mask of the token types
+   the rest of its production can start with, used to drop search paths
+   that cannot match the next token, and lower-cased copies of the network
+   strings for the string tests. This takes about 22KB of engine memory
+   with the standard networks, which PICOCTRL_DEFAULT_ENGINE_SIZE adds;
+   the networks are compiled when the unit first runs, and searched as
+   usual if the engine memory left by all units is too small */
+#if defined(PICOPR_COMPILE)
+#define PICOPR_COMPILE_ENGINE_SIZE 32000
+#else
+#define PICOPR_COMPILE_ENGINE_SIZE 0
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -38,6 +38,96 @@ void picorsrc_disposeResourceManager(picoos_MemoryManager mm, picorsrc_ResourceM
     }
 }
 
+/* parses the header of a resource in native format; returns
+ * PICO_EXC_UNEXPECTED_FILE_TYPE if 'raw' is not such a resource */
+pico_status_t picorsrc_parseNativeHeader(const picoos_uint8 * raw,
+        picorsrc_native_header_t * header)
+{
+    picoos_uint32 pos = 0, magic, reserved;
+    picoos_uint8 * data = (picoos_uint8 *) raw;
+
+    picoos_read_mem_pi_uint32(data, &pos, &magic);
+    if (PICORSRC_NATIVE_MAGIC != magic) {
+        return PICO_EXC_UNEXPECTED_FILE_TYPE;
+    }
+    picoos_read_mem_pi_uint16(data, &pos, &header->version);
+    picoos_read_mem_pi_uint16(data, &pos, &header->numKbs);
+    picoos_read_mem_pi_uint32(data, &pos, &header->type);
+    picoos_read_mem_pi_uint32(data, &pos, &header->dataSize);
+    picoos_read_mem_pi_uint32(data, &pos, &header->checksum);
+    picoos_read_mem_pi_uint32(data, &pos, &reserved);
+    PICODBG_DEBUG(("native resource version %i with %i kbs, %i bytes",
+                   header->version, header->numKbs, header->dataSize));
+    if ((PICORSRC_NATIVE_VERSION != header->version)
+        || (header->numKbs > PICOKNOW_MAX_NUM_RESOURCE_KBS)
+        || (NULLC != raw[pos + PICORSRC_MAX_RSRC_NAME_SIZ - 1])) {
+        return PICO_EXC_FILE_CORRUPT;
+    }
+    picoos_strlcpy(header->name, (picoos_char *) raw + pos,
+                   PICORSRC_MAX_RSRC_NAME_SIZ);
+    if ((header->type <= PICORSRC_TYPE_NULL)
+        || (header->type > PICORSRC_TYPE_OTHER)) {
+        header->type = PICORSRC_TYPE_OTHER;
+    }
+    return PICO_OK;
+}
+
+/* checksum of the data of a native resource (32 bit FNV-1a) */
+picoos_uint32 picorsrc_nativeChecksum(const picoos_uint8 * data,
+        picoos_uint32 size)
+{
+    picoos_uint32 i, h = 2166136261u;
+
+    for (i = 0; i < size; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+/* creates the kb list of a native resource from its kb directory */
+pico_status_t picorsrc_getNativeKbList(picorsrc_ResourceManager this,
+        const picoos_uint8 * data,
+        picoos_uint32 datalen,
+        picoos_uint16 numKbs,
+        picoknow_KnowledgeBase * kbList)
+{
+    pico_status_t status = PICO_OK;
+    picoos_uint32 curpos = 0, kbid, offset, size;
+    picoos_uint16 i;
+    picoknow_KnowledgeBase kb;
+
+    *kbList = NULL;
+    if ((picoos_uint32) numKbs * PICORSRC_NATIVE_KBENTRY_SIZE > datalen) {
+        status = PICO_EXC_FILE_CORRUPT;
+    }
+    for (i = 0; (PICO_OK == status) && (i < numKbs); i++) {
+        picoos_read_mem_pi_uint32((picoos_uint8 *) data, &curpos, &kbid);
+        picoos_read_mem_pi_uint32((picoos_uint8 *) data, &curpos, &offset);
+        picoos_read_mem_pi_uint32((picoos_uint8 *) data, &curpos, &size);
+        PICODBG_DEBUG(("kb id %i at %i with size %i", kbid, offset, size));
+        if (0 == offset) {
+            status = picorsrc_createKnowledgeBase(this, NULL, size,
+                    (picoknow_kb_id_t) kbid, &kb);
+        } else if ((offset > datalen) || (size > datalen - offset)) {
+            status = PICO_EXC_FILE_CORRUPT;
+        } else {
+            /* resources are read-only; kbs only keep a non-const base */
+            status = picorsrc_createKnowledgeBase(this,
+                    (picoos_uint8 *) data + offset, size,
+                    (picoknow_kb_id_t) kbid, &kb);
+        }
+        if (PICO_OK == status) {
+            kb->next = *kbList;
+            *kbList = kb;
+        }
+    }
+    if (PICO_OK != status) {
+        picorsrc_releaseKbList(this, kbList);
+    }
+    return status;
+}
+
+
 /* load resource file. the type of resource file etc. are in the header,
  * then follows the directory, then the knowledge bases themselves (as byte streams) */
 
@@ -47,6 +137,10 @@ pico_status_t picorsrc_loadResource(picorsrc_ResourceManager this,
     picorsrc_Resource res;
     picoos_uint32 headerlen, len,maxlen;
     picoos_file_header_t header;
+    picorsrc_native_header_t nheader;
+    picoos_uint8 nraw[PICORSRC_NATIVE_HEADER_SIZE];
+    picoos_char * name = NULL;
+    picoos_bool native = FALSE;
     picoos_uint8 rem;
     pico_status_t status = PICO_OK;
 
@@ -86,21 +180,45 @@ pico_status_t picorsrc_loadResource(picorsrc_ResourceManager this,
                 NULL, (picoos_char *) "%s", fileName);
     }
     if (PICO_OK == status) {
-        status = readHeader(this, &header, &headerlen, res->file);
+        /* native resource? */
+        len = PICORSRC_NATIVE_HEADER_SIZE;
+        if (picoos_ReadBytes(res->file, nraw, &len)
+            && (PICORSRC_NATIVE_HEADER_SIZE == len)) {
+            status = picorsrc_parseNativeHeader(nraw, &nheader);
+            native = (PICO_OK == status);
+        } else {
+            status = PICO_EXC_UNEXPECTED_FILE_TYPE;
+        }
+        if (native) {
+            name = nheader.name;
+        } else if (PICO_EXC_UNEXPECTED_FILE_TYPE == status) {
+            status = picoos_SetPos(res->file, 0) ? PICO_OK : PICO_ERR_OTHER;
+            if (PICO_OK == status) {
+                status = readHeader(this, &header, &headerlen, res->file);
+                name = header.field[PICOOS_HEADER_NAME].value;
+            }
+        } else {
+            picoos_emRaiseException(this->common->em, status, NULL,
+                    (picoos_char *) "unsupported native resource %s", fileName);
+        }
         /* res->file now positioned at first pos after header */
     }
 
     /* ***************** check header values */
-    if (PICO_OK == status && isResourceLoaded(this, header.field[PICOOS_HEADER_NAME].value)) {
+    if (PICO_OK == status && isResourceLoaded(this, name)) {
         /* lingware is allready loaded, do nothing */
-        PICODBG_WARN((">>> lingware '%s' allready loaded",header.field[PICOOS_HEADER_NAME].value));
-        picoos_emRaiseWarning(this->common->em,PICO_WARN_RESOURCE_DOUBLE_LOAD,NULL,(picoos_char *)"%s",header.field[PICOOS_HEADER_NAME].value);
+        PICODBG_WARN((">>> lingware '%s' allready loaded",name));
+        picoos_emRaiseWarning(this->common->em,PICO_WARN_RESOURCE_DOUBLE_LOAD,NULL,(picoos_char *)"%s",name);
         status = PICO_WARN_RESOURCE_DOUBLE_LOAD;
     }
 
     if (PICO_OK == status) {
             /* get data length */
-        status = picoos_read_pi_uint32(res->file, &len);
+        if (native) {
+            len = nheader.dataSize;
+        } else {
+            status = picoos_read_pi_uint32(res->file, &len);
+        }
         PICODBG_DEBUG(("found net resource len of %i",len));
         /* allocate memory */
         if (PICO_OK == status) {
@@ -125,9 +243,17 @@ pico_status_t picorsrc_loadResource(picorsrc_ResourceManager this,
              has an effect in test configurations only */
             picoos_protectMem(this->common->mm, res->start, len, /*enable*/TRUE);
         }
+#if (PICORSRC_NATIVE_CHECK > 0)
+        if ((PICO_OK == status) && native
+            && (picorsrc_nativeChecksum(res->start, len) != nheader.checksum)) {
+            status = picoos_emRaiseException(this->common->em,
+                    PICO_EXC_FILE_CORRUPT, NULL,
+                    (picoos_char *) "checksum of %s", fileName);
+        }
+#endif
         /* note resource unique name */
         if (PICO_OK == status) {
-            if (picoos_strlcpy(res->name,header.field[PICOOS_HEADER_NAME].value,PICORSRC_MAX_RSRC_NAME_SIZ) < PICORSRC_MAX_RSRC_NAME_SIZ) {
+            if (picoos_strlcpy(res->name,name,PICORSRC_MAX_RSRC_NAME_SIZ) < PICORSRC_MAX_RSRC_NAME_SIZ) {
                 PICODBG_DEBUG(("assigned name %s to resource",res->name));
                 status = PICO_OK;
             } else {
@@ -141,7 +267,9 @@ pico_status_t picorsrc_loadResource(picorsrc_ResourceManager this,
         }
 
         /* get resource type */
-        if (PICO_OK == status) {
+        if ((PICO_OK == status) && native) {
+            res->type = (picorsrc_resource_type_t) nheader.type;
+        } else if (PICO_OK == status) {
             if (!picoos_strcmp(header.field[PICOOS_HEADER_CONTENT_TYPE].value, PICORSRC_FIELD_VALUE_TEXTANA)) {
                 res->type = PICORSRC_TYPE_TEXTANA;
             } else if (!picoos_strcmp(header.field[PICOOS_HEADER_CONTENT_TYPE].value, PICORSRC_FIELD_VALUE_SIGGEN)) {
@@ -157,7 +285,12 @@ pico_status_t picorsrc_loadResource(picorsrc_ResourceManager this,
 
         if (PICO_OK == status) {
             /* create kb list from resource */
-            status = picorsrc_getKbList(this, res->start, len, &res->kbList);
+            if (native) {
+                status = picorsrc_getNativeKbList(this, res->start, len,
+                        nheader.numKbs, &res->kbList);
+            } else {
+                status = picorsrc_getKbList(this, res->start, len, &res->kbList);
+            }
         }
     }
 
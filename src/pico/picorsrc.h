@@ -90,6 +90,60 @@ typedef struct picorsrc_resource         * picorsrc_Resource;
 #define PICO_INPLACE_EXTENSION  ".inp"
 
 
+/* **************************************************************************
+ *
+ *          native resource format
+ *
+ ****************************************************************************/
+
+/* Besides the SVOX format, resources may be in a native format written by
+ * tools/picorsrc_native.py. It has a binary header of fixed layout instead
+ * of the text header, and a kb directory of fixed size entries. All
+ * integers are little endian; the data and each kb start at a multiple of
+ * 8 bytes from the start of the file.
+ *
+ *   offset  bytes
+ *   0       4      magic "PICN"
+ *   4       2      version (PICORSRC_NATIVE_VERSION)
+ *   6       2      number of kbs
+ *   8       4      resource type (picorsrc_resource_type_t)
+ *   12      4      size of the data
+ *   16      4      checksum of the data (32 bit FNV-1a)
+ *   20      4      0
+ *   24      32     resource name, terminated by NULLC
+ *   56      8      0
+ *   64             data: per kb its id, offset from the start of the data
+ *                  (0 for a kb without content) and size (uint32 each),
+ *                  followed by the kbs as in the SVOX file
+ *
+ * Only the header and the directory differ from the SVOX format: the kbs
+ * are the same bytes, used in place, and their specializers still derive
+ * their tables at load as for SVOX files (and expand them with
+ * PICOKDT_DECODE, PICOKPDF_PREDECODE or PICOKFST_EXPAND). What the format
+ * saves is the parsing of the text header and kb list.
+ *
+ * The checksum is tested by 'picorsrc_native.py -i'; define
+ * PICORSRC_NATIVE_CHECK 1 to also test it on each load, which reads all of
+ * the data and takes about ten times as long as the rest of the load. */
+#define PICORSRC_NATIVE_MAGIC       0x4e434950u /* "PICN" */
+#define PICORSRC_NATIVE_VERSION     1
+#define PICORSRC_NATIVE_HEADER_SIZE 64
+#define PICORSRC_NATIVE_KBENTRY_SIZE 12
+
+#if !defined(PICORSRC_NATIVE_CHECK)
+#define PICORSRC_NATIVE_CHECK 0
+#endif
+
+typedef struct picorsrc_native_header {
+    picoos_uint16 version;
+    picoos_uint16 numKbs;
+    picoos_uint32 type;
+    picoos_uint32 dataSize;
+    picoos_uint32 checksum;
+    picoos_char name[PICORSRC_MAX_RSRC_NAME_SIZ];
+} picorsrc_native_header_t;
+
+
 
 /* **************************************************************************
  *
@@ -131,6 +185,23 @@ pico_status_t picorsrc_createDefaultResource(picorsrc_ResourceManager this /*,
 pico_status_t picorsrc_rsrcGetName(picorsrc_Resource resource,
         picoos_char * name, picoos_uint32 maxlen);
 
+/* parses the header of a resource in native format; returns
+ * PICO_EXC_UNEXPECTED_FILE_TYPE if 'raw' is not such a resource */
+pico_status_t picorsrc_parseNativeHeader(const picoos_uint8 * raw,
+        picorsrc_native_header_t * header);
+
+/* checksum of the data of a native resource (32 bit FNV-1a) */
+picoos_uint32 picorsrc_nativeChecksum(const picoos_uint8 * data,
+        picoos_uint32 size);
+
+/* creates the kb list of a native resource of 'datalen' bytes of data
+ * from its kb directory */
+pico_status_t picorsrc_getNativeKbList(picorsrc_ResourceManager this,
+        const picoos_uint8 * data,
+        picoos_uint32 datalen,
+        picoos_uint16 numKbs,
+        picoknow_KnowledgeBase * kbList);
+
 /* **************************************************************************
  *
  *          voice definitions
@@ -435,61 +506,52 @@ static pico_status_t readHeader(picorsrc_ResourceManager this,
     return status;
 }
 
-static pico_status_t picorsrc_createKnowledgeBase(
-        picorsrc_ResourceManager this,
-        picoos_uint8 * data,
-        picoos_uint32 size,
-        picoknow_kb_id_t kbid,
-        picoknow_KnowledgeBase * kb)
+/* specializes 'kb' according to its id */
+static pico_status_t picorsrc_specializeKnowledgeBase(
+        picoknow_KnowledgeBase kb,
+        picoos_Common common)
 {
-    (*kb) = picoknow_newKnowledgeBase(this->common->mm);
-    if (NULL == (*kb)) {
-        return PICO_EXC_OUT_OF_MEM;
-    }
-    (*kb)->base = data;
-    (*kb)->size = size;
-    (*kb)->id = kbid;
-    switch (kbid) {
+    switch (kb->id) {
         case PICOKNOW_KBID_TPP_MAIN:
         case PICOKNOW_KBID_TPP_USER_1:
         case PICOKNOW_KBID_TPP_USER_2:
-            return picokpr_specializePreprocKnowledgeBase(*kb, this->common);
+            return picokpr_specializePreprocKnowledgeBase(kb, common);
             break;
         case PICOKNOW_KBID_TAB_GRAPHS:
-            return picoktab_specializeGraphsKnowledgeBase(*kb, this->common);
+            return picoktab_specializeGraphsKnowledgeBase(kb, common);
             break;
         case PICOKNOW_KBID_TAB_PHONES:
-            return picoktab_specializePhonesKnowledgeBase(*kb, this->common);
+            return picoktab_specializePhonesKnowledgeBase(kb, common);
             break;
         case PICOKNOW_KBID_TAB_POS:
-            return picoktab_specializePosKnowledgeBase(*kb, this->common);
+            return picoktab_specializePosKnowledgeBase(kb, common);
             break;
         case PICOKNOW_KBID_FIXED_IDS:
-            return picoktab_specializeIdsKnowledgeBase(*kb, this->common);
+            return picoktab_specializeIdsKnowledgeBase(kb, common);
             break;
         case PICOKNOW_KBID_LEX_MAIN:
         case PICOKNOW_KBID_LEX_USER_1:
         case PICOKNOW_KBID_LEX_USER_2:
-            return picoklex_specializeLexKnowledgeBase(*kb, this->common);
+            return picoklex_specializeLexKnowledgeBase(kb, common);
             break;
         case PICOKNOW_KBID_DT_POSP:
-            return picokdt_specializeDtKnowledgeBase(*kb, this->common,
+            return picokdt_specializeDtKnowledgeBase(kb, common,
                                                      PICOKDT_KDTTYPE_POSP);
             break;
         case PICOKNOW_KBID_DT_POSD:
-            return picokdt_specializeDtKnowledgeBase(*kb, this->common,
+            return picokdt_specializeDtKnowledgeBase(kb, common,
                                                      PICOKDT_KDTTYPE_POSD);
             break;
         case PICOKNOW_KBID_DT_G2P:
-            return picokdt_specializeDtKnowledgeBase(*kb, this->common,
+            return picokdt_specializeDtKnowledgeBase(kb, common,
                                                      PICOKDT_KDTTYPE_G2P);
             break;
         case PICOKNOW_KBID_DT_PHR:
-            return picokdt_specializeDtKnowledgeBase(*kb, this->common,
+            return picokdt_specializeDtKnowledgeBase(kb, common,
                                                      PICOKDT_KDTTYPE_PHR);
             break;
         case PICOKNOW_KBID_DT_ACC:
-             return picokdt_specializeDtKnowledgeBase(*kb, this->common,
+             return picokdt_specializeDtKnowledgeBase(kb, common,
                                                       PICOKDT_KDTTYPE_ACC);
              break;
         case PICOKNOW_KBID_FST_SPHO_1:
@@ -511,7 +573,7 @@ static pico_status_t picorsrc_createKnowledgeBase(
         case PICOKNOW_KBID_FST_XSAMPA_PARSE:
         case PICOKNOW_KBID_FST_XSAMPA2SVOXPA:
 
-             return picokfst_specializeFSTKnowledgeBase(*kb, this->common);
+             return picokfst_specializeFSTKnowledgeBase(kb, common);
              break;
 
         case PICOKNOW_KBID_DT_DUR:
@@ -525,24 +587,24 @@ static pico_status_t picorsrc_createKnowledgeBase(
         case PICOKNOW_KBID_DT_MGC3:
         case PICOKNOW_KBID_DT_MGC4:
         case PICOKNOW_KBID_DT_MGC5:
-            return picokdt_specializeDtKnowledgeBase(*kb, this->common,
+            return picokdt_specializeDtKnowledgeBase(kb, common,
                                                      PICOKDT_KDTTYPE_PAM);
             break;
         case PICOKNOW_KBID_PDF_DUR:
-            return picokpdf_specializePdfKnowledgeBase(*kb, this->common,
+            return picokpdf_specializePdfKnowledgeBase(kb, common,
                                                        PICOKPDF_KPDFTYPE_DUR);
 
             break;
         case PICOKNOW_KBID_PDF_LFZ:
-            return picokpdf_specializePdfKnowledgeBase(*kb, this->common,
+            return picokpdf_specializePdfKnowledgeBase(kb, common,
                                                        PICOKPDF_KPDFTYPE_MUL);
             break;
         case PICOKNOW_KBID_PDF_MGC:
-            return picokpdf_specializePdfKnowledgeBase(*kb, this->common,
+            return picokpdf_specializePdfKnowledgeBase(kb, common,
                                                        PICOKPDF_KPDFTYPE_MUL);
             break;
         case PICOKNOW_KBID_PDF_PHS:
-            return picokpdf_specializePdfKnowledgeBase(*kb, this->common,
+            return picokpdf_specializePdfKnowledgeBase(kb, common,
                                                        PICOKPDF_KPDFTYPE_PHS);
             break;
 
@@ -550,7 +612,7 @@ static pico_status_t picorsrc_createKnowledgeBase(
 
 #if defined(PICO_DEBUG)
         case PICOKNOW_KBID_DBG:
-            return picokdbg_specializeDbgKnowledgeBase(*kb, this->common);
+            return picokdbg_specializeDbgKnowledgeBase(kb, common);
             break;
 #endif
 
@@ -561,6 +623,31 @@ static pico_status_t picorsrc_createKnowledgeBase(
 }
 
 
+static pico_status_t picorsrc_createKnowledgeBase(
+        picorsrc_ResourceManager this,
+        picoos_uint8 * data,
+        picoos_uint32 size,
+        picoknow_kb_id_t kbid,
+        picoknow_KnowledgeBase * kb)
+{
+    (*kb) = picoknow_newKnowledgeBase(this->common->mm);
+    if (NULL == (*kb)) {
+        return PICO_EXC_OUT_OF_MEM;
+    }
+    (*kb)->base = data;
+    (*kb)->size = size;
+    (*kb)->id = kbid;
+#if defined(PICOKNOW_LAZY_INIT)
+    /* specialized by picoknow_getSubObj on first use */
+    (*kb)->specialize = picorsrc_specializeKnowledgeBase;
+    (*kb)->common = this->common;
+    return PICO_OK;
+#else
+    return picorsrc_specializeKnowledgeBase(*kb, this->common);
+#endif
+}
+
+
 static pico_status_t picorsrc_releaseKnowledgeBase(
         picorsrc_ResourceManager this,
         picoknow_KnowledgeBase * kb)
@@ -180,6 +180,18 @@ typedef struct {
 } picosa_headx_t;
 
 
+#if (PICOSA_G2P_CACHE_SIZE > 0)
+/* g2p result of one word, see saG2PCache* */
+typedef struct {
+    picoos_uint32 lastUse;  /* 0 if unused */
+    picoos_uint8 pos;
+    picoos_uint8 graphlen;
+    picoos_uint8 plen;
+    picoos_uint8 graph[PICOSA_G2P_CACHE_MAXGRAPH];
+    picoos_uint8 phones[PICOSA_G2P_CACHE_MAXPHONES];
+} sa_g2pcache_t;
+#endif
+
 typedef struct sa_subobj {
     picoos_uint8 procState; /* for next processing step decision */
 
@@ -213,6 +225,10 @@ typedef struct sa_subobj {
     picotrns_AltDesc altDescBuf;
     /* the number of AltDesc in the buffer */
     picoos_uint16 maxAltDescLen;
+#if (PICOTRNS_CACHE_SIZE > 0)
+    /* transduction results of recently seen words, NULL if not available */
+    picotrns_TransCache trnsCache;
+#endif
 
     /* tab knowledge base */
     picoktab_Graphs tabgraphs;
@@ -238,10 +254,27 @@ typedef struct sa_subobj {
     picokfst_FST fst[PICOKNOW_MAX_NUM_WPHO_FSTS];
     picoos_uint8 curFst; /* the fst to be applied next */
 
+    /* vowel info of the word in g2p, cf. saGetWordVowels */
+    picoos_uint8 g2pNrVow;
+    picoos_uint8 g2pOrdVow[256];    /* indexed by byte position in word */
+
+#if (PICOSA_G2P_CACHE_SIZE > 0)
+    /* g2p results of recently seen words, kept across utterances and
+       flushed when the knowledge bases are (re)fetched */
+    sa_g2pcache_t g2pCache[PICOSA_G2P_CACHE_SIZE];
+    picoos_uint32 g2pCacheClock;
+    picoos_uint32 g2pCacheHits;
+    picoos_uint32 g2pCacheMisses;
+    picoos_uint32 g2pCacheBypasses; /* words too long to be cached */
+#endif
 
 } sa_subobj_t;
 
 
+#if (PICOSA_G2P_CACHE_SIZE > 0)
+static void saG2PCacheReset(register sa_subobj_t *sa);
+#endif
+
 static pico_status_t saInitialize(register picodata_ProcessingUnit this, picoos_int32 resetMode) {
     sa_subobj_t * sa;
     picoos_uint16 i;
@@ -299,6 +332,15 @@ static pico_status_t saInitialize(register picodata_ProcessingUnit this, picoos_
         return PICO_OK;
     }
 
+#if (PICOSA_G2P_CACHE_SIZE > 0)
+    /* knowledge bases are fetched anew below, cached g2p results may
+       no longer be valid */
+    saG2PCacheReset(sa);
+#endif
+#if (PICOTRNS_CACHE_SIZE > 0)
+    picotrns_resetTransCache(sa->trnsCache);
+#endif
+
     /* kb fst[] */
     sa->numFsts = 0;
     for (i = 0; i<PICOKNOW_MAX_NUM_WPHO_FSTS; i++) {
@@ -434,6 +476,9 @@ static pico_status_t saSubObjDeallocate(register picodata_ProcessingUnit this,
     if (NULL != this) {
         sa = (sa_subobj_t *) this->subObj;
         picotrns_deallocate_alt_desc_buf(mm,&sa->altDescBuf);
+#if (PICOTRNS_CACHE_SIZE > 0)
+        picotrns_disposeTransCache(mm,&sa->trnsCache);
+#endif
         picoos_deallocate(mm, (void *) &this->subObj);
     }
     return PICO_OK;
@@ -474,6 +519,10 @@ picodata_ProcessingUnit picosa_newSentAnaUnit(picoos_MemoryManager mm,
         picoos_deallocate(mm, (void *)&this);
         picoos_emRaiseException(common->em,PICO_EXC_OUT_OF_MEM, NULL, NULL);
     }
+#if (PICOTRNS_CACHE_SIZE > 0)
+    /* without cache, words are simply always transduced */
+    sa->trnsCache = picotrns_newTransCache(mm);
+#endif
 
 
     saInitialize(this, PICO_RESET_FULL);
@@ -788,40 +837,38 @@ static pico_status_t saLexIndLookup(register picodata_ProcessingUnit this,
                nVord           vowel order in the word
    Returns :   TRUE: processing successful;  FALSE: errors
 */
-static picoos_uint8 saGetNrVowel(register picodata_ProcessingUnit this,
-                                 register sa_subobj_t *sa,
-                                 const picoos_uint8 *sInChar,
-                                 const picoos_uint16 inLen,
-                                 const picoos_uint8 inPos,
-                                 picoos_uint8 *nVow,
-                                 picoos_uint8 *nVord) {
+/* determine the vowel info of all graphs of a word at once:
+   sa->g2pOrdVow[pos] is the order of the vowel-like graph starting at
+   byte pos (0 if not vowel-like) and sa->g2pNrVow the number of
+   vowel-like graphs in the word; all 0 for an invalid word */
+static void saGetWordVowels(register picodata_ProcessingUnit this,
+                            register sa_subobj_t *sa,
+                            const picoos_uint8 *sInChar,
+                            const picoos_uint8 inLen) {
     picoos_uint32 nCount;
     picoos_uint32 pos;
     picoos_uint8 cstr[PICOBASE_UTF8_MAXLEN + 1];
 
-    /*defaults*/
-    *nVow = 0;
-    *nVord = 0;
-    /*1:check wether the current char is a vowel*/
-    pos = inPos;
-    if (!picobase_get_next_utf8char(sInChar, inLen, &pos, cstr) ||
-        !picoktab_hasVowellikeProp(sa->tabgraphs, cstr, PICOBASE_UTF8_MAXLEN)) {
-        return FALSE;
+    sa->g2pNrVow = 0;
+    for (pos = 0; pos < inLen; pos++) {
+        sa->g2pOrdVow[pos] = 0;
     }
-    /*2:count number of vowels in current word and find vowel order*/
     for (nCount = 0; nCount < inLen; ) {
-      if (!picobase_get_next_utf8char(sInChar, inLen, &nCount, cstr)) {
-            return FALSE;
-      }
+        pos = nCount;
+        if (!picobase_get_next_utf8char(sInChar, inLen, &nCount, cstr)) {
+            /* no vowel info at all for invalid words */
+            sa->g2pNrVow = 0;
+            for (pos = 0; pos < inLen; pos++) {
+                sa->g2pOrdVow[pos] = 0;
+            }
+            return;
+        }
         if (picoktab_hasVowellikeProp(sa->tabgraphs, cstr,
                                       PICOBASE_UTF8_MAXLEN)) {
-            (*nVow)++;
-            if (nCount == pos) {
-                (*nVord) = (*nVow);
-        }
+            sa->g2pNrVow++;
+            sa->g2pOrdVow[pos] = sa->g2pNrVow;
         }
     }
-    return TRUE;
 }
 
 
@@ -847,6 +894,9 @@ static picoos_uint8 saDoG2P(register picodata_ProcessingUnit this,
     picoos_uint8 ordvow;
     picokdt_classify_vecresult_t dtresv;
     picoos_uint16 i;
+#if (PICOKDT_G2P_MAXWORDLEN > 0)
+    picoos_uint8 wordSet;
+#endif
 
     *plen = 0;
     okay = TRUE;
@@ -866,6 +916,12 @@ static picoos_uint8 saDoG2P(register picodata_ProcessingUnit this,
     /* inner loop */
     nPrimary = 0;
 
+    /* decode the word and determine its vowels once for all positions */
+    saGetWordVowels(this, sa, graph, graphlen);
+#if (PICOKDT_G2P_MAXWORDLEN > 0)
+    wordSet = picokdt_dtG2PsetWord(sa->dtg2p, graph, graphlen);
+#endif
+
     /* ************************************************/
     /* go backward grapheme by grapheme, it's utf8... */
     /* ************************************************/
@@ -887,15 +943,25 @@ static picoos_uint8 saDoG2P(register picodata_ProcessingUnit this,
         PICODBG_TRACE(("right-to-left g2p, count: %d", nCount));
         okay = TRUE;
 
-        if (!saGetNrVowel(this, sa, graph, graphlen, nCount-1, &nrvow,
-                          &ordvow)) {
-            nrvow = 0;
-            ordvow = 0;
-        }
+        ordvow = sa->g2pOrdVow[nCount-1];
+        nrvow = (ordvow > 0) ? sa->g2pNrVow : 0;
 
         /* prepare input vector, set inside tree object invec,
          * g2pBuildVector will call the constructInVec tree method */
-        if (!picokdt_dtG2PconstructInVec(sa->dtg2p,
+#if (PICOKDT_G2P_MAXWORDLEN > 0)
+        if (wordSet) {
+            okay = picokdt_dtG2PconstructWordInVec(sa->dtg2p,
+                                         nCount-1, /*grapheme current position*/
+                                         pos, /*Word POS*/
+                                         nrvow, /*nr vowels if vowel, 0 else */
+                                         ordvow, /*ord of vowel if vowel, 0 el*/
+                                         &nPrimary,  /*primary stress flag*/
+                                         outNp1Ch, /*Right phoneme context +1*/
+                                         outNp2Ch, /*Right phoneme context +2*/
+                                         outNp3Ch); /*Right phon context +3*/
+        } else
+#endif
+        okay = picokdt_dtG2PconstructInVec(sa->dtg2p,
                                          graph, /*grapheme start*/
                                          graphlen, /*grapheme length*/
                                          nCount-1, /*grapheme current position*/
@@ -905,7 +971,8 @@ static picoos_uint8 saDoG2P(register picodata_ProcessingUnit this,
                                          &nPrimary,  /*primary stress flag*/
                                          outNp1Ch, /*Right phoneme context +1*/
                                          outNp2Ch, /*Right phoneme context +2*/
-                                         outNp3Ch)) { /*Right phon context +3*/
+                                         outNp3Ch); /*Right phon context +3*/
+        if (!okay) {
             /*Errors in preparing the input vector : skip processing*/
             PICODBG_WARN(("problem with invec"));
             picoos_emRaiseWarning(this->common->em, PICO_WARN_INVECTOR,
@@ -1000,12 +1067,118 @@ static picoos_uint8 saDoG2P(register picodata_ProcessingUnit this,
 }
 
 
+#if (PICOSA_G2P_CACHE_SIZE > 0)
+
+/* ************** g2p cache ***************/
+
+static void saG2PCacheReset(register sa_subobj_t *sa) {
+    picoos_uint16 i;
+
+    PICODBG_INFO(("g2p cache hits: %d, misses: %d, bypasses: %d",
+                  sa->g2pCacheHits, sa->g2pCacheMisses,
+                  sa->g2pCacheBypasses));
+    for (i = 0; i < PICOSA_G2P_CACHE_SIZE; i++) {
+        sa->g2pCache[i].lastUse = 0;
+    }
+    sa->g2pCacheClock = 0;
+    sa->g2pCacheHits = 0;
+    sa->g2pCacheMisses = 0;
+    sa->g2pCacheBypasses = 0;
+}
+
+/* returns the cache entry for word 'graph' with POS 'pos', NULL if none */
+static sa_g2pcache_t * saG2PCacheLookup(register sa_subobj_t *sa,
+                                        const picoos_uint8 *graph,
+                                        const picoos_uint8 graphlen,
+                                        const picoos_uint8 pos) {
+    picoos_uint16 i;
+    sa_g2pcache_t * e;
+
+    if (graphlen > PICOSA_G2P_CACHE_MAXGRAPH) {
+        /* never stored, so not a miss either */
+        sa->g2pCacheBypasses++;
+        return NULL;
+    }
+    for (i = 0; i < PICOSA_G2P_CACHE_SIZE; i++) {
+        e = &(sa->g2pCache[i]);
+        if ((e->lastUse > 0) && (e->graphlen == graphlen) &&
+            (e->pos == pos) &&
+            (picoos_strncmp((picoos_char *)e->graph,
+                            (picoos_char *)graph, graphlen) == 0)) {
+            e->lastUse = ++sa->g2pCacheClock;
+            sa->g2pCacheHits++;
+            return e;
+        }
+    }
+    sa->g2pCacheMisses++;
+    return NULL;
+}
+
+/* stores the g2p result of a word, replacing the least recently used */
+static void saG2PCacheStore(register sa_subobj_t *sa,
+                            const picoos_uint8 *graph,
+                            const picoos_uint8 graphlen,
+                            const picoos_uint8 pos,
+                            const picoos_uint8 *phones,
+                            const picoos_uint16 plen) {
+    picoos_uint16 i;
+    sa_g2pcache_t * e;
+
+    if ((graphlen > PICOSA_G2P_CACHE_MAXGRAPH) ||
+        (plen > PICOSA_G2P_CACHE_MAXPHONES)) {
+        return;
+    }
+    if (sa->g2pCacheClock == (picoos_uint32)-1) {
+        /* restart use counts instead of wrapping around */
+        saG2PCacheReset(sa);
+    }
+    e = &(sa->g2pCache[0]);
+    for (i = 1; i < PICOSA_G2P_CACHE_SIZE; i++) {
+        if (sa->g2pCache[i].lastUse < e->lastUse) {
+            e = &(sa->g2pCache[i]);
+        }
+    }
+    e->lastUse = ++sa->g2pCacheClock;
+    e->pos = pos;
+    e->graphlen = graphlen;
+    e->plen = (picoos_uint8)plen;
+    for (i = 0; i < graphlen; i++) {
+        e->graph[i] = graph[i];
+    }
+    for (i = 0; i < plen; i++) {
+        e->phones[i] = phones[i];
+    }
+}
+
+#endif
+
 /* item in headx[ind]/cbuf1, out: modified headx and cbuf2 */
 
 static pico_status_t saGraphemeToPhoneme(register picodata_ProcessingUnit this,
                                          register sa_subobj_t *sa,
                                          picoos_uint16 ind) {
     picoos_uint16 plen;
+#if (PICOSA_G2P_CACHE_SIZE > 0)
+    sa_g2pcache_t * e;
+    picoos_uint16 i;
+
+    /* a recently seen word: take the phones from the cache, but only
+       if they fit completely, otherwise g2p skips phones as usual */
+    e = saG2PCacheLookup(sa, &(sa->cbuf1[sa->headx[ind].cind]),
+                         sa->headx[ind].head.len, sa->headx[ind].head.info1);
+    if ((NULL != e) && (e->plen < (sa->cbuf2BufSize - sa->cbuf2Len))) {
+        for (i = 0; i < e->plen; i++) {
+            sa->cbuf2[sa->cbuf2Len + i] = e->phones[i];
+        }
+        sa->headx[ind].head.type = PICODATA_ITEM_WORDPHON;
+        sa->headx[ind].head.len = e->plen;
+        sa->headx[ind].cind = sa->cbuf2Len;
+        sa->cbuf2Len += e->plen;
+        PICODBG_DEBUG(("%c item from g2p cache, plen: %d",
+                       PICODATA_ITEM_WORDPHON, e->plen));
+        return PICO_OK;
+    }
+#endif
 
     PICODBG_TRACE(("starting g2p"));
 
@@ -1014,6 +1187,16 @@ static pico_status_t saGraphemeToPhoneme(register picodata_ProcessingUnit this,
                 &(sa->cbuf2[sa->cbuf2Len]), (sa->cbuf2BufSize - sa->cbuf2Len),
                 &plen)) {
 
+#if (PICOSA_G2P_CACHE_SIZE > 0)
+        /* only complete results are kept, see saDoG2P; a word found in
+           the cache whose phones did not fit is already there */
+        if ((NULL == e) && (plen < (sa->cbuf2BufSize - sa->cbuf2Len))) {
+            saG2PCacheStore(sa, &(sa->cbuf1[sa->headx[ind].cind]),
+                            sa->headx[ind].head.len, sa->headx[ind].head.info1,
+                            &(sa->cbuf2[sa->cbuf2Len]), plen);
+        }
+#endif
+
         /* check of cbuf2Len done in saDoG2P, phones skipped if needed */
         if (plen > 255) {
             PICODBG_WARN(("maximum number of phones exceeded (%d), skipping",
@@ -1637,11 +1820,19 @@ static picodata_step_result_t saStep(register picodata_ProcessingUnit this,
                        PICODBG_INFO_MSG(("\n"));
                    }
 #endif
+#if (PICOTRNS_CACHE_SIZE > 0)
+                   picotrns_cachedTransduce(sa->trnsCache, sa->fst[sa->curFst], FALSE,
+                           picotrns_printSolution, sa->phonBuf, sa->phonWritePos, sa->phonBufOut,
+                           &sa->phonWritePos,
+                           PICOTRNS_MAX_NUM_POSSYM, sa->altDescBuf,
+                           sa->maxAltDescLen, &nrSteps);
+#else
                    picotrns_transduce(sa->fst[sa->curFst], FALSE,
                            picotrns_printSolution, sa->phonBuf, sa->phonWritePos, sa->phonBufOut,
                            &sa->phonWritePos,
                            PICOTRNS_MAX_NUM_POSSYM, sa->altDescBuf,
                            sa->maxAltDescLen, &nrSteps);
+#endif
 #if defined(PICO_DEBUG)
                    {
                        PICODBG_INFO_CTX();
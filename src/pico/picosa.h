@@ -200,6 +200,18 @@ extern "C" {
 /* maximum length of an item incl. head for input GetItem buffer */
 #define PICOSA_MAXITEMSIZE   260
 
+/* nr of words (grapheme string plus POS) whose g2p result is kept across
+   utterances, least recently used first replaced; 0 disables the cache */
+#if !defined(PICOSA_G2P_CACHE_SIZE)
+#define PICOSA_G2P_CACHE_SIZE 32
+#endif
+/* longest grapheme string and phone string kept in the g2p cache */
+#define PICOSA_G2P_CACHE_MAXGRAPH  32
+#define PICOSA_G2P_CACHE_MAXPHONES 48
+/* engine memory taken by the g2p cache, see PICOCTRL_DEFAULT_ENGINE_SIZE */
+#define PICOSA_G2P_CACHE_ENGINE_SIZE (PICOSA_G2P_CACHE_SIZE * \
+        (8 + PICOSA_G2P_CACHE_MAXGRAPH + PICOSA_G2P_CACHE_MAXPHONES))
+
 
 picodata_ProcessingUnit picosa_newSentAnaUnit(
         picoos_MemoryManager mm,
@@ -335,9 +335,16 @@ static pico_status_t getPhsFromPdf(register picodata_ProcessingUnit this,
     if (phsIndex >= pdf->numvectors) {
         return PICODATA_PU_ERROR;
     }
-    nCurrIndexOffset = ((picoos_uint8*) pdf->indexBase) + phsIndex * sizeof(picoos_uint32);
-    nIndexValue = (0xFF000000 & ((*(nCurrIndexOffset+3)) << 24)) | (0x00FF0000 & ((*(nCurrIndexOffset+2)) << 16)) |
-                  (0x0000FF00 & ((*(nCurrIndexOffset+1)) << 8))  | (0x000000FF & ((*nCurrIndexOffset)));
+#if defined(PICOKPDF_PREDECODE)
+    if (pdf->decoded != NULL) {
+        nIndexValue = pdf->decoded[phsIndex];
+    } else
+#endif
+    {
+        nCurrIndexOffset = ((picoos_uint8*) pdf->indexBase) + phsIndex * sizeof(picoos_uint32);
+        nIndexValue = (0xFF000000 & ((*(nCurrIndexOffset+3)) << 24)) | (0x00FF0000 & ((*(nCurrIndexOffset+2)) << 16)) |
+                      (0x0000FF00 & ((*(nCurrIndexOffset+1)) << 8))  | (0x000000FF & ((*nCurrIndexOffset)));
+    }
     nContent = pdf->contentBase;
     nContent += nIndexValue;
     *numComponents = (picoos_int16) *nContent++;
@@ -874,6 +881,13 @@ static picodata_step_result_t sigStep(register picodata_ProcessingUnit this,
                                         sig_subObj->sInSDFileName[0] = '\0';
                                         return PICODATA_PU_BUSY;
                                     }
+                                    if (sf != PICODSP_SAMP_FREQ) {
+                                        /*file does not match the output sampling frequency (narrowband)*/
+                                        PICODBG_WARN(("sampling frequency of %s not supported\n", s_temp_file_name));
+                                        picoos_sdfCloseIn(this->common, &(sig_subObj->sInSDFile));
+                                        sig_subObj->sInSDFileName[0] = '\0';
+                                        return PICODATA_PU_BUSY;
+                                    }
                                     /*input file handle is now valid : store filename*/
                                     picoos_strlcpy(
                                             (picoos_char*) sig_subObj->sInSDFileName,
@@ -935,7 +949,7 @@ static picodata_step_result_t sigStep(register picodata_ProcessingUnit this,
                                     picoos_sdfOpenOut(this->common,
                                             &(sig_subObj->sOutSDFile),
                                             s_temp_file_name,
-                                            SAMPLE_FREQ_16KHZ, PICOOS_ENC_LIN);
+                                            PICODSP_SAMP_FREQ, PICOOS_ENC_LIN);
                                     if (sig_subObj->sOutSDFile == NULL) {
                                         PICODBG_DEBUG(("Error on opening file %s\n", sig_subObj->sOutSDFileName));
                                         sig_subObj->outSwitch = 0;
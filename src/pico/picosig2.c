@@ -105,7 +105,7 @@ pico_status_t sigAllocate(picoos_MemoryManager mm, sig_innerobj_t *sig_inObj)
     sig_inObj->idx_vect1 = data_i;
 
     data_i = (picoos_int16 *) picoos_allocate(mm, sizeof(picoos_int16)
-            * PICODSP_HFFTSIZE_P1);
+            * PICODSP_MODEL_HFFTSIZE_P1);
     if (NULL == data_i) {
         sigDeallocate(mm, sig_inObj);
         return PICO_ERR_OTHER;
@@ -161,7 +161,7 @@ pico_status_t sigAllocate(picoos_MemoryManager mm, sig_innerobj_t *sig_inObj)
     sig_inObj->idx_vect9 = data_i;
 
     d32 = (picoos_int32 *) picoos_allocate(mm, sizeof(picoos_int32)
-            * PICODSP_FFTSIZE);
+            * PICODSP_MODEL_FFTSIZE);
     if (NULL == d32) {
         sigDeallocate(mm, sig_inObj);
         return PICO_ERR_OTHER;
@@ -182,7 +182,7 @@ pico_status_t sigAllocate(picoos_MemoryManager mm, sig_innerobj_t *sig_inObj)
     }
     sig_inObj->int_vec24 = d32;
     d32 = (picoos_int32 *) picoos_allocate(mm, sizeof(picoos_int32)
-            * PICODSP_FFTSIZE);
+            * PICODSP_MODEL_FFTSIZE);
     if (NULL == d32) {
         sigDeallocate(mm, sig_inObj);
         return PICO_ERR_OTHER;
@@ -197,7 +197,7 @@ pico_status_t sigAllocate(picoos_MemoryManager mm, sig_innerobj_t *sig_inObj)
     sig_inObj->int_vec26 = d32;
 
     d32 = (picoos_int32 *) picoos_allocate(mm, sizeof(picoos_int32)
-            * PICODSP_FFTSIZE);
+            * PICODSP_MODEL_FFTSIZE);
     if (NULL == d32) {
         sigDeallocate(mm, sig_inObj);
         return PICO_ERR_OTHER;
@@ -211,7 +211,7 @@ pico_status_t sigAllocate(picoos_MemoryManager mm, sig_innerobj_t *sig_inObj)
     }
     sig_inObj->int_vec29 = d32;
     d32 = (picoos_int32 *) picoos_allocate(mm, sizeof(picoos_int32)
-            * PICODSP_FFTSIZE);
+            * PICODSP_MODEL_FFTSIZE);
     if (NULL == d32) {
         sigDeallocate(mm, sig_inObj);
         return PICO_ERR_OTHER;
@@ -276,7 +276,7 @@ pico_status_t sigAllocate(picoos_MemoryManager mm, sig_innerobj_t *sig_inObj)
     sig_inObj->int_vec37 = d32;
 
     d32 = (picoos_int32 *) picoos_allocate(mm, sizeof(picoos_int32)
-            * PICODSP_HFFTSIZE_P1);
+            * PICODSP_ANGSIZE);
     if (NULL == d32) {
         sigDeallocate(mm, sig_inObj);
         return PICO_ERR_OTHER;
@@ -536,7 +536,7 @@ void mel_2_lin_lookup(sig_innerobj_t *sig_inObj, picoos_uint32 scmeanMGC)
     /*Link local variables with sig data object*/
     c1 = sig_inObj->wcep_pI;
     m1 = sig_inObj->m1_p;
-    m2 = PICODSP_FFTSIZE;
+    m2 = PICODSP_MODEL_FFTSIZE;
     m4 = m2 >> 1;
 
     A = sig_inObj->A_p;
@@ -555,7 +555,7 @@ void mel_2_lin_lookup(sig_innerobj_t *sig_inObj, picoos_uint32 scmeanMGC)
         else
           XXr[nI] = -(-c1[nI] << shift);
     }
-    i = sizeof(picoos_int32) * (PICODSP_FFTSIZE - m1);
+    i = sizeof(picoos_int32) * (PICODSP_MODEL_FFTSIZE - m1);
     picoos_mem_set(XXr + m1, 0, i);
     dfct_nmf(m4, XXr); /* DFCT directly in fixed point */
 
@@ -567,9 +567,15 @@ void mel_2_lin_lookup(sig_innerobj_t *sig_inObj, picoos_uint32 scmeanMGC)
      - Start from 1 and stop at PICODSP_H_FFTSIZE-1 because 0 and PICODSP_H_FFTSIZE are invariant points
      - B[k]=A[k]+1 except for 0 and PICODSP_H_FFTSIZE
      - get rid of extra -1 operation by adapting the table A[]
+     - narrowband : only the lower half of the model spectrum is needed, and
+       the narrowband Nyquist bin PICODSP_H_FFTSIZE is no invariant point
 
      *******************************************************************************************/
+#if defined(PICODSP_NARROWBAND)
+    for (nI = 1; nI <= PICODSP_H_FFTSIZE; nI++) {
+#else
     for (nI = 1; nI < PICODSP_H_FFTSIZE; nI++) {
+#endif
         k = A[nI];
         term2 = XXr[k];
         term1 = XXr[k + 1];
@@ -605,6 +611,9 @@ void phase_spec2(sig_innerobj_t *sig_inObj)
     /* current spect scale : times PICODSP_FIX_SCALE1 */
     ang = sig_inObj->ang_p;
     voxbnd = (picoos_int32) (sig_inObj->voxbnd_p * sig_inObj->voicing);
+    if (voxbnd > PICODSP_H_FFTSIZE) {
+        voxbnd = PICODSP_H_FFTSIZE; /* cut-off above Nyquist (narrowband) */
+    }
     voxbnd2 = sig_inObj->voxbnd2_p;
     voiced = sig_inObj->voiced_p;
     m2 = sig_inObj->m2_p;
@@ -711,6 +720,9 @@ void env_spec(sig_innerobj_t *sig_inObj)
     voiced = sig_inObj->voiced_p;
     prev_voiced = sig_inObj->prevVoiced_p;
     voxbnd = (picoos_int32) (sig_inObj->voxbnd_p * sig_inObj->voicing);
+    if (voxbnd > PICODSP_H_FFTSIZE) {
+        voxbnd = PICODSP_H_FFTSIZE; /* cut-off above Nyquist (narrowband) */
+    }
     ctbl = sig_inObj->cos_table;
     /*  ctbl scale : times 4096 */
     mult = PICODSP_ENVSPEC_K1 / PICODSP_FIX_SCALE1;
@@ -1529,6 +1541,17 @@ static void gen_hann2(sig_innerobj_t *sig_inObj)
     hann[254] = 0;
     hann[255] = 0;
 
+#if defined(PICODSP_NARROWBAND)
+    {
+        picoos_int16 i;
+        /* fold the model windows to the synthesis size by averaging sample
+           pairs (keeps the windows symmetric and the peak value) */
+        for (i = 0; i < PICODSP_FFTSIZE; i++) {
+            hann[i] = (hann[2 * i] + hann[2 * i + 1]) >> 1;
+            norm[i] = (norm[2 * i] + norm[2 * i + 1]) >> 1;
+        }
+    }
+#endif
 } /* gen_hann2 */
 
 /**
@@ -196,6 +196,10 @@ typedef struct spho_subobj {
     picotrns_AltDesc altDescBuf;
     /* the number of AltDesc in the buffer */
     picoos_uint16 maxAltDescLen;
+#if (PICOTRNS_CACHE_SIZE > 0)
+    /* transduction results of recently seen (short) phrases, NULL if not available */
+    picotrns_TransCache trnsCache;
+#endif
 
     /* the input to a transducer should not be larger than PICOTRNS_MAX_NUM_POSSYM
      * so the output may expand (up to 4*PICOTRNS_MAX_NUM_POSSYM) */
@@ -303,6 +307,13 @@ static pico_status_t sphoInitialize(register picodata_ProcessingUnit this, picoo
 
     spho = (spho_subobj_t *) this->subObj;
 
+#if (PICOTRNS_CACHE_SIZE > 0)
+    if (resetMode != PICO_RESET_SOFT) {
+        /* fsts are fetched anew below, cached results may no longer be valid */
+        picotrns_resetTransCache(spho->trnsCache);
+    }
+#endif
+
     spho->numFsts = 0;
 
     spho->curFst = 0;
@@ -350,6 +361,9 @@ static pico_status_t sphoSubObjDeallocate(register picodata_ProcessingUnit this,
         if (NULL != this->subObj) {
             spho = (spho_subobj_t *) (this->subObj);
             picotrns_deallocate_alt_desc_buf(spho->common->mm,&spho->altDescBuf);
+#if (PICOTRNS_CACHE_SIZE > 0)
+            picotrns_disposeTransCache(spho->common->mm,&spho->trnsCache);
+#endif
             picoos_deallocate(mm, (void *) &this->subObj);
         }
     }
@@ -391,6 +405,10 @@ picodata_ProcessingUnit picospho_newSentPhoUnit(picoos_MemoryManager mm,
         picoos_emRaiseException(spho->common->em,PICO_EXC_OUT_OF_MEM, NULL,NULL);
         return NULL;
     }
+#if (PICOTRNS_CACHE_SIZE > 0)
+    /* without cache, phrases are simply always transduced */
+    spho->trnsCache = picotrns_newTransCache(spho->common->mm);
+#endif
 
     sphoInitialize(this, PICO_RESET_FULL);
     return this;
@@ -1231,11 +1249,19 @@ static picodata_step_result_t sphoStep(register picodata_ProcessingUnit this,
                         PICODBG_INFO_MSG(("\n"));
                     }
 #endif
+#if (PICOTRNS_CACHE_SIZE > 0)
+                    rv = picotrns_cachedTransduce(spho->trnsCache, spho->fst[spho->curFst], FALSE,
+                    picotrns_printSolution, spho->phonBuf, spho->phonWritePos, spho->phonBufOut,
+                            &spho->phonWritePos,
+                            4*PICOTRNS_MAX_NUM_POSSYM, spho->altDescBuf,
+                            spho->maxAltDescLen, &nrSteps);
+#else
                     rv = picotrns_transduce(spho->fst[spho->curFst], FALSE,
                     picotrns_printSolution, spho->phonBuf, spho->phonWritePos, spho->phonBufOut,
                             &spho->phonWritePos,
                             4*PICOTRNS_MAX_NUM_POSSYM, spho->altDescBuf,
                             spho->maxAltDescLen, &nrSteps);
+#endif
                     if (PICO_OK == rv) {
 #if defined(PICO_DEBUG)
                     {
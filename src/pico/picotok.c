@@ -670,6 +670,24 @@ static void tok_checkRealLimits (picodata_ProcessingUnit this, picoos_single * v
 
 #define VAL_STR_LEN 21
 
+/* gets the FSTs mapping phoneme markup when first needed, so that with
+   PICOKNOW_LAZY_INIT they are only specialized if there is such markup */
+static void tok_getPhonemeFSTs (picodata_ProcessingUnit this, tok_subobj_t * tok)
+{
+    if (NULL == tok->xsampa_parser) {
+        tok->xsampa_parser = picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_XSAMPA_PARSE]);
+        PICODBG_TRACE(("got xsampa_parser @ %i",tok->xsampa_parser));
+    }
+    if (NULL == tok->svoxpa_parser) {
+        tok->svoxpa_parser = picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_SVOXPA_PARSE]);
+        PICODBG_TRACE(("got svoxpa_parser @ %i",tok->svoxpa_parser));
+    }
+    if (NULL == tok->xsampa2svoxpa_mapper) {
+        tok->xsampa2svoxpa_mapper = picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_XSAMPA2SVOXPA]);
+        PICODBG_TRACE(("got xsampa2svoxpa_mapper @ %i",tok->xsampa2svoxpa_mapper));
+    }
+}
+
 static void tok_interpretMarkup (picodata_ProcessingUnit this, tok_subobj_t * tok, picoos_bool isStartTag, MarkupId mId)
 {
     picoos_bool done;
@@ -929,6 +947,7 @@ static void tok_interpretMarkup (picodata_ProcessingUnit this, tok_subobj_t * to
                         && tok_strEqual(tok->markupParams[2].paramVal, KWIgnorePunct)) {
                         i2 = 1;
                     }
+                    tok_getPhonemeFSTs(this, tok);
                     if (picodata_mapPAStrToPAIds(tok->transducer, this->common, tok->xsampa_parser, tok->svoxpa_parser, tok->xsampa2svoxpa_mapper, tok->markupParams[1].paramVal, tok->markupParams[0].paramVal, tok->phonemes, sizeof(tok->phonemes)-1) == PICO_OK) {
                         tok_putItem(this, tok, PICODATA_ITEM_CMD, PICODATA_ITEMINFO1_CMD_PHONEME,
                             PICODATA_ITEMINFO2_CMD_START, i2, tok->phonemes);
@@ -943,6 +962,7 @@ static void tok_interpretMarkup (picodata_ProcessingUnit this, tok_subobj_t * to
                         && tok_strEqual(tok->markupParams[1].paramVal, KWIgnorePunct)) {
                         i2 = 1;
                     }
+                    tok_getPhonemeFSTs(this, tok);
                     if (picodata_mapPAStrToPAIds(tok->transducer, this->common, tok->xsampa_parser, tok->svoxpa_parser, tok->xsampa2svoxpa_mapper, tok->markupParams[0].paramVal, PICODATA_XSAMPA, tok->phonemes, sizeof(tok->phonemes)) == PICO_OK) {
                         tok_putItem(this, tok, PICODATA_ITEM_CMD, PICODATA_ITEMINFO1_CMD_PHONEME,
                             PICODATA_ITEMINFO2_CMD_START, i2, tok->phonemes);
@@ -1301,6 +1321,7 @@ static void tok_treatChar (picodata_ProcessingUnit this, tok_subobj_t * tok, pic
 {
     picoos_int32 i, id;
     picoos_uint8 uval8;
+    const picoktab_graphprops_t * props;
     pico_tokenType type = PICODATA_ITEMINFO1_TOKTYPE_UNDEFINED;
     pico_tokenSubType subtype = -1;
     picoos_bool dummy;
@@ -1321,8 +1342,24 @@ static void tok_treatChar (picodata_ProcessingUnit this, tok_subobj_t * tok, pic
             break;
         case UTF_CHAR_COMPLETE:
             markupHandling = (markupHandling && (tok->markupHandlingMode == MARKUP_HANDLING_ENABLED));
-            id = picoktab_graphOffset(tok->graphTab, tok->utf);
-            if (id > 0) {
+            props = picoktab_getGraphProps(tok->graphTab, tok->utf);
+            if (NULL != props) {
+                /* cached graph, properties already decoded */
+                if (props->graphsOffset > 0) {
+                    if (props->hasTokenType) {
+                        type = (pico_tokenType)props->tokenType;
+                        if (type == PICODATA_ITEMINFO1_TOKTYPE_LETTERV) {
+                            type = PICODATA_ITEMINFO1_TOKTYPE_LETTER;
+                        }
+                    }
+                    if (props->hasTokenSubType) {
+                        subtype = props->tokenSubType;
+                    }
+                } else if (tok->utf[tok->utfpos-1] <= (picoos_uchar)' ') {
+                    type = PICODATA_ITEMINFO1_TOKTYPE_SPACE;
+                    subtype =  -1;
+                }
+            } else if ((id = picoktab_graphOffset(tok->graphTab, tok->utf)) > 0) {
                 if (picoktab_getIntPropTokenType(tok->graphTab, id, &uval8)) {
                     type = (pico_tokenType)uval8;
                     if (type == PICODATA_ITEMINFO1_TOKTYPE_LETTERV) {
@@ -1449,14 +1486,10 @@ static pico_status_t tokReset(register picodata_ProcessingUnit this, picoos_int3
 
     tok->graphTab = picoktab_getGraphs(this->voice->kbArray[PICOKNOW_KBID_TAB_GRAPHS]);
 
-    tok->xsampa_parser = picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_XSAMPA_PARSE]);
-    PICODBG_TRACE(("got xsampa_parser @ %i",tok->xsampa_parser));
-
-    tok->svoxpa_parser = picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_SVOXPA_PARSE]);
-    PICODBG_TRACE(("got svoxpa_parser @ %i",tok->svoxpa_parser));
-
-    tok->xsampa2svoxpa_mapper = picokfst_getFST(this->voice->kbArray[PICOKNOW_KBID_FST_XSAMPA2SVOXPA]);
-    PICODBG_TRACE(("got xsampa2svoxpa_mapper @ %i",tok->xsampa2svoxpa_mapper));
+    /* see tok_getPhonemeFSTs */
+    tok->xsampa_parser = NULL;
+    tok->svoxpa_parser = NULL;
+    tok->xsampa2svoxpa_mapper = NULL;
 
 
 
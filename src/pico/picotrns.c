@@ -595,6 +595,202 @@ pico_status_t picotrns_transduce (picokfst_FST fst, picoos_bool firstSolOnly,
 }
 
 
+#if (PICOTRNS_CACHE_SIZE > 0)
+
+/* ************** transduction cache ***************/
+
+/* transduction output of one input sequence, see picotrns_cachedTransduce */
+typedef struct {
+    picoos_uint32 lastUse;  /* 0 if unused */
+    picokfst_FST fst;
+    picoos_uint8 firstSolOnly;
+    picoos_uint8 inLen;
+    picoos_uint8 outLen;
+    picoos_int16 inSym[PICOTRNS_CACHE_MAXIN];
+    picoos_int16 outSym[PICOTRNS_CACHE_MAXOUT];
+    picoos_int8 outRef[PICOTRNS_CACHE_MAXOUT]; /* index into input, or -1 if inserted */
+} picotrns_trans_cache_entry_t;
+
+typedef struct picotrns_trans_cache {
+    picotrns_trans_cache_entry_t entry[PICOTRNS_CACHE_SIZE];
+    picoos_uint32 clock;
+    picoos_uint32 hits;
+    picoos_uint32 misses;
+    picoos_uint32 bypassed;   /* input too long to be cached */
+    /* input copy with positions replaced by indices */
+    picotrns_possym_t inSeq[PICOTRNS_CACHE_MAXIN];
+} picotrns_trans_cache_t;
+
+
+picotrns_TransCache picotrns_newTransCache(picoos_MemoryManager mm)
+{
+    picotrns_TransCache this;
+
+    this = (picotrns_TransCache) picoos_allocate(mm, sizeof(picotrns_trans_cache_t));
+    if (NULL == this) {
+        PICODBG_WARN(("no memory for transduction cache"));
+        return NULL;
+    }
+    this->hits = 0;
+    this->misses = 0;
+    this->bypassed = 0;
+    picotrns_resetTransCache(this);
+    return this;
+}
+
+
+void picotrns_disposeTransCache(picoos_MemoryManager mm, picotrns_TransCache * this)
+{
+    if (NULL != (*this)) {
+        PICODBG_INFO(("transduction cache hits: %d, misses: %d, bypassed: %d",
+                      (*this)->hits, (*this)->misses, (*this)->bypassed));
+        picoos_deallocate(mm, (void *) this);
+    }
+}
+
+
+void picotrns_resetTransCache(picotrns_TransCache this)
+{
+    picoos_uint16 i;
+
+    if (NULL == this) {
+        return;
+    }
+    PICODBG_INFO(("transduction cache hits: %d, misses: %d, bypassed: %d",
+                  this->hits, this->misses, this->bypassed));
+    for (i = 0; i < PICOTRNS_CACHE_SIZE; i++) {
+        this->entry[i].lastUse = 0;
+    }
+    this->clock = 0;
+    this->hits = 0;
+    this->misses = 0;
+    this->bypassed = 0;
+}
+
+
+/* returns the cache entry for 'inSeq' transduced with 'fst', NULL if none */
+static picotrns_trans_cache_entry_t * tcLookup(picotrns_TransCache this,
+        picokfst_FST fst, picoos_bool firstSolOnly,
+        const picotrns_possym_t inSeq[], picoos_uint16 inSeqLen)
+{
+    picoos_uint16 i, j;
+    picotrns_trans_cache_entry_t * e;
+
+    for (i = 0; i < PICOTRNS_CACHE_SIZE; i++) {
+        e = &(this->entry[i]);
+        if ((e->lastUse > 0) && (e->inLen == inSeqLen) && (e->fst == fst)
+            && (e->firstSolOnly == firstSolOnly)) {
+            j = 0;
+            while ((j < inSeqLen) && (e->inSym[j] == inSeq[j].sym)) {
+                j++;
+            }
+            if (j == inSeqLen) {
+                e->lastUse = ++this->clock;
+                return e;
+            }
+        }
+    }
+    return NULL;
+}
+
+
+/* stores the transduction output 'outSeq' (positions are input indices),
+   replacing the least recently used entry */
+static void tcStore(picotrns_TransCache this,
+        picokfst_FST fst, picoos_bool firstSolOnly,
+        const picotrns_possym_t inSeq[], picoos_uint16 inSeqLen,
+        const picotrns_possym_t outSeq[], picoos_uint16 outSeqLen)
+{
+    picoos_uint16 i;
+    picotrns_trans_cache_entry_t * e;
+
+    if (outSeqLen > PICOTRNS_CACHE_MAXOUT) {
+        return;
+    }
+    if (this->clock == (picoos_uint32)-1) {
+        /* restart use counts instead of wrapping around */
+        picotrns_resetTransCache(this);
+    }
+    e = &(this->entry[0]);
+    for (i = 1; i < PICOTRNS_CACHE_SIZE; i++) {
+        if (this->entry[i].lastUse < e->lastUse) {
+            e = &(this->entry[i]);
+        }
+    }
+    e->lastUse = ++this->clock;
+    e->fst = fst;
+    e->firstSolOnly = firstSolOnly;
+    e->inLen = (picoos_uint8)inSeqLen;
+    e->outLen = (picoos_uint8)outSeqLen;
+    for (i = 0; i < inSeqLen; i++) {
+        e->inSym[i] = inSeq[i].sym;
+    }
+    for (i = 0; i < outSeqLen; i++) {
+        e->outSym[i] = outSeq[i].sym;
+        e->outRef[i] = (picoos_int8)outSeq[i].pos;
+    }
+}
+
+
+/* see description in header */
+pico_status_t picotrns_cachedTransduce(picotrns_TransCache cache,
+                                       picokfst_FST fst, picoos_bool firstSolOnly,
+                                       picotrns_printSolutionFct printSolution,
+                                       const picotrns_possym_t inSeq[], picoos_uint16 inSeqLen,
+                                       picotrns_possym_t outSeq[], picoos_uint16 * outSeqLen, picoos_uint16 maxOutSeqLen,
+                                       picotrns_AltDesc altDescBuf, picoos_uint16 maxAltDescLen,
+                                       picoos_uint32 *nrSteps)
+{
+    picoos_uint16 i;
+    picoos_uint16 len;
+    pico_status_t status;
+    picotrns_trans_cache_entry_t * e;
+
+    if ((NULL == cache) || (inSeqLen > PICOTRNS_CACHE_MAXIN)) {
+        if (NULL != cache) {
+            cache->bypassed++;
+        }
+        return picotrns_transduce(fst, firstSolOnly, printSolution, inSeq, inSeqLen,
+                                  outSeq, outSeqLen, maxOutSeqLen,
+                                  altDescBuf, maxAltDescLen, nrSteps);
+    }
+    e = tcLookup(cache, fst, firstSolOnly, inSeq, inSeqLen);
+    if (NULL != e) {
+        cache->hits++;
+        len = (e->outLen < maxOutSeqLen) ? e->outLen : maxOutSeqLen;
+        for (i = 0; i < len; i++) {
+            outSeq[i].sym = e->outSym[i];
+            outSeq[i].pos = (e->outRef[i] >= 0) ? inSeq[e->outRef[i]].pos : PICOTRNS_POS_INSERT;
+        }
+        (*outSeqLen) = len;
+        (*nrSteps) = 0;
+        return PICO_OK;
+    }
+    cache->misses++;
+
+    /* transduce with input indices as positions; output positions are
+       then either input indices or PICOTRNS_POS_INSERT */
+    for (i = 0; i < inSeqLen; i++) {
+        cache->inSeq[i].sym = inSeq[i].sym;
+        cache->inSeq[i].pos = i;
+    }
+    status = picotrns_transduce(fst, firstSolOnly, printSolution, cache->inSeq, inSeqLen,
+                                outSeq, outSeqLen, maxOutSeqLen,
+                                altDescBuf, maxAltDescLen, nrSteps);
+    if (PICO_OK == status) {
+        tcStore(cache, fst, firstSolOnly, cache->inSeq, inSeqLen, outSeq, (*outSeqLen));
+    }
+    for (i = 0; i < (*outSeqLen); i++) {
+        if (outSeq[i].pos >= 0) {
+            outSeq[i].pos = inSeq[outSeq[i].pos].pos;
+        }
+    }
+    return status;
+}
+
+#endif
+
+
 /**
  * Data structure for picotrns_SimpleTransducer object.
  */
@@ -738,6 +934,29 @@ pico_status_t picotrns_stGetSymSequence(
     }
 }
 
+pico_status_t picotrns_stGetSymSequenceOfPlane(
+        picotrns_SimpleTransducer this,
+        picoos_uint8 plane,
+        picoos_uint8 * outputSymIds,
+        picoos_uint32 maxOutputSymIds)
+{
+    picoos_uint8 symPlane, sym;
+    picoos_uint32 outputCount = 0;
+    while ((this->possymReadPos < this->possymWritePos) && (outputCount < maxOutputSymIds)) {
+        sym = picotrns_unplane(this->possymBuf[this->possymReadPos++].sym, &symPlane);
+        if (symPlane == plane) {
+            *outputSymIds++ = sym;
+            outputCount++;
+        }
+    }
+    *outputSymIds = NULLC;
+    if (this->possymReadPos >= this->possymWritePos) {
+        return PICO_OK;
+    } else {
+        return PICO_EXC_BUF_OVERFLOW;
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -138,6 +138,63 @@ extern pico_status_t picotrns_transduce (picokfst_FST fst, picoos_bool firstSolO
                                          picoos_uint32 *nrSteps);
 
 
+/* nr of input sequences per processing unit (sa, spho) whose transduction
+   result is kept, least recently used first replaced; 0 disables the cache.
+   Each cache takes about 230 bytes per entry from the engine memory */
+#if !defined(PICOTRNS_CACHE_SIZE)
+#define PICOTRNS_CACHE_SIZE 0
+#endif
+/* longest input and output sequence kept in the cache; longer input
+   sequences are always transduced */
+#if !defined(PICOTRNS_CACHE_MAXIN)
+#define PICOTRNS_CACHE_MAXIN  32
+#endif
+#if !defined(PICOTRNS_CACHE_MAXOUT)
+#define PICOTRNS_CACHE_MAXOUT 48
+#endif
+/* engine memory taken by the caches of sa and spho (an upper bound), see
+   PICOCTRL_DEFAULT_ENGINE_SIZE */
+#if (PICOTRNS_CACHE_SIZE > 0)
+#define PICOTRNS_CACHE_ENGINE_SIZE (2 * (PICOTRNS_CACHE_SIZE * (16 + \
+        2 * PICOTRNS_CACHE_MAXIN + 3 * PICOTRNS_CACHE_MAXOUT) \
+        + 4 * PICOTRNS_CACHE_MAXIN + 64))
+#else
+#define PICOTRNS_CACHE_ENGINE_SIZE 0
+#endif
+
+#if (PICOTRNS_CACHE_SIZE > 0)
+
+/**  object   : TransCache
+ *   shortcut : tc
+ *
+ * maps FST and input symbol sequence to the transduction output; a cache
+ * must always be used with the same 'maxOutSeqLen' and 'maxAltDescLen'
+ */
+typedef struct picotrns_trans_cache * picotrns_TransCache;
+
+picotrns_TransCache picotrns_newTransCache(picoos_MemoryManager mm);
+
+void picotrns_disposeTransCache(picoos_MemoryManager mm, picotrns_TransCache * this);
+
+/* reports the cache statistics (PICODBG_INFO) and empties the cache;
+   to be called whenever the FSTs are fetched anew */
+void picotrns_resetTransCache(picotrns_TransCache this);
+
+/* like picotrns_transduce, but returns the output of an earlier
+   transduction of the same symbol sequence with the same FST, if still
+   in 'cache'; output positions refer to 'inSeq' as usual. With 'cache'
+   NULL, simply calls picotrns_transduce. On a cache hit, 'printSolution'
+   is not called and '*nrSteps' is 0 */
+pico_status_t picotrns_cachedTransduce(picotrns_TransCache cache,
+                                       picokfst_FST fst, picoos_bool firstSolOnly,
+                                       picotrns_printSolutionFct printSolution,
+                                       const picotrns_possym_t inSeq[], picoos_uint16 inSeqLen,
+                                       picotrns_possym_t outSeq[], picoos_uint16 * outSeqLen, picoos_uint16 maxOutSeqLen,
+                                       picotrns_AltDesc altDescBuf, picoos_uint16 maxAltDescLen,
+                                       picoos_uint32 *nrSteps);
+#endif
+
+
 
 /* transduce 'inSeq' into 'outSeq' 'inSeq' has to be terminated with the id for symbol '#'. 'outSeq' is terminated in the same way. */
 /*
@@ -180,6 +237,13 @@ pico_status_t picotrns_stGetSymSequence(
         picoos_uint8 * outputSymIds,
         picoos_uint32 maxOutputSymIds);
 
+/* like picotrns_stGetSymSequence, but only symbols of 'plane' are returned */
+pico_status_t picotrns_stGetSymSequenceOfPlane(
+        picotrns_SimpleTransducer this,
+        picoos_uint8 plane,
+        picoos_uint8 * outputSymIds,
+        picoos_uint32 maxOutputSymIds);
+
 
 
 
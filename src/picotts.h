@@ -10,8 +10,48 @@ extern "C" {
 
 #define CONFIG_PICOTTS_TA_PARTITION "picotts_ta"
 #define CONFIG_PICOTTS_SG_PARTITION "picotts_sg"
+#define CONFIG_PICOTTS_PROMPT_PARTITION "picotts_pp"
 #define CONFIG_PICOTTS_INPUT_QUEUE_SIZE 512
 
+/* Bytes of RAM used to keep the audio of recently spoken prompts (see
+ * picotts_say()), 0 to disable the prompt cache. Prompts longer than
+ * CONFIG_PICOTTS_PROMPT_MAX_LEN bytes of text are never cached. */
+#if !defined(CONFIG_PICOTTS_PROMPT_CACHE_SIZE)
+#define CONFIG_PICOTTS_PROMPT_CACHE_SIZE 0
+#endif
+#if !defined(CONFIG_PICOTTS_PROMPT_MAX_LEN)
+#define CONFIG_PICOTTS_PROMPT_MAX_LEN 128
+#endif
+
+/* Keeps a snapshot of the engine after its set up in the partition
+ * CONFIG_PICOTTS_SNAPSHOT_PARTITION and restores it in picotts_init(),
+ * which is much faster than setting the engine up (see
+ * src/picotts_snapshot.h). The first picotts_init() after flashing other
+ * firmware or resources makes the snapshot, and needs a second
+ * PICO_MEM_SIZE of RAM for that while it runs. Requires building with
+ * -DPICOOS_CLEAR_ALLOC. */
+#if !defined(CONFIG_PICOTTS_SNAPSHOT)
+#define CONFIG_PICOTTS_SNAPSHOT 0
+#endif
+#define CONFIG_PICOTTS_SNAPSHOT_PARTITION "picotts_ss"
+
+/* Partition holding the access profile read by picotts_prefetch(NULL), and
+ * the bytes of the resources it reads into the flash cache at most; more
+ * than the cache holds only pushes out what was read first. */
+#define CONFIG_PICOTTS_PROFILE_PARTITION "picotts_ap"
+#if !defined(CONFIG_PICOTTS_PREFETCH_SIZE)
+#define CONFIG_PICOTTS_PREFETCH_SIZE 32768
+#endif
+
+/* Sample rate of the audio passed to the output callback. Build with
+ * -DPICODSP_NARROWBAND to synthesise 8kHz (telephony) audio directly, at
+ * roughly half the signal generation cost. */
+#ifdef PICODSP_NARROWBAND
+#define PICOTTS_SAMPLE_RATE 8000
+#else
+#define PICOTTS_SAMPLE_RATE 16000
+#endif
+
 typedef void (*picotts_output_fn)(int16_t *samples, unsigned count);
 
 /**
@@ -42,6 +82,61 @@ bool picotts_init(unsigned prio, picotts_output_fn output_cb, int core);
  */
 void picotts_add(const char *txt, unsigned len);
 
+/**
+ * Speaks a complete prompt, such as "Battery low". Any text added before
+ * is finished first, then the prompt is spoken on its own.
+ *
+ * Prompts found in the prompt pack (see picotts_set_prompt_pack()) are
+ * played from there. Otherwise, with CONFIG_PICOTTS_PROMPT_CACHE_SIZE
+ * set, the audio of the prompt is
+ * kept in a least-recently-used cache, keyed on the text with runs of
+ * white space collapsed. Saying the same prompt again replays the audio
+ * through the output callback without running the synthesis. Pitch, speed
+ * and volume are set with markup in the text and hence are part of the
+ * key; prompts should not leave such markup open for later text.
+ *
+ * @param txt The pointer to the prompt, in UTF8 format. The text is
+ *   copied, so the pointer may be invalidated immediately upon return
+ *   from this call.
+ * @param len The number of bytes available in @c text.
+ */
+void picotts_say(const char *txt, unsigned len);
+
+/**
+ * Sets the prompt pack used by @c picotts_say(), as written by
+ * tools/picotts_promptpack.c. The pack is used in place and must stay
+ * valid until it is replaced, or until @c picotts_shutdown(). Replacing a
+ * pack waits for a prompt being played from the old one.
+ * @param pack The start of the pack, or NULL to stop using a pack.
+ * @returns True on success, false if the pack is invalid (any of its
+ *   entries reaches outside of it) or was rendered for a different sample
+ *   rate.
+ */
+bool picotts_set_prompt_pack(const void *pack);
+
+/**
+ * Maps a partition holding a prompt pack and uses it, as with
+ * @c picotts_set_prompt_pack(). The audio is then read straight from flash.
+ * @param partition The partition name, or NULL for
+ *   CONFIG_PICOTTS_PROMPT_PARTITION.
+ * @returns True on success, false on failure.
+ */
+bool picotts_map_prompt_pack(const char *partition);
+
+/**
+ * Reads the parts of the resources that speaking reads most into the flash
+ * cache, so that the first text after @c picotts_init() doesn't wait for
+ * them. The parts are listed in an access profile recorded with
+ * tools/picotts_profile.c from the same resource files, and only those
+ * read by the texts of the corpus are read here, as the engine is set up
+ * already. Call after @c picotts_init(), before speaking.
+ * @param profile The profile, or NULL to use the one in
+ *   CONFIG_PICOTTS_PROFILE_PARTITION.
+ * @returns True on success, false if there is no profile or it doesn't
+ *   list the resources in use.
+ */
+bool picotts_prefetch(const void *profile);
+
 void picotts_pause();
 void picotts_resume();
 
@@ -0,0 +1,76 @@
+#ifndef PICOTTS_PACK_H
+#define PICOTTS_PACK_H
+
+/* Layout of a prompt pack, as written by tools/picotts_promptpack.c and
+ * played by picotts_say(). All fields are little endian.
+ *
+ *   picotts_pack_header_t
+ *   picotts_pack_entry_t[count]      sorted by hash
+ *   texts and 16 bit PCM samples     samples aligned to 4 bytes
+ *
+ * The texts are the prompts as normalised by picotts_pack_key(), without
+ * terminating zero. The pack is used in place, e.g. from a partition
+ * mapped with esp_partition_mmap(). */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PICOTTS_PACK_MAGIC   0x4b505450u /* "PTPK" */
+#define PICOTTS_PACK_VERSION 1
+
+typedef struct
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t sample_rate;
+  uint32_t count;       /* number of entries */
+  uint32_t size;        /* bytes in the pack, including this header */
+} picotts_pack_header_t;
+
+typedef struct
+{
+  uint32_t hash;        /* picotts_pack_key() of the text */
+  uint32_t text;        /* offset of the text from the start of the pack */
+  uint32_t text_len;
+  uint32_t samples;     /* offset of the samples from the start of the pack */
+  uint32_t count;       /* number of samples */
+} picotts_pack_entry_t;
+
+
+/**
+ * Normalises a prompt in place, collapsing runs of white space into one
+ * space and dropping leading and trailing white space, and returns its
+ * hash (32 bit FNV-1a). Prompts are looked up by this key in both the
+ * prompt packs and the prompt cache.
+ * @param text The prompt, in UTF8 format.
+ * @param len In: the bytes in @c text. Out: the bytes after normalising.
+ */
+static inline uint32_t picotts_pack_key(uint8_t *text, unsigned *len)
+{
+  uint32_t hash = 2166136261u;
+  unsigned n = 0;
+  for (unsigned i = 0; i < *len; ++i)
+  {
+    bool space = (text[i] == ' ' || text[i] == '\t' || text[i] == '\r' ||
+                  text[i] == '\n');
+    if (!space)
+      text[n++] = text[i];
+    else if (n > 0 && text[n - 1] != ' ')
+      text[n++] = ' ';
+  }
+  if (n > 0 && text[n - 1] == ' ')
+    --n;
+  for (unsigned i = 0; i < n; ++i)
+    hash = (hash ^ text[i]) * 16777619u;
+  *len = n;
+  return hash;
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif
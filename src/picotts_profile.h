@@ -0,0 +1,112 @@
+#ifndef PICOTTS_PROFILE_H
+#define PICOTTS_PROFILE_H
+
+/* Layout of a resource access profile, as recorded by
+ * tools/picotts_profile.c and used by picotts_prefetch(). All fields are
+ * little endian.
+ *
+ *   picotts_profile_header_t
+ *   picotts_profile_resource_t[count]
+ *   picotts_profile_block_t[]        per resource, in order of first use
+ *
+ * A profile lists the blocks of each resource that were read while
+ * setting up the engine and speaking a corpus, in the order they were
+ * first read, and how many of the texts read each of them. Resources are
+ * told apart by picotts_profile_key() of their first bytes, which hold the
+ * name and version of the resource. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PICOTTS_PROFILE_MAGIC   0x50415450u /* "PTAP" */
+#define PICOTTS_PROFILE_VERSION 1
+
+// Bytes of a resource covered by picotts_profile_key()
+#define PICOTTS_PROFILE_KEY_SIZE 256
+
+typedef struct
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t block_shift; /* log2 of the block size, e.g. 12 for 4kB */
+  uint32_t count;       /* number of resources */
+  uint32_t texts;       /* number of texts spoken while recording */
+  uint32_t size;        /* bytes in the profile, including this header */
+} picotts_profile_header_t;
+
+typedef struct
+{
+  uint32_t key;         /* picotts_profile_key() of the resource */
+  uint32_t size;        /* bytes in the resource */
+  uint32_t blocks;      /* offset of its blocks from the start of the profile */
+  uint32_t count;       /* number of blocks */
+} picotts_profile_resource_t;
+
+typedef struct
+{
+  uint32_t block;       /* offset in the resource >> block_shift */
+  uint32_t hits;        /* texts reading the block; 0 if only the set up did */
+} picotts_profile_block_t;
+
+
+/**
+ * Returns the key identifying a resource in a profile (32 bit FNV-1a of
+ * its first PICOTTS_PROFILE_KEY_SIZE bytes).
+ */
+static inline uint32_t picotts_profile_key(const void *resource)
+{
+  const uint8_t *p = (const uint8_t *)resource;
+  uint32_t hash = 2166136261u;
+  for (unsigned i = 0; i < PICOTTS_PROFILE_KEY_SIZE; ++i)
+    hash = (hash ^ p[i]) * 16777619u;
+  return hash;
+}
+
+
+/**
+ * Finds the entry of a resource in a profile.
+ * @returns The entry, or NULL if the profile is invalid or doesn't list
+ *   the resource.
+ */
+static inline const picotts_profile_resource_t *picotts_profile_find(
+  const void *profile, const void *resource)
+{
+  const picotts_profile_header_t *hdr =
+    (const picotts_profile_header_t *)profile;
+  if (!hdr || hdr->magic != PICOTTS_PROFILE_MAGIC ||
+      hdr->version != PICOTTS_PROFILE_VERSION || hdr->block_shift >= 32 ||
+      hdr->size < sizeof(*hdr) ||
+      hdr->count > (hdr->size - sizeof(*hdr)) /
+        sizeof(picotts_profile_resource_t))
+    return NULL;
+  const picotts_profile_resource_t *res =
+    (const picotts_profile_resource_t *)(hdr + 1);
+  const uint32_t key = picotts_profile_key(resource);
+  for (uint32_t i = 0; i < hdr->count; ++i)
+  {
+    if (res[i].key != key)
+      continue;
+    if (res[i].blocks > hdr->size || res[i].count >
+        (hdr->size - res[i].blocks) / sizeof(picotts_profile_block_t))
+      return NULL;
+    return &res[i];
+  }
+  return NULL;
+}
+
+
+static inline const picotts_profile_block_t *picotts_profile_blocks(
+  const void *profile, const picotts_profile_resource_t *res)
+{
+  return (const picotts_profile_block_t *)
+    ((const uint8_t *)profile + res->blocks);
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif
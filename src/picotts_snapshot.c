@@ -0,0 +1,413 @@
+/* Snapshots of an initialized pico memory arena, see picotts_snapshot.h.
+ *
+ * A snapshot consists of the header, the relocations and the image of the
+ * arena, the latter two starting at a multiple of 8 bytes. A relocation is
+ * a 32 bit word, the offset of the word to relocate in units of 4 bytes
+ * shifted left by 2, or'ed with its kind. The image holds the parts of the
+ * arena that are not zero, each as its offset and size (32 bit words)
+ * followed by its data; the rest of the arena is zeroed on restore.
+ */
+#include "picotts_snapshot.h"
+#include <string.h>
+
+// Kinds of relocations
+#define RELOC_MEM    0  // pointer into the arena
+#define RELOC_REGION 1  // pointer into region (kind - RELOC_REGION)
+#define RELOC_MAGIC  3  // 32 bit word holding its own address xor a constant
+#define RELOC_KIND_MASK 3
+
+#define RELOC_BUF_SIZE 256
+
+// Zero bytes between two parts of the image that are kept in the image
+#define IMAGE_MAX_GAP 64
+
+typedef struct
+{
+  uint32_t magic;
+  uint16_t version;
+  uint8_t ptr_size;
+  uint8_t mem_align;        // arena address modulo PICOTTS_SNAPSHOT_MEM_ALIGN
+  uint32_t build;
+  uint32_t mem_size;
+  uint32_t image_size;      // bytes of the image, with the part headers
+  uint32_t num_parts;
+  uint32_t num_relocs;
+  uint32_t image_check;     // of the image data
+  uint32_t check;           // of the header (with check 0) and relocations
+  uint64_t mem_base;        // address of the arena the snapshot was made of
+  uint64_t region_base[PICOTTS_SNAPSHOT_MAX_REGIONS];
+  uint32_t region_size[PICOTTS_SNAPSHOT_MAX_REGIONS];  // 0 if unused
+  uint32_t region_check_size[PICOTTS_SNAPSHOT_MAX_REGIONS];
+  uint32_t region_check[PICOTTS_SNAPSHOT_MAX_REGIONS];  // of those bytes
+  uint32_t region_fixed;    // bit i set if region i can't be relocated
+  uint32_t root[PICOTTS_SNAPSHOT_MAX_ROOTS];  // offset in the arena + 1
+} snapshot_header_t;
+
+#define ALIGN8(n) (((n) + 7) & ~(size_t)7)
+#define RELOCS_OFFSET ALIGN8(sizeof(snapshot_header_t))
+
+
+static uint32_t fnv1a(uint32_t h, const void *data, size_t len)
+{
+  const uint8_t *p = data;
+  while (len--)
+    h = (h ^ *p++) * 0x01000193u;
+  return h;
+}
+#define FNV_INIT 0x811c9dc5u
+
+
+// The start of a region is checked, so that a snapshot is never restored
+// with other resources of the same size; the header there names them, and
+// checking all of them takes longer than the rest of the restore
+static uint32_t region_check(const void *region, size_t size)
+{
+  return fnv1a(FNV_INIT, region, size);
+}
+
+
+static uintptr_t load_ptr(const uint8_t *p)
+{
+  uintptr_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+
+static uint32_t load_u32(const uint8_t *p)
+{
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+
+typedef struct
+{
+  picotts_snapshot_write_fn write;
+  void *ctx;
+  size_t offset;
+  uint32_t check;
+  uint32_t count;
+  uint32_t buf[RELOC_BUF_SIZE];
+  unsigned used;
+} reloc_writer_t;
+
+
+static bool flush_relocs(reloc_writer_t *w)
+{
+  size_t len = w->used * sizeof(w->buf[0]);
+  w->check = fnv1a(w->check, w->buf, len);
+  if (w->write && !w->write(w->buf, len, w->offset, w->ctx))
+    return false;
+  w->offset += len;
+  w->used = 0;
+  return true;
+}
+
+
+static bool add_reloc(reloc_writer_t *w, size_t offset, unsigned kind)
+{
+  w->buf[w->used++] = (uint32_t)(offset >> 2) << 2 | kind;
+  w->count++;
+  return w->used < RELOC_BUF_SIZE || flush_relocs(w);
+}
+
+
+// Compares the arenas of both runs, passing the relocations to w.
+static int compare_arenas(
+  const picotts_snapshot_state_t *a, const picotts_snapshot_state_t *b,
+  reloc_writer_t *w)
+{
+  const uint8_t *pa = a->mem, *pb = b->mem;
+  const uintptr_t base_a = (uintptr_t)a->mem;
+  const uintptr_t mem_delta = (uintptr_t)b->mem - base_a;
+
+  for (size_t off = 0; off + 4 <= a->mem_size; off += 4)
+  {
+    if (off + sizeof(uintptr_t) <= a->mem_size)
+    {
+      uintptr_t va = load_ptr(pa + off), vb = load_ptr(pb + off);
+      if (va != vb)
+      {
+        int kind = -1;
+        if (vb - va == mem_delta && va - base_a <= a->mem_size)
+          kind = RELOC_MEM;
+        for (int i = 0; kind < 0 && i < PICOTTS_SNAPSHOT_MAX_REGIONS; ++i)
+        {
+          uintptr_t ra = (uintptr_t)a->region[i];
+          uintptr_t rb = (uintptr_t)b->region[i];
+          if (ra && ra != rb && vb - va == rb - ra &&
+              va - ra <= a->region_size[i])
+            kind = RELOC_REGION + i;
+        }
+        if (kind >= 0)
+        {
+          if (!add_reloc(w, off, kind))
+            return PICOTTS_SNAPSHOT_ERR_WRITE;
+          off += sizeof(uintptr_t) - 4;
+          continue;
+        }
+      }
+    }
+
+    uint32_t ua = load_u32(pa + off), ub = load_u32(pb + off);
+    if (ua != ub)
+    {
+      if ((ua ^ (uint32_t)(base_a + off)) !=
+          (ub ^ (uint32_t)((uintptr_t)b->mem + off)))
+        return PICOTTS_SNAPSHOT_ERR_DIFFER;
+      if (!add_reloc(w, off, RELOC_MAGIC))
+        return PICOTTS_SNAPSHOT_ERR_WRITE;
+    }
+  }
+  if (w->used && !flush_relocs(w))
+    return PICOTTS_SNAPSHOT_ERR_WRITE;
+  return PICOTTS_SNAPSHOT_OK;
+}
+
+
+// Writes the image of the arena at offset, filling in its size, number of
+// parts and check in hdr.
+static bool write_image(
+  const picotts_snapshot_state_t *a, snapshot_header_t *hdr, size_t offset,
+  picotts_snapshot_write_fn write, void *ctx)
+{
+  const uint8_t *mem = a->mem;
+  const size_t words = a->mem_size / 4;
+  size_t pos = offset;
+  uint32_t check = FNV_INIT;
+
+  for (size_t i = 0; i < words; )
+  {
+    if (!load_u32(mem + i * 4))
+    {
+      ++i;
+      continue;
+    }
+    // a part ends before a gap of more than IMAGE_MAX_GAP zero bytes
+    size_t end = i + 1, zeros = 0;
+    for (size_t j = end; j < words && zeros <= IMAGE_MAX_GAP / 4; ++j)
+    {
+      if (load_u32(mem + j * 4))
+      {
+        end = j + 1;
+        zeros = 0;
+      }
+      else
+        ++zeros;
+    }
+    const uint32_t part[2] = { i * 4, (end - i) * 4 };
+    check = fnv1a(check, part, sizeof(part));
+    check = fnv1a(check, mem + part[0], part[1]);
+    if (!write(part, sizeof(part), pos, ctx) ||
+        !write(mem + part[0], part[1], pos + sizeof(part), ctx))
+      return false;
+    pos += sizeof(part) + part[1];
+    hdr->num_parts++;
+    i = end;
+  }
+  hdr->image_size = pos - offset;
+  hdr->image_check = check;
+  return true;
+}
+
+
+static uint32_t header_check(const snapshot_header_t *hdr, uint32_t check)
+{
+  snapshot_header_t tmp = *hdr;
+  tmp.check = 0;
+  return fnv1a(check, &tmp, sizeof(tmp));
+}
+
+
+int picotts_snapshot_make(
+  picotts_snapshot_state_t *a, picotts_snapshot_state_t *b,
+  picotts_snapshot_setup_fn setup, void *setup_ctx, uint32_t build,
+  picotts_snapshot_write_fn write, void *write_ctx)
+{
+  const uintptr_t align = (uintptr_t)a->mem % PICOTTS_SNAPSHOT_MEM_ALIGN;
+  if (a->mem_size != b->mem_size || a->mem_size > UINT32_MAX ||
+      (uintptr_t)b->mem % PICOTTS_SNAPSHOT_MEM_ALIGN != align)
+    return PICOTTS_SNAPSHOT_ERR_MISMATCH;
+
+  picotts_snapshot_state_t *runs[2] = { a, b };
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    picotts_snapshot_state_t *s = runs[pass];
+    memset(s->mem, 0, s->mem_size);
+    memset(s->region, 0, sizeof(s->region));
+    memset(s->region_size, 0, sizeof(s->region_size));
+    memset(s->region_check_size, 0, sizeof(s->region_check_size));
+    memset(s->root, 0, sizeof(s->root));
+    if (!setup(s, pass, setup_ctx))
+      return PICOTTS_SNAPSHOT_ERR_SETUP;
+  }
+
+  snapshot_header_t hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.magic = PICOTTS_SNAPSHOT_MAGIC;
+  hdr.version = PICOTTS_SNAPSHOT_VERSION;
+  hdr.ptr_size = sizeof(uintptr_t);
+  hdr.mem_align = align;
+  hdr.build = build;
+  hdr.mem_size = a->mem_size;
+  hdr.mem_base = (uintptr_t)a->mem;
+  for (int i = 0; i < PICOTTS_SNAPSHOT_MAX_REGIONS; ++i)
+  {
+    if (!a->region[i])
+      continue;
+    if (a->region_size[i] != b->region_size[i] ||
+        a->region_size[i] > UINT32_MAX)
+      return PICOTTS_SNAPSHOT_ERR_MISMATCH;
+    hdr.region_base[i] = (uintptr_t)a->region[i];
+    hdr.region_size[i] = a->region_size[i];
+    size_t check_size = a->region_check_size[i];
+    if (CONFIG_PICOTTS_SNAPSHOT_CHECK_RESOURCES ||
+        !check_size || check_size > a->region_size[i])
+      check_size = a->region_size[i];
+    hdr.region_check_size[i] = check_size;
+    hdr.region_check[i] = region_check(a->region[i], check_size);
+    if (a->region[i] == b->region[i])
+      hdr.region_fixed |= 1u << i;
+  }
+  for (int i = 0; i < PICOTTS_SNAPSHOT_MAX_ROOTS; ++i)
+  {
+    uintptr_t off = (uintptr_t)a->root[i] - (uintptr_t)a->mem;
+    if (!a->root[i])
+      continue;
+    if (off >= a->mem_size ||
+        (uintptr_t)b->root[i] - (uintptr_t)b->mem != off)
+      return PICOTTS_SNAPSHOT_ERR_DIFFER;
+    hdr.root[i] = off + 1;
+  }
+
+  reloc_writer_t w;
+  memset(&w, 0, sizeof(w));
+  w.write = write;
+  w.ctx = write_ctx;
+  w.offset = RELOCS_OFFSET;
+  w.check = FNV_INIT;
+  int ret = compare_arenas(a, b, &w);
+  if (ret != PICOTTS_SNAPSHOT_OK)
+    return ret;
+  hdr.num_relocs = w.count;
+  if (!write_image(a, &hdr, ALIGN8(w.offset), write, write_ctx))
+    return PICOTTS_SNAPSHOT_ERR_WRITE;
+  hdr.check = header_check(&hdr, w.check);
+  if (!write(&hdr, sizeof(hdr), 0, write_ctx))
+    return PICOTTS_SNAPSHOT_ERR_WRITE;
+  return PICOTTS_SNAPSHOT_OK;
+}
+
+
+int picotts_snapshot_restore(
+  const void *snapshot, size_t size, uint32_t build,
+  picotts_snapshot_state_t *state)
+{
+  snapshot_header_t hdr;
+  if (!snapshot || size < RELOCS_OFFSET)
+    return PICOTTS_SNAPSHOT_ERR_INVALID;
+  memcpy(&hdr, snapshot, sizeof(hdr));
+  if (hdr.magic != PICOTTS_SNAPSHOT_MAGIC ||
+      hdr.version != PICOTTS_SNAPSHOT_VERSION ||
+      hdr.ptr_size != sizeof(uintptr_t))
+    return PICOTTS_SNAPSHOT_ERR_INVALID;
+
+  const uint8_t *snap = snapshot;
+  const size_t relocs_size = (size_t)hdr.num_relocs * 4;
+  const size_t image_offset = ALIGN8(RELOCS_OFFSET + relocs_size);
+  if (image_offset > size ||
+      size - image_offset < hdr.image_size ||
+      header_check(&hdr,
+        fnv1a(FNV_INIT, snap + RELOCS_OFFSET, relocs_size)) != hdr.check)
+    return PICOTTS_SNAPSHOT_ERR_INVALID;
+#if CONFIG_PICOTTS_SNAPSHOT_CHECK > 0
+  if (fnv1a(FNV_INIT, snap + image_offset, hdr.image_size) != hdr.image_check)
+    return PICOTTS_SNAPSHOT_ERR_INVALID;
+#endif
+
+  const uintptr_t new_base = (uintptr_t)state->mem;
+  const uintptr_t old_base = (uintptr_t)hdr.mem_base;
+  uintptr_t region_delta[PICOTTS_SNAPSHOT_MAX_REGIONS] = { 0 };
+  if (hdr.build != build || hdr.mem_size != state->mem_size ||
+      new_base % PICOTTS_SNAPSHOT_MEM_ALIGN != hdr.mem_align)
+    return PICOTTS_SNAPSHOT_ERR_MISMATCH;
+  for (int i = 0; i < PICOTTS_SNAPSHOT_MAX_REGIONS; ++i)
+  {
+    if (!hdr.region_size[i])
+      continue;
+    if (hdr.region_check_size[i] > hdr.region_size[i])
+      return PICOTTS_SNAPSHOT_ERR_INVALID;
+    if (!state->region[i] || state->region_size[i] != hdr.region_size[i] ||
+        region_check(state->region[i], hdr.region_check_size[i]) !=
+          hdr.region_check[i] ||
+        ((hdr.region_fixed & (1u << i)) &&
+         (uintptr_t)state->region[i] != hdr.region_base[i]))
+      return PICOTTS_SNAPSHOT_ERR_MISMATCH;
+    region_delta[i] =
+      (uintptr_t)state->region[i] - (uintptr_t)hdr.region_base[i];
+  }
+
+  const uint8_t *image = snap + image_offset;
+  size_t pos = 0;
+  for (uint32_t n = hdr.num_parts; n--; )
+  {
+    if (hdr.image_size - pos < 8)
+      return PICOTTS_SNAPSHOT_ERR_INVALID;
+    const uint32_t part_offset = load_u32(image + pos);
+    const uint32_t part_size = load_u32(image + pos + 4);
+    pos += 8;
+    if (part_offset > hdr.mem_size || hdr.mem_size - part_offset < part_size ||
+        hdr.image_size - pos < part_size)
+      return PICOTTS_SNAPSHOT_ERR_INVALID;
+    pos += part_size;
+  }
+
+  const uint8_t *reloc = snap + RELOCS_OFFSET;
+  for (uint32_t n = hdr.num_relocs; n--; reloc += 4)
+  {
+    const uint32_t r = load_u32(reloc);
+    const size_t off = (size_t)(r >> 2) << 2;
+    const unsigned kind = r & RELOC_KIND_MASK;
+    const size_t len = (kind == RELOC_MAGIC) ? 4 : sizeof(uintptr_t);
+    if (off > hdr.mem_size || hdr.mem_size - off < len ||
+        (kind != RELOC_MEM && kind != RELOC_MAGIC &&
+         !hdr.region_size[kind - RELOC_REGION]))
+      return PICOTTS_SNAPSHOT_ERR_INVALID;
+  }
+
+  uint8_t *mem = state->mem;
+  memset(mem, 0, hdr.mem_size);
+  for (uint32_t n = hdr.num_parts; n--; )
+  {
+    const uint32_t part_offset = load_u32(image);
+    const uint32_t part_size = load_u32(image + 4);
+    memcpy(mem + part_offset, image + 8, part_size);
+    image += 8 + part_size;
+  }
+
+  reloc = snap + RELOCS_OFFSET;
+  for (uint32_t n = hdr.num_relocs; n--; reloc += 4)
+  {
+    const uint32_t r = load_u32(reloc);
+    const size_t off = (size_t)(r >> 2) << 2;
+    const unsigned kind = r & RELOC_KIND_MASK;
+    if (kind == RELOC_MAGIC)
+    {
+      uint32_t v = load_u32(mem + off) ^
+        (uint32_t)(old_base + off) ^ (uint32_t)(new_base + off);
+      memcpy(mem + off, &v, sizeof(v));
+    }
+    else
+    {
+      uintptr_t v = load_ptr(mem + off) + (kind == RELOC_MEM ?
+        new_base - old_base : region_delta[kind - RELOC_REGION]);
+      memcpy(mem + off, &v, sizeof(v));
+    }
+  }
+
+  for (int i = 0; i < PICOTTS_SNAPSHOT_MAX_ROOTS; ++i)
+    state->root[i] = hdr.root[i] ? mem + hdr.root[i] - 1 : NULL;
+  return PICOTTS_SNAPSHOT_OK;
+}
@@ -0,0 +1,137 @@
+#ifndef PICOTTS_SNAPSHOT_H
+#define PICOTTS_SNAPSHOT_H
+
+/* Snapshots of an initialized pico memory arena.
+ *
+ * Setting up the engine (pico_initialize, loading the resources, creating
+ * the voice and pico_newEngine) only builds structures inside the arena,
+ * and does so the same way every time for the same resources and build. A
+ * snapshot keeps the arena after the set up; restoring it copies the arena
+ * back and relocates the pointers in it, which is much faster than the set
+ * up itself.
+ *
+ * The pointers are found by running the set up twice, in two zeroed arenas
+ * at different addresses, and comparing the results word by word: a word
+ * whose values differ by the distance between the arenas points into the
+ * arena; one differing by the distance between the two copies of a resource
+ * region points into that region; a 32 bit word holding its own address
+ * xor a constant is a handle's magic number. Any other difference makes
+ * the snapshot fail. Words that are equal in both runs are kept as they are,
+ * including pointers to code and constant data, which is why a snapshot is
+ * only valid for the build that made it; the caller passes an identifier of
+ * the build, checked on restore. A region at the same address in both runs
+ * can't be relocated and has to be at that address again on restore.
+ *
+ * Snapshots are in the byte order and pointer size of the machine, and
+ * need resources loaded from memory (esp_pico_loadResource), as opened
+ * files can't be restored. The pico sources have to be built with
+ * -DPICOOS_CLEAR_ALLOC, as otherwise memory reused inside the arena keeps
+ * parts of former pointers that can't be told apart from other data.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PICOTTS_SNAPSHOT_MAGIC   0x534e5350u  // "PSNS"
+#define PICOTTS_SNAPSHOT_VERSION 2
+
+// Resources the arena may point to, and handles kept in the snapshot
+#define PICOTTS_SNAPSHOT_MAX_REGIONS 2
+#define PICOTTS_SNAPSHOT_MAX_ROOTS   4
+
+// The arena has to be at the same address modulo this on restore
+#define PICOTTS_SNAPSHOT_MEM_ALIGN 16
+
+/* Checks the image data on restore as well, so that a damaged snapshot is
+ * made again rather than restored; the header, the relocations and the
+ * sizes and headers of the resources are always checked. Costs about as
+ * much time as copying the image; 0 leaves it out. */
+#if !defined(CONFIG_PICOTTS_SNAPSHOT_CHECK)
+#define CONFIG_PICOTTS_SNAPSHOT_CHECK 1
+#endif
+
+/* Makes snapshots that check all of each resource on restore, rather than
+ * the region_check_size bytes at its start; for debugging, as that takes
+ * several times as long as the rest of the restore. */
+#if !defined(CONFIG_PICOTTS_SNAPSHOT_CHECK_RESOURCES)
+#define CONFIG_PICOTTS_SNAPSHOT_CHECK_RESOURCES 0
+#endif
+
+typedef enum
+{
+  PICOTTS_SNAPSHOT_OK = 0,
+  PICOTTS_SNAPSHOT_ERR_SETUP = -1,     // the set up function failed
+  PICOTTS_SNAPSHOT_ERR_DIFFER = -2,    // the runs differ other than by address
+  PICOTTS_SNAPSHOT_ERR_WRITE = -3,     // the write function failed
+  PICOTTS_SNAPSHOT_ERR_INVALID = -4,   // not a snapshot, or a damaged one
+  PICOTTS_SNAPSHOT_ERR_MISMATCH = -5,  // made for another build or set up
+} picotts_snapshot_err_t;
+
+// The memory a set up runs in, and what it yields
+typedef struct
+{
+  void *mem;                 // the arena given to pico_initialize
+  size_t mem_size;
+  const void *region[PICOTTS_SNAPSHOT_MAX_REGIONS];  // resources, or NULL
+  size_t region_size[PICOTTS_SNAPSHOT_MAX_REGIONS];  // bytes of the resources
+  // bytes at the start of each resource checked on restore, e.g. its header
+  // naming it; 0 for all of it
+  size_t region_check_size[PICOTTS_SNAPSHOT_MAX_REGIONS];
+  void *root[PICOTTS_SNAPSHOT_MAX_ROOTS];  // handles in the arena, or NULL
+} picotts_snapshot_state_t;
+
+/**
+ * Sets up the engine in state->mem (which is zeroed), filling in the
+ * regions used and the handles to keep. Called twice by
+ * picotts_snapshot_make, with pass 0 and 1; the second run has to use
+ * copies of the resources at other addresses for them to be relocatable.
+ * @returns True on success.
+ */
+typedef bool (*picotts_snapshot_setup_fn)(
+  picotts_snapshot_state_t *state, int pass, void *ctx);
+
+/**
+ * Writes len bytes of the snapshot at offset. The header is written last,
+ * so that a snapshot left incomplete is never valid.
+ * @returns True on success.
+ */
+typedef bool (*picotts_snapshot_write_fn)(
+  const void *data, size_t len, size_t offset, void *ctx);
+
+/**
+ * Runs the set up in both arenas, which have to be of the same size and
+ * alignment, and writes the snapshot of the first one. The engine of the
+ * first run stays usable; the second arena may be freed afterwards.
+ * @param a The state of the first run; mem and mem_size are set by the
+ *   caller.
+ * @param b Likewise for the second run.
+ * @param build Identifies the build, e.g. a hash of the firmware.
+ * @returns PICOTTS_SNAPSHOT_OK or an error.
+ */
+int picotts_snapshot_make(
+  picotts_snapshot_state_t *a, picotts_snapshot_state_t *b,
+  picotts_snapshot_setup_fn setup, void *setup_ctx, uint32_t build,
+  picotts_snapshot_write_fn write, void *write_ctx);
+
+/**
+ * Restores a snapshot into state->mem, which has to be of the size and
+ * alignment of the arena it was made from, with the resources at
+ * state->region, of state->region_size bytes; the bytes of them checked
+ * are those the snapshot was made with. Fills in state->root with the
+ * handles.
+ * @returns PICOTTS_SNAPSHOT_OK or an error; state->mem is unchanged
+ *   unless the snapshot is valid for it.
+ */
+int picotts_snapshot_restore(
+  const void *snapshot, size_t size, uint32_t build,
+  picotts_snapshot_state_t *state);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
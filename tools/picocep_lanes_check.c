@@ -0,0 +1,165 @@
+/* Checks that the W'UW solver of picocep gives the same fixed point output
+ * when it smooths several cepstral dimensions in lock-step (lanes) as when
+ * it smooths them one at a time.
+ *
+ * The systems are made from the mgc and lfz pdfs of a signal generation
+ * resource, with random sequences of pdf vectors of random lengths, the
+ * way cep makes them for a phrase. Each is solved with every lane count
+ * from 2 to PICOCEP_SMOOTH_LANES, for every group of dimensions cep would
+ * solve together, and compared with the dimensions solved one lane each.
+ *
+ * picocep.c is included to reach its static functions, so it is left out
+ * of the other pico sources:
+ *   cc -O2 -Isrc/pico -DPICOCEP_SMOOTH_LANES=8 tools/picocep_lanes_check.c \
+ *      $(ls src/pico/pico*.c | grep -v picocep.c) -lm -lpthread \
+ *      -o picocep_lanes_check
+ *
+ * usage: picocep_lanes_check model/en-US_lh0_sg.bin [systems]
+ *
+ * Exits with 1 after printing the first system that differs.
+ */
+#include "picocep.c"
+#include "picoapi.h"
+#include "picorsrc.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MEM_SIZE 4000000
+
+static cep_subobj_t cep;
+static cep_smoothbuf_t sb;
+static picoos_uint16 indices[PICOCEP_MAXWINLEN];
+static picoos_int16 lanesOut[PICOCEP_MAXWINLEN * PICOKPDF_MAX_MUL_MGC_CEPORDER];
+static picoos_int16 scalarOut[PICOCEP_MAXWINLEN * PICOKPDF_MAX_MUL_MGC_CEPORDER];
+
+
+picoos_double picoos_quick_exp(const picoos_double y)
+{
+  return exp(y);
+}
+
+
+static picokpdf_PdfMUL find_pdf(pico_Resource res, picoknow_kb_id_t id)
+{
+  picoknow_KnowledgeBase kb = ((picorsrc_Resource)res)->kbList;
+  while (kb && kb->id != id)
+    kb = kb->next;
+  return kb ? picokpdf_getPdfMUL(kb) : NULL;
+}
+
+
+// Indices of a phrase of N frames: runs of a few frames on one vector, as
+// every state of a phone lasts several frames
+static void make_indices(picoos_uint16 N, picoos_uint16 numframes)
+{
+  picoos_uint16 i = 0;
+  while (i < N)
+  {
+    picoos_uint16 vec = rand() % numframes;
+    picoos_uint16 run = 1 + rand() % 6;
+    while (run-- && i < N)
+      indices[i++] = vec;
+  }
+}
+
+
+// Solves dimensions cepnum..cepnum+lanes-1 into out, as cep's smoothJob
+static void solve(picokpdf_PdfMUL pdf, picoos_uint16 N, picoos_uint8 cepnum,
+                  picoos_uint8 lanes, picoos_uint8 invpow,
+                  picoos_uint8 invDoubleDec, picoos_int16 *out)
+{
+  memset(&sb, 0x55, sizeof(sb));
+  makeWUWandWUm(&cep, &sb, pdf, indices, 0, N, cepnum, lanes);
+  invMatrix(&sb, N, out, cepnum, lanes, pdf, invpow, invDoubleDec);
+}
+
+
+// Compares lanes against single dimensions for all lane counts; returns
+// the number of dimensions compared, or -1 if one differs.
+static long check(picokpdf_PdfMUL pdf, picoos_uint16 N, picoos_uint8 invpow,
+                  picoos_uint8 invDoubleDec)
+{
+  const picoos_uint8 order = pdf->ceporder;
+  long compared = 0;
+
+  make_indices(N, pdf->numframes);
+  memset(scalarOut, 0, sizeof(scalarOut));
+  for (picoos_uint8 d = 0; d < order; ++d)
+    solve(pdf, N, d, 1, invpow, invDoubleDec, scalarOut);
+
+  for (picoos_uint8 lanes = 2; lanes <= PICOCEP_SMOOTH_LANES; ++lanes)
+  {
+    if ((picoos_uint32)N * lanes > PICOCEP_MAXWINLEN || lanes > order)
+      break;
+    memset(lanesOut, 0, sizeof(lanesOut));
+    for (picoos_uint8 cepnum = 0; cepnum < order; cepnum += lanes)
+    {
+      picoos_uint8 n = order - cepnum < lanes ? order - cepnum : lanes;
+      solve(pdf, N, cepnum, n, invpow, invDoubleDec, lanesOut);
+    }
+    for (picoos_uint32 i = 0; i < (picoos_uint32)N * order; ++i)
+    {
+      if (lanesOut[i] != scalarOut[i])
+      {
+        printf("differs: %u frames, %u lanes, frame %u dimension %u: "
+               "%d instead of %d\n", N, lanes, i / order, i % order,
+               lanesOut[i], scalarOut[i]);
+        return -1;
+      }
+    }
+    compared += order;
+  }
+  return compared;
+}
+
+
+int main(int argc, char **argv)
+{
+  if (argc != 2 && argc != 3)
+  {
+    fprintf(stderr, "usage: %s <sg.bin> [systems]\n", argv[0]);
+    return 2;
+  }
+  const int systems = argc > 2 ? atoi(argv[2]) : 500;
+
+  void *mem = malloc(MEM_SIZE);
+  pico_System sys;
+  pico_Resource res;
+  if (!mem || pico_initialize(mem, MEM_SIZE, &sys) ||
+      pico_loadResource(sys, (const pico_Char *)argv[1], &res))
+  {
+    fprintf(stderr, "%s: can't load\n", argv[1]);
+    return 1;
+  }
+  picokpdf_PdfMUL mgc = find_pdf(res, PICOKNOW_KBID_PDF_MGC);
+  picokpdf_PdfMUL lfz = find_pdf(res, PICOKNOW_KBID_PDF_LFZ);
+  if (!mgc || !lfz)
+  {
+    fprintf(stderr, "%s: no mgc or lfz pdf\n", argv[1]);
+    return 1;
+  }
+  initSmoothing(&cep);
+
+  long compared = 0;
+  srand(1);
+  for (int s = 0; s < systems; ++s)
+  {
+    // lengths from the shortest phrase solved by W'UW to ones that only
+    // fit one lane
+    picoos_uint16 N = 4 + rand() % (s % 10 ? PICOCEP_MAXWINLEN / 8 :
+                                             PICOCEP_MAXWINLEN - 4);
+    long n = check(mgc, N, PICOCEP_MGCINVPOW, PICOCEP_MGCDOUBLEDEC);
+    long m = n < 0 ? -1 : check(lfz, N, PICOCEP_LFZINVPOW,
+                                PICOCEP_LFZDOUBLEDEC);
+    if (n < 0 || m < 0)
+      return 1;
+    compared += n + m;
+  }
+  printf("%d systems, %ld dimensions solved in lanes, all identical\n",
+         systems, compared);
+  pico_unloadResource(sys, &res);
+  pico_terminate(&sys);
+  return 0;
+}
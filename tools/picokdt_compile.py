@@ -0,0 +1,308 @@
+#!/usr/bin/env python3
+"""Compile the decision trees of pico resource files into C.
+
+Reads the picokdt trees (POSP, POSD, G2P, PHR, ACC and the PAM trees)
+contained in one or more pico resource files and writes a C source file
+with one branch-coded classifier per tree and the table
+picokdt_compiledTrees that picokdt uses when built with
+-DPICOKDT_COMPILED.
+
+Each table entry records the kb id, size and checksum of the tree kb it
+was generated from. At load time picokdt only uses a compiled classifier
+if the loaded kb matches all three; any other tree (e.g. after updating
+the lingware) is interpreted as usual.
+
+usage: picokdt_compile.py [-o picokdt_compiled.c] [-t g2p,pam,...]
+                          model/en-US_ta.bin model/en-US_lh0_sg.bin
+
+Put the generated file next to the pico sources (src/pico) and build
+with -DPICOKDT_COMPILED.
+"""
+
+import argparse
+import struct
+import sys
+
+# picoknow_kb_id_t of the decision tree kbs and their picokdt_kdttype_t
+KBID_DT = {
+    10: ('posp', 'POSP'),
+    11: ('posd', 'POSD'),
+    12: ('g2p', 'G2P'),
+    18: ('phr', 'PHR'),
+    19: ('acc', 'ACC'),
+    34: ('pam', 'DUR'),
+    35: ('pam', 'LFZ1'),
+    36: ('pam', 'LFZ2'),
+    37: ('pam', 'LFZ3'),
+    38: ('pam', 'LFZ4'),
+    39: ('pam', 'LFZ5'),
+    40: ('pam', 'MGC1'),
+    41: ('pam', 'MGC2'),
+    42: ('pam', 'MGC3'),
+    43: ('pam', 'MGC4'),
+    44: ('pam', 'MGC5'),
+}
+
+# cf. picoos.c, picoos_SVOXFileHeader; stored with ' ' subtracted
+SVOX_HEADER = bytes(c - 0x20 for c in b' (C) SVOX AG ')
+MAX_FOREIGN_HEADER_LEN = 64
+
+# cf. picokdt.c
+NODE_TERMINAL, NODE_BINARY, NODE_CONTINUOUS, NODE_DISCRETE = range(4)
+SUB_ONEVALUE, SUB_TWOVALUES, SUB_WITHOUTBITMASK, SUB_BITMASK = range(4)
+Q_FORKCOUNT, Q_BITNO, Q_BITCOUNT, Q_JUMP, Q_CUT = range(5)
+NRQFIELDS = 5
+
+
+def fnv1a(data):
+    """picokdt kb checksum (32 bit FNV-1a), cf. kdtKbChecksum"""
+    h = 0x811C9DC5
+    for b in data:
+        h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def get_str(data, pos):
+    """cf. picoos_get_str"""
+    while data[pos] != 0 and data[pos] <= 0x20:
+        pos += 1
+    start = pos
+    while data[pos] != 0 and data[pos] > 0x20:
+        pos += 1
+    return data[start:pos].decode('latin-1'), pos
+
+
+def read_resource(path):
+    """returns (resource name, [(kbid, kb bytes)]) of a pico resource file,
+       cf. picorsrc_loadResource and picorsrc_getKbList"""
+    with open(path, 'rb') as f:
+        raw = f.read()
+    start = raw.find(SVOX_HEADER, 0, MAX_FOREIGN_HEADER_LEN + len(SVOX_HEADER))
+    if start < 0:
+        raise ValueError('%s: not a pico resource file' % path)
+    pos = start + len(SVOX_HEADER)
+    (hdrlen,) = struct.unpack_from('<H', raw, pos)
+    pos += 2
+    header = raw[pos:pos + hdrlen] + b'\0'
+    pos += hdrlen
+    name = ''
+    hpos = 1
+    for _ in range(header[0]):
+        key, hpos = get_str(header, hpos)
+        value, hpos = get_str(header, hpos)
+        if not name:
+            name = value    # PICOOS_HEADER_NAME is the first field
+    (datalen,) = struct.unpack_from('<I', raw, pos)
+    pos += 4
+    data = raw[pos:pos + datalen] + b'\0'
+
+    numkbs = data[0]
+    dpos = 1
+    for _ in range(numkbs):
+        _, dpos = get_str(data, dpos)
+    dpos += 1
+    kbs = []
+    for _ in range(numkbs):
+        kbid = data[dpos]
+        offset, size = struct.unpack_from('<II', data, dpos + 1)
+        dpos += 9
+        if offset:
+            kbs.append((kbid, data[offset:offset + size]))
+    return name, kbs
+
+
+class Tree(object):
+    """decision tree of a dt kb, cf. kdtDtInitialize"""
+
+    def __init__(self, kb):
+        _, _, treepos = struct.unpack_from('<HHH', kb, 0)
+        tree = kb[treepos:]
+        self.vquestion = tree[1]
+        self.vdecide = tree[2]
+        self.nratt = tree[3]
+        self.qfields = tree[5:5 + self.nratt * NRQFIELDS]
+        bodypos = 5 + self.nratt * NRQFIELDS
+        (size,) = struct.unpack_from('<I', tree, bodypos)
+        self.body = tree[bodypos + 4:bodypos + 4 + size]
+        self.nodes = self.decode()
+
+    def qfield(self, question, ind):
+        return self.qfields[question * NRQFIELDS + ind]
+
+    def bits(self, pos, n):
+        """n bits msb first at absolute bit position pos, cf. kdtGetShiftVal"""
+        val = 0
+        for i in range(n):
+            p = pos + i
+            val = (val << 1) | ((self.body[p >> 3] >> (7 - (p & 7))) & 1)
+        return val, pos + n
+
+    def decode(self):
+        """returns the nodes reachable from the root as dict
+           bitpos -> (type, question, cut, subsets, forks), reading them
+           like kdtAskTree does; forks are ('d', decision) or
+           ('n', bitpos of the child node)"""
+        nodes = {}
+        pending = [0]
+        while pending:
+            start = pending.pop()
+            if start in nodes:
+                continue
+            pos = start
+            if pos >= len(self.body) * 8:
+                raise ValueError('node outside of tree body')
+            ntype, pos = self.bits(pos, 2)
+            question, pos = self.bits(pos, self.vquestion)
+            cut = 0
+            subsets = []
+            nforks = 0
+            if question >= self.nratt or ntype == NODE_TERMINAL:
+                ntype = NODE_TERMINAL
+            elif ntype == NODE_BINARY:
+                nforks = 2
+            elif ntype == NODE_CONTINUOUS:
+                nforks = 2
+                cut, pos = self.bits(pos, self.qfield(question, Q_CUT))
+            else:
+                nforks, pos = self.bits(pos,
+                                        self.qfield(question, Q_FORKCOUNT))
+                for _ in range(nforks - 1):
+                    stype, pos = self.bits(pos, 2)
+                    lo, pos = self.bits(pos, self.qfield(question, Q_BITNO))
+                    hi, mask = lo, []
+                    if stype != SUB_ONEVALUE:
+                        val, pos = self.bits(pos,
+                                             self.qfield(question, Q_BITCOUNT))
+                        hi = val if stype == SUB_TWOVALUES else lo + val
+                        if stype == SUB_BITMASK:
+                            for _ in range(val):
+                                b, pos = self.bits(pos, 1)
+                                mask.append(b)
+                    subsets.append((stype, lo, hi, mask))
+            forks = []
+            for _ in range(nforks):
+                decide, pos = self.bits(pos, 1)
+                if decide:
+                    dec, pos = self.bits(pos, self.vdecide)
+                    forks.append(('d', dec))
+                else:
+                    jump, pos = self.bits(pos, self.qfield(question, Q_JUMP))
+                    forks.append(('n', pos + jump))
+                    pending.append(pos + jump)
+            nodes[start] = (ntype, question, cut, subsets, forks)
+        return nodes
+
+
+def emit_tree(out, fname, tree):
+    """writes the classifier fname for tree; it returns the decision for
+       invec, or -1 where kdtAskTree fails to find a solution"""
+    order = sorted(tree.nodes)
+    label = dict((pos, i) for i, pos in enumerate(order))
+    targets = set(f[1] for n in tree.nodes.values() for f in n[4]
+                  if f[0] == 'n')
+    masks = []
+
+    def fork(f):
+        if f[0] == 'd':
+            return 'return %d;' % f[1]
+        return 'goto n%d;' % label[f[1]]
+
+    body = []
+    for pos in order:
+        ntype, question, cut, subsets, forks = tree.nodes[pos]
+        if pos in targets:
+            body.append('n%d:' % label[pos])
+        if ntype == NODE_TERMINAL:
+            body.append('    return -1;')
+            continue
+        body.append('    v = invec[%d];' % question)
+        if ntype == NODE_BINARY:
+            body.append('    if (v == 0) %s' % fork(forks[0]))
+            body.append('    if (v == 1) %s' % fork(forks[1]))
+            body.append('    return -1;')
+        elif ntype == NODE_CONTINUOUS:
+            body.append('    if (v <= %d) %s' % (cut, fork(forks[0])))
+            body.append('    %s' % fork(forks[1]))
+        else:
+            for i, (stype, lo, hi, mask) in enumerate(subsets):
+                if stype == SUB_ONEVALUE:
+                    cond = 'v == %d' % lo
+                elif stype == SUB_TWOVALUES:
+                    cond = '(v == %d) || (v == %d)' % (lo, hi)
+                elif stype == SUB_WITHOUTBITMASK:
+                    cond = '(v >= %d) && (v < %d)' % (lo, hi)
+                elif len(mask) <= 32:
+                    bits = sum(b << k for k, b in enumerate(mask))
+                    cond = ('(v >= %d) && (v < %d) && ((0x%08xUL >> (v - %d)) & 1)'
+                            % (lo, hi, bits, lo))
+                else:
+                    ofs = len(masks)
+                    masks.extend(mask)
+                    cond = ('(v >= %d) && (v < %d) && '
+                            '((%s_mask[(v + %d) >> 3] >> ((v + %d) & 7)) & 1)'
+                            % (lo, hi, fname, ofs - lo, ofs - lo))
+                body.append('    if (%s) %s' % (cond, fork(forks[i])))
+            if forks:
+                body.append('    %s' % fork(forks[-1]))
+            else:
+                body.append('    return -1;')
+
+    if masks:
+        nbytes = (len(masks) + 7) // 8
+        vals = [sum(masks[i * 8 + k] << k for k in range(8)
+                    if i * 8 + k < len(masks)) for i in range(nbytes)]
+        out.write('static const picoos_uint8 %s_mask[%d] = {' % (fname, nbytes))
+        for i, v in enumerate(vals):
+            out.write('%s0x%02x,' % ('\n    ' if i % 12 == 0 else ' ', v))
+        out.write('\n};\n\n')
+    out.write('static picoos_int32 %s(const picoos_uint16 *invec) {\n' % fname)
+    out.write('    picoos_int32 v;\n\n')
+    out.write('\n'.join(body))
+    out.write('\n}\n\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='compile pico decision trees into C classifiers')
+    parser.add_argument('resources', nargs='+', help='pico resource files')
+    parser.add_argument('-o', '--output', default='picokdt_compiled.c',
+                        help='generated C file (default: %(default)s)')
+    parser.add_argument('-t', '--types',
+                        default='posp,posd,g2p,phr,acc,pam',
+                        help='tree types to compile (default: %(default)s)')
+    args = parser.parse_args()
+    types = set(args.types.split(','))
+
+    entries = []
+    with open(args.output, 'w') as out:
+        out.write('/* generated by tools/picokdt_compile.py from %s,\n'
+                  '   do not edit */\n\n'
+                  % ', '.join(args.resources))
+        out.write('#include "picoos.h"\n#include "picokdt.h"\n\n')
+        out.write('#if defined(PICOKDT_COMPILED)\n\n')
+        for path in args.resources:
+            name, kbs = read_resource(path)
+            for kbid, kb in kbs:
+                if kbid not in KBID_DT or KBID_DT[kbid][0] not in types:
+                    continue
+                tree = Tree(kb)
+                fname = 'kdtc_%s' % KBID_DT[kbid][1].lower()
+                out.write('/* %s: %s tree, kb id %d, %d nodes */\n'
+                          % (name, KBID_DT[kbid][1], kbid, len(tree.nodes)))
+                emit_tree(out, fname, tree)
+                entries.append((kbid, len(kb), fnv1a(kb), fname))
+                sys.stderr.write('%s: %s tree, %d nodes\n'
+                                 % (name, KBID_DT[kbid][1], len(tree.nodes)))
+        out.write('const picokdt_compiled_t picokdt_compiledTrees[] = {\n')
+        for kbid, size, checksum, fname in entries:
+            out.write('    { %d, %d, 0x%08xUL, %s },\n'
+                      % (kbid, size, checksum, fname))
+        if not entries:
+            out.write('    { 0, 0, 0, NULL }\n')
+        out.write('};\n\nconst picoos_uint16 picokdt_nrCompiledTrees = %d;\n'
+                  % len(entries))
+        out.write('\n#endif /* PICOKDT_COMPILED */\n')
+
+
+if __name__ == '__main__':
+    main()
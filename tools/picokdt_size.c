@@ -0,0 +1,100 @@
+/* Lists the decision trees of text analysis and signal generation resources
+ * with the bytes of their packed form and the RAM their expanded form takes
+ * with PICOKDT_DECODE (see src/pico/picokdt.h), e.g. to choose the trees to
+ * expand with PICOKDT_DECODE_TREES.
+ *
+ * build:
+ *   cc -O2 -DPICOKDT_DECODE -Isrc/pico tools/picokdt_size.c \
+ *      src/pico/pico*.c -lm -lpthread -o picokdt_size
+ *
+ * usage: picokdt_size model/en-US_ta.bin model/en-US_lh0_sg.bin
+ *
+ * Trees that could not be expanded, e.g. for lack of memory, are listed
+ * as packed.
+ */
+#include "picoapi.h"
+#include "picokdt.h"
+#include "picorsrc.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MEM_SIZE 8000000
+
+static const struct
+{
+  picoknow_kb_id_t id;
+  const char *name;
+} trees[] = {
+  { PICOKNOW_KBID_DT_POSP, "posp" }, { PICOKNOW_KBID_DT_POSD, "posd" },
+  { PICOKNOW_KBID_DT_G2P, "g2p" },   { PICOKNOW_KBID_DT_PHR, "phr" },
+  { PICOKNOW_KBID_DT_ACC, "acc" },   { PICOKNOW_KBID_DT_DUR, "dur" },
+  { PICOKNOW_KBID_DT_LFZ1, "lfz1" }, { PICOKNOW_KBID_DT_LFZ2, "lfz2" },
+  { PICOKNOW_KBID_DT_LFZ3, "lfz3" }, { PICOKNOW_KBID_DT_LFZ4, "lfz4" },
+  { PICOKNOW_KBID_DT_LFZ5, "lfz5" }, { PICOKNOW_KBID_DT_MGC1, "mgc1" },
+  { PICOKNOW_KBID_DT_MGC2, "mgc2" }, { PICOKNOW_KBID_DT_MGC3, "mgc3" },
+  { PICOKNOW_KBID_DT_MGC4, "mgc4" }, { PICOKNOW_KBID_DT_MGC5, "mgc5" },
+};
+
+
+picoos_double picoos_quick_exp(const picoos_double y)
+{
+  return exp(y);
+}
+
+
+static const char *tree_name(picoknow_kb_id_t id)
+{
+  for (size_t i = 0; i < sizeof(trees) / sizeof(trees[0]); ++i)
+    if (trees[i].id == id)
+      return trees[i].name;
+  return NULL;
+}
+
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    fprintf(stderr, "usage: %s <resource.bin>...\n", argv[0]);
+    return 2;
+  }
+
+  void *mem = malloc(MEM_SIZE);
+  pico_System sys;
+  if (!mem || pico_initialize(mem, MEM_SIZE, &sys))
+  {
+    fprintf(stderr, "can't initialize\n");
+    return 1;
+  }
+
+  unsigned long packed = 0, expanded = 0;
+  printf("%-6s %10s %10s\n", "tree", "packed", "expanded");
+  for (int a = 1; a < argc; ++a)
+  {
+    pico_Resource res;
+    if (pico_loadResource(sys, (const pico_Char *)argv[a], &res))
+    {
+      fprintf(stderr, "%s: can't load\n", argv[a]);
+      return 1;
+    }
+    for (picoknow_KnowledgeBase kb = ((picorsrc_Resource)res)->kbList; kb;
+         kb = kb->next)
+    {
+      const char *name = tree_name(kb->id);
+      if (!name)
+        continue;
+      picoos_uint32 size = picokdt_getDecodedSize(kb);
+      if (size)
+        printf("%-6s %10lu %10lu\n", name, (unsigned long)kb->size,
+               (unsigned long)size);
+      else
+        printf("%-6s %10lu %10s\n", name, (unsigned long)kb->size, "packed");
+      packed += kb->size;
+      expanded += size;
+    }
+  }
+  printf("%-6s %10lu %10lu\n", "total", packed, expanded);
+  pico_terminate(&sys);
+  return 0;
+}
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""Convert pico resource files into the native resource format.
+
+The native format (see src/pico/picorsrc.h) replaces the text header of a
+SVOX resource file by a binary header of fixed layout and the kb directory
+by fixed size entries, puts each kb at a multiple of 8 bytes and adds a
+checksum of the data. picorsrc_loadResource and esp_pico_loadResource
+recognise such files by their magic and load them without parsing the
+header; the kbs themselves are copied unchanged, so their tables are
+still derived at load, as for SVOX files. The loaders only test the
+checksum when built with -DPICORSRC_NATIVE_CHECK=1; use -i to test it
+before flashing.
+
+usage: picorsrc_native.py model/en-US_ta.bin en-US_ta.native.bin
+       picorsrc_native.py -i en-US_ta.native.bin
+
+The output file name has to end in .bin for pico_loadResource. Flash it
+to the resource partition in place of the SVOX file.
+"""
+
+import argparse
+import struct
+import sys
+
+# cf. picorsrc.h
+NATIVE_MAGIC = b'PICN'
+NATIVE_VERSION = 1
+NATIVE_HEADER_SIZE = 64
+KBENTRY_SIZE = 12
+MAX_RSRC_NAME_SIZ = 32
+ALIGN = 8
+
+# picorsrc_resource_type_t by content type, cf. picorsrc_loadResource
+RESOURCE_TYPES = {
+    'TEXTANA': 1,
+    'SIGGEN': 2,
+}
+TYPE_OTHER = 5
+
+# cf. picoos.c, picoos_SVOXFileHeader; stored with ' ' subtracted
+SVOX_HEADER = bytes(c - 0x20 for c in b' (C) SVOX AG ')
+MAX_FOREIGN_HEADER_LEN = 64
+
+# cf. picoos.h, picoos_header_field_t
+HEADER_NAME, HEADER_VERSION, HEADER_DATE, HEADER_TIME, \
+    HEADER_CONTENT_TYPE = range(5)
+
+
+def fnv1a(data):
+    """checksum of the data, cf. picorsrc_nativeChecksum"""
+    h = 0x811C9DC5
+    for b in data:
+        h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def get_str(data, pos):
+    """cf. picoos_get_str"""
+    while data[pos] != 0 and data[pos] <= 0x20:
+        pos += 1
+    start = pos
+    while data[pos] != 0 and data[pos] > 0x20:
+        pos += 1
+    return data[start:pos].decode('latin-1'), pos
+
+
+def read_resource(path):
+    """returns (header field values, [(kbid, kb bytes or None, size, file
+       position)]) of a SVOX resource file, cf. picorsrc_loadResource and
+       picorsrc_getKbList"""
+    with open(path, 'rb') as f:
+        raw = f.read()
+    start = raw.find(SVOX_HEADER, 0, MAX_FOREIGN_HEADER_LEN + len(SVOX_HEADER))
+    if start < 0:
+        raise ValueError('%s: not a SVOX resource file' % path)
+    pos = start + len(SVOX_HEADER)
+    (hdrlen,) = struct.unpack_from('<H', raw, pos)
+    pos += 2
+    header = raw[pos:pos + hdrlen] + b'\0'
+    pos += hdrlen
+    fields = []
+    hpos = 1
+    for _ in range(header[0]):
+        _, hpos = get_str(header, hpos)
+        value, hpos = get_str(header, hpos)
+        fields.append(value)
+    (datalen,) = struct.unpack_from('<I', raw, pos)
+    pos += 4
+    data = raw[pos:pos + datalen] + b'\0'
+    datapos = pos
+
+    numkbs = data[0]
+    dpos = 1
+    for _ in range(numkbs):
+        _, dpos = get_str(data, dpos)
+    dpos += 1
+    kbs = []
+    for _ in range(numkbs):
+        kbid = data[dpos]
+        offset, size = struct.unpack_from('<II', data, dpos + 1)
+        dpos += 9
+        if offset:
+            if offset + size > datalen:
+                raise ValueError('%s: kb %d outside of the data' % (path, kbid))
+            kbs.append((kbid, data[offset:offset + size], size,
+                        datapos + offset))
+        else:
+            kbs.append((kbid, None, size, None))
+    return fields, kbs
+
+
+def read_native(path):
+    """returns the same as read_resource for a native resource file"""
+    with open(path, 'rb') as f:
+        raw = f.read()
+    magic, _, numkbs, rtype, size, _, _ = \
+        struct.unpack_from('<4sHHIIII', raw, 0)
+    if magic != NATIVE_MAGIC:
+        raise ValueError('%s: not a native resource file' % path)
+    name = raw[24:24 + MAX_RSRC_NAME_SIZ].split(b'\0')[0].decode('latin-1')
+    ctype = [t for t, n in RESOURCE_TYPES.items() if n == rtype]
+    fields = [name, '', '', '', ctype[0] if ctype else '']
+    kbs = []
+    for i in range(numkbs):
+        kbid, offset, kbsize = struct.unpack_from(
+            '<III', raw, NATIVE_HEADER_SIZE + i * KBENTRY_SIZE)
+        if offset:
+            if offset + kbsize > size:
+                raise ValueError('%s: kb %d outside of the data'
+                                 % (path, kbid))
+            pos = NATIVE_HEADER_SIZE + offset
+            kbs.append((kbid, raw[pos:pos + kbsize], kbsize, pos))
+        else:
+            kbs.append((kbid, None, kbsize, None))
+    return fields, kbs
+
+
+def read_any(path):
+    """reads a resource file in either format"""
+    with open(path, 'rb') as f:
+        magic = f.read(len(NATIVE_MAGIC))
+    if magic == NATIVE_MAGIC:
+        return read_native(path)
+    return read_resource(path)
+
+
+def align(n):
+    return (n + ALIGN - 1) & ~(ALIGN - 1)
+
+
+def write_native(fields, kbs, path, order=None):
+    """writes the kbs as a native resource file, the data of the kbs in the
+       order of their indices in order if given; the directory always lists
+       them in their original order, which is the order they are loaded in"""
+    name = fields[HEADER_NAME].encode('latin-1')
+    if len(name) >= MAX_RSRC_NAME_SIZ:
+        raise ValueError('resource name %s too long' % fields[HEADER_NAME])
+    rtype = TYPE_OTHER
+    if len(fields) > HEADER_CONTENT_TYPE:
+        rtype = RESOURCE_TYPES.get(fields[HEADER_CONTENT_TYPE], TYPE_OTHER)
+
+    # the directory, then the kbs
+    if order is None:
+        order = range(len(kbs))
+    offset = align(len(kbs) * KBENTRY_SIZE)
+    offsets = [0] * len(kbs)
+    body = bytearray(offset - len(kbs) * KBENTRY_SIZE)
+    for i in order:
+        kb = kbs[i][1]
+        if kb is None:
+            continue
+        offsets[i] = offset
+        body += kb
+        body += bytes(align(len(kb)) - len(kb))
+        offset += align(len(kb))
+    directory = bytearray()
+    for i, (kbid, _, size, _) in enumerate(kbs):
+        directory += struct.pack('<III', kbid, offsets[i], size)
+    data = bytes(directory + body)
+
+    header = struct.pack('<4sHHIIII', NATIVE_MAGIC, NATIVE_VERSION, len(kbs),
+                         rtype, len(data), fnv1a(data), 0)
+    header += name + bytes(MAX_RSRC_NAME_SIZ - len(name))
+    header += bytes(NATIVE_HEADER_SIZE - len(header))
+    with open(path, 'wb') as f:
+        f.write(header)
+        f.write(data)
+    return len(header) + len(data)
+
+
+def info(path):
+    with open(path, 'rb') as f:
+        raw = f.read()
+    magic, version, numkbs, rtype, size, checksum, _ = \
+        struct.unpack_from('<4sHHIIII', raw, 0)
+    if magic != NATIVE_MAGIC:
+        raise ValueError('%s: not a native resource file' % path)
+    name = raw[24:24 + MAX_RSRC_NAME_SIZ].split(b'\0')[0].decode('latin-1')
+    data = raw[NATIVE_HEADER_SIZE:NATIVE_HEADER_SIZE + size]
+    ok = len(data) == size and fnv1a(data) == checksum
+    print('%s: %s, version %d, type %d, %d bytes, checksum %s'
+          % (path, name, version, rtype, size, 'ok' if ok else 'WRONG'))
+    for i in range(numkbs):
+        kbid, offset, kbsize = struct.unpack_from('<III', data,
+                                                  i * KBENTRY_SIZE)
+        print('  kb %3d at %8d, %8d bytes' % (kbid, offset, kbsize))
+    return 0 if ok else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='convert pico resource files into the native format')
+    parser.add_argument('-i', '--info', action='store_true',
+                        help='list the kbs of a native resource file')
+    parser.add_argument('files', nargs='+',
+                        help='SVOX resource file and output file')
+    args = parser.parse_args()
+    if args.info:
+        return max(info(path) for path in args.files)
+    if len(args.files) != 2:
+        parser.error('need the SVOX resource file and the output file')
+    fields, kbs = read_resource(args.files[0])
+    size = write_native(fields, kbs, args.files[1])
+    sys.stderr.write('%s: %d kbs, %d bytes\n'
+                     % (fields[HEADER_NAME], len(kbs), size))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Reorder the kbs of a pico resource file by an access profile.
+
+Reads an access profile recorded by tools/picotts_profile.c (see
+src/picotts_profile.h) and writes the resource in the native format (see
+picorsrc_native.py) with the kbs that the texts of the corpus read most,
+per byte, at the start of the data, then those only read while setting up
+the engine, then the rest. The kbs read by every text thus share as few
+pages of flash cache and memory as possible.
+
+Only the place of each kb in the file changes: the kbs are copied
+unchanged, so all offsets inside them stay valid for picokdt, picoklex and
+picokpdf, and the kb directory keeps its order, so the kbs are loaded as
+before. Speech from the reordered resource is the same to the bit.
+
+usage: picorsrc_reorder.py en-US.prof model/en-US_ta.bin en-US_ta.hot.bin
+       picorsrc_reorder.py -i en-US.prof model/en-US_ta.bin
+
+The profile has to be recorded with the same resource file, in either
+format. Record a new profile with the reordered file for picotts_prefetch().
+"""
+
+import argparse
+import struct
+import sys
+
+import picorsrc_native as native
+
+# cf. picotts_profile.h
+PROFILE_MAGIC = 0x50415450
+PROFILE_VERSION = 1
+PROFILE_KEY_SIZE = 256
+HEADER_FORMAT = '<IHHIII'
+RESOURCE_FORMAT = '<IIII'
+BLOCK_FORMAT = '<II'
+
+
+def read_profile(path, resource):
+    """returns (block size, texts, [(block, hits)] in order of first use) of
+       the resource in the profile"""
+    with open(path, 'rb') as f:
+        raw = f.read()
+    magic, version, shift, count, texts, size = \
+        struct.unpack_from(HEADER_FORMAT, raw, 0)
+    if magic != PROFILE_MAGIC or version != PROFILE_VERSION \
+            or size != len(raw):
+        raise ValueError('%s: not an access profile' % path)
+    key = native.fnv1a(resource[:PROFILE_KEY_SIZE])
+    pos = struct.calcsize(HEADER_FORMAT)
+    for _ in range(count):
+        rkey, _, blocks, nblocks = struct.unpack_from(RESOURCE_FORMAT, raw, pos)
+        pos += struct.calcsize(RESOURCE_FORMAT)
+        if rkey == key:
+            return 1 << shift, texts, [
+                struct.unpack_from(BLOCK_FORMAT, raw,
+                                   blocks + i * struct.calcsize(BLOCK_FORMAT))
+                for i in range(nblocks)]
+    raise ValueError('%s: the resource is not in the profile' % path)
+
+
+def heat(kbs, block_size, blocks):
+    """returns per kb (texts reading a byte on average, rank of first use or
+       None)"""
+    hits = [0] * len(kbs)
+    first = [None] * len(kbs)
+    for rank, (block, nhits) in enumerate(blocks):
+        start = block * block_size
+        end = start + block_size
+        for i, (_, kb, size, pos) in enumerate(kbs):
+            if kb is None or pos >= end or pos + size <= start:
+                continue
+            hits[i] += (min(end, pos + size) - max(start, pos)) * nhits
+            if first[i] is None:
+                first[i] = rank
+    return [(hits[i] / kbs[i][2] if kbs[i][2] else 0, first[i])
+            for i in range(len(kbs))]
+
+
+def hot_order(kbs, kbheat):
+    """the indices of the kbs in the order to write them"""
+    def key(i):
+        density, first = kbheat[i]
+        if density > 0:
+            return (0, -density, first)
+        if first is not None:
+            return (1, first, 0)
+        return (2, i, 0)
+    return sorted(range(len(kbs)), key=key)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='reorder the kbs of a pico resource file by an access '
+                    'profile')
+    parser.add_argument('-i', '--info', action='store_true',
+                        help='list the kbs with their use in the profile')
+    parser.add_argument('profile', help='access profile')
+    parser.add_argument('files', nargs='+',
+                        help='resource file and output file')
+    args = parser.parse_args()
+    if len(args.files) != (1 if args.info else 2):
+        parser.error('need the resource file' +
+                     ('' if args.info else ' and the output file'))
+
+    with open(args.files[0], 'rb') as f:
+        resource = f.read()
+    fields, kbs = native.read_any(args.files[0])
+    block_size, texts, blocks = read_profile(args.profile, resource)
+    kbheat = heat(kbs, block_size, blocks)
+    order = hot_order(kbs, kbheat)
+
+    if args.info:
+        print('%s: %d texts, %d blocks of %d bytes read'
+              % (fields[native.HEADER_NAME], texts, len(blocks), block_size))
+        for i in order:
+            kbid, _, size, _ = kbs[i]
+            density, first = kbheat[i]
+            print('  kb %3d, %8d bytes, %6.2f texts per byte, %s'
+                  % (kbid, size, density,
+                     'not read' if first is None else
+                     'first read %d.' % (first + 1)))
+        return 0
+
+    size = native.write_native(fields, kbs, args.files[1], order)
+    sys.stderr.write('%s: kbs %s, %d bytes\n'
+                     % (fields[native.HEADER_NAME],
+                        ' '.join(str(kbs[i][0]) for i in order), size))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
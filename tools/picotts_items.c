@@ -0,0 +1,212 @@
+/* Captures the items at the input of one processing unit of the pico engine
+ * while it speaks a text, and replays such a capture, e.g. to benchmark the
+ * units from there on with realistic input (see PICOCTRL_ITEM_CAPTURE in
+ * src/pico/picoctrl.h).
+ *
+ * build:
+ *   cc -O2 -DPICOCTRL_ITEM_CAPTURE -DIMPLEMENT_TIMER=1 -Isrc/pico \
+ *      tools/picotts_items.c src/pico/pico*.c -lm -lpthread -o picotts_items
+ *
+ * usage:
+ *   picotts_items model/en-US_ta.bin model/en-US_lh0_sg.bin \
+ *      capture spho text.txt text.pici
+ *   picotts_items model/en-US_ta.bin model/en-US_lh0_sg.bin \
+ *      replay text.pici 10
+ *
+ * The unit is one of pr, wa, sa, acph, spho, pam, cep, sig. Replay prints
+ * the time taken by each run; the samples produced go to out.raw if given
+ * as last argument.
+ */
+#include "picoapi.h"
+#include "picoctrl.h"
+#include "picoos.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MEM_SIZE     4000000
+#define MAX_TEXT_LEN 65536
+
+static pico_System   picoSystem;
+static pico_Engine   picoEngine;
+
+static const pico_Char voiceName[] = "ItemVoice";
+
+static const char *unitNames[] = {
+  "text", "tok", "pr", "wa", "sa", "acph", "spho", "pam", "cep", "sig"
+};
+
+
+picoos_double picoos_quick_exp(const picoos_double y)
+{
+  return exp(y);
+}
+
+
+static void fail(const char *what, int code)
+{
+  pico_Retstring msg;
+  msg[0] = 0;
+  if (picoSystem)
+    pico_getSystemStatusMessage(picoSystem, code, msg);
+  fprintf(stderr, "%s (%i): %s\n", what, code, msg);
+  exit(1);
+}
+
+
+// Gets all speech data the engine has, writing it to out unless NULL.
+static unsigned long drain(FILE *out)
+{
+  unsigned long samples = 0;
+  int status;
+  do {
+    int16_t outbuf[128];
+    pico_Int16 bytes = 0, type = 0;
+    status = pico_getData(picoEngine, outbuf, sizeof(outbuf), &bytes, &type);
+    if (bytes > 0)
+    {
+      samples += bytes / 2;
+      if (out)
+        fwrite(outbuf, 1, bytes, out);
+    }
+  } while (status == PICO_STEP_BUSY);
+  if (status != PICO_STEP_IDLE)
+    fail("Get data failed", status);
+  return samples;
+}
+
+
+static void init_engine(const char *ta, const char *sg)
+{
+  pico_Resource res;
+  pico_Retstring name;
+  const char *files[2] = { ta, sg };
+
+  void *mem = malloc(MEM_SIZE);
+  if (!mem)
+    fail("Out of memory", 0);
+  int ret = pico_initialize(mem, MEM_SIZE, &picoSystem);
+  if (ret)
+    fail("Init failed", ret);
+  ret = pico_createVoiceDefinition(picoSystem, voiceName);
+  if (ret)
+    fail("Voice creation failed", ret);
+  for (int i = 0; i < 2; ++i)
+  {
+    ret = pico_loadResource(picoSystem, (const pico_Char *)files[i], &res);
+    if (ret)
+      fail(files[i], ret);
+    ret = pico_getResourceName(picoSystem, res, name);
+    if (!ret)
+      ret = pico_addResourceToVoiceDefinition(
+        picoSystem, voiceName, (const pico_Char *)name);
+    if (ret)
+      fail(files[i], ret);
+  }
+  ret = pico_newEngine(picoSystem, voiceName, &picoEngine);
+  if (ret)
+    fail("Engine creation failed", ret);
+}
+
+
+static double ms_since(clock_t start)
+{
+  return (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+
+static int capture(const char *unit, const char *textFile, const char *out)
+{
+  int puType = -1;
+  for (int i = PICODATA_PUTYPE_PR; i <= PICODATA_PUTYPE_SIG; ++i)
+    if (strcmp(unit, unitNames[i]) == 0)
+      puType = i;
+  if (puType < 0)
+  {
+    fprintf(stderr, "unknown unit %s\n", unit);
+    return 2;
+  }
+
+  static char text[MAX_TEXT_LEN + 1];
+  FILE *in = fopen(textFile, "r");
+  if (!in)
+  {
+    perror(textFile);
+    return 1;
+  }
+  size_t len = fread(text, 1, MAX_TEXT_LEN, in);
+  fclose(in);
+  text[len++] = '\0';
+
+  int ret = picoctrl_engStartCapture((picoctrl_Engine)picoEngine, puType,
+                                     (picoos_char *)out);
+  if (ret)
+    fail("Capture failed", ret);
+  clock_t start = clock();
+  unsigned long samples = 0;
+  const pico_Char *p = (const pico_Char *)text;
+  while (len > 0)
+  {
+    pico_Int16 put = 0;
+    ret = pico_putTextUtf8(picoEngine, p, len > 32767 ? 32767 : len, &put);
+    if (ret)
+      fail("Put text failed", ret);
+    p += put;
+    len -= put;
+    samples += drain(NULL);
+  }
+  printf("%lu samples, %.2f ms\n", samples, ms_since(start));
+  picoctrl_engStopCapture((picoctrl_Engine)picoEngine);
+  return 0;
+}
+
+
+static int replay(const char *in, int runs, const char *rawFile)
+{
+  FILE *raw = NULL;
+  if (rawFile)
+  {
+    raw = fopen(rawFile, "wb");
+    if (!raw)
+    {
+      perror(rawFile);
+      return 1;
+    }
+  }
+  for (int i = 0; i < runs; ++i)
+  {
+    int ret = picoctrl_engReplay((picoctrl_Engine)picoEngine,
+                                 (picoos_char *)in);
+    if (ret)
+      fail("Replay failed", ret);
+    clock_t start = clock();
+    unsigned long samples = drain(i == 0 ? raw : NULL);
+    printf("run %i: %lu samples, %.2f ms\n", i + 1, samples, ms_since(start));
+  }
+  if (raw)
+    fclose(raw);
+  return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+  if (argc == 7 && strcmp(argv[3], "capture") == 0)
+  {
+    init_engine(argv[1], argv[2]);
+    return capture(argv[4], argv[5], argv[6]);
+  }
+  if (argc >= 5 && strcmp(argv[3], "replay") == 0)
+  {
+    init_engine(argv[1], argv[2]);
+    return replay(argv[4], argc > 5 ? atoi(argv[5]) : 1,
+                  argc > 6 ? argv[6] : NULL);
+  }
+  fprintf(stderr,
+    "usage: %s <ta.bin> <sg.bin> capture <unit> <text.txt> <out.pici>\n"
+    "       %s <ta.bin> <sg.bin> replay <in.pici> [runs] [out.raw]\n",
+    argv[0], argv[0]);
+  return 2;
+}
@@ -0,0 +1,445 @@
+/* Records which parts of the resources the pico engine reads while setting
+ * up and speaking a corpus, as an access profile (see
+ * src/picotts_profile.h) for picotts_prefetch() on the ESP32, and uses
+ * such a profile to warm up resources mapped from files on a host.
+ *
+ * The resources are mapped from their files with all pages protected; the
+ * first read of a page faults, and the fault handler records the page and
+ * allows reading it. The pages are protected again before each text of the
+ * corpus, to count the texts reading each page.
+ *
+ *   cc -O2 -Isrc -Isrc/pico tools/picotts_profile.c src/esp_picorsrc.c \
+ *      src/pico/pico*.c -lm -o picotts_profile
+ *
+ * usage:
+ *   picotts_profile model/en-US_ta.bin model/en-US_lh0_sg.bin \
+ *      record corpus.txt en-US.prof
+ *   picotts_profile model/en-US_ta.bin model/en-US_lh0_sg.bin \
+ *      say en-US.prof "Hello world."
+ *
+ * The corpus has one text per line. Say drops the resource files from the
+ * page cache, as after a reboot, maps them and prefetches the pages listed
+ * in the profile (or none, if the profile is given as '-'), then times the
+ * set up and speaking the text.
+ *
+ * The profile depends on the build options of the pico sources, e.g.
+ * -DPICOKPDF_PREDECODE reads all of the pdfs while setting up.
+ */
+#define _GNU_SOURCE
+#include "picotts_profile.h"
+#include "picoapi.h"
+#include "esp_picorsrc.h"
+#include "picoos.h"
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#if !defined(MEM_SIZE)
+#define MEM_SIZE 2500000
+#endif
+
+#define MAX_TEXT 4096
+
+typedef struct
+{
+  const char *file;
+  uint8_t *base;
+  size_t size;
+  uint32_t blocks;        // pages in the mapping
+  uint32_t *order;        // pages in order of first read
+  uint32_t used;
+  uint32_t *hits;         // per page, texts reading it
+  bool *seen;
+} resource_t;
+
+static const pico_Char voiceName[] = "ProfileVoice";
+
+static resource_t resource[2];
+static size_t pageSize;
+static unsigned pageShift;
+static bool counting;
+
+static pico_System sys;
+static pico_Resource res[2];
+static pico_Engine engine;
+
+
+picoos_double picoos_quick_exp(const picoos_double y)
+{
+  return exp(y);
+}
+
+
+static void fail(const char *what, int code)
+{
+  pico_Retstring msg;
+  msg[0] = 0;
+  if (sys)
+    pico_getSystemStatusMessage(sys, code, msg);
+  fprintf(stderr, "%s (%i): %s\n", what, code, msg);
+  exit(1);
+}
+
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+}
+
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+  put_u16(p, v);
+  put_u16(p + 2, v >> 16);
+}
+
+
+static double ms_since(const struct timeval *start)
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return (now.tv_sec - start->tv_sec) * 1000.0 +
+    (now.tv_usec - start->tv_usec) / 1000.0;
+}
+
+
+// Maps a resource file read only; with drop, evicts it from the page cache
+// first.
+static void map_file(resource_t *r, bool drop)
+{
+  int fd = open(r->file, O_RDONLY);
+  if (fd < 0)
+  {
+    perror(r->file);
+    exit(1);
+  }
+  r->size = lseek(fd, 0, SEEK_END);
+  if (drop)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  r->base = mmap(NULL, r->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (r->base == MAP_FAILED)
+  {
+    perror(r->file);
+    exit(1);
+  }
+  r->blocks = (r->size + pageSize - 1) >> pageShift;
+}
+
+
+static void on_fault(int sig, siginfo_t *info, void *uc)
+{
+  uint8_t *addr = info->si_addr;
+  (void)uc;
+  for (int i = 0; i < 2; ++i)
+  {
+    resource_t *r = &resource[i];
+    if (addr < r->base || addr >= r->base + r->size)
+      continue;
+    uint32_t block = (addr - r->base) >> pageShift;
+    if (!r->seen[block])
+    {
+      r->seen[block] = true;
+      r->order[r->used++] = block;
+    }
+    if (counting)
+      ++r->hits[block];
+    mprotect(r->base + ((size_t)block << pageShift), pageSize, PROT_READ);
+    return;
+  }
+  // not ours; crash as usual on returning
+  signal(sig, SIG_DFL);
+}
+
+
+static void protect(void)
+{
+  for (int i = 0; i < 2; ++i)
+    mprotect(resource[i].base, resource[i].size, PROT_NONE);
+}
+
+
+static void setup(void)
+{
+  static void *mem;
+  pico_Retstring name;
+
+  if (!mem && !(mem = malloc(MEM_SIZE)))
+    fail("Out of memory", 0);
+  int ret = pico_initialize(mem, MEM_SIZE, &sys);
+  if (ret)
+    fail("Initialize failed", ret);
+  for (int i = 0; i < 2; ++i)
+  {
+    ret = esp_pico_loadResource(sys, resource[i].base, resource[i].size, &res[i]);
+    if (ret)
+      fail("Load resource failed", ret);
+  }
+  ret = pico_createVoiceDefinition(sys, voiceName);
+  for (int i = 0; i < 2 && !ret; ++i)
+  {
+    ret = pico_getResourceName(sys, res[i], name);
+    if (!ret)
+      ret = pico_addResourceToVoiceDefinition(
+        sys, voiceName, (const pico_Char *)name);
+  }
+  if (!ret)
+    ret = pico_newEngine(sys, voiceName, &engine);
+  if (ret)
+    fail("Set up failed", ret);
+}
+
+
+// Speaks text, which ends in a zero byte; returns the samples produced.
+static unsigned long speak(const char *text)
+{
+  unsigned long samples = 0;
+  int len = strlen(text) + 1;
+  const pico_Char *p = (const pico_Char *)text;
+  while (len > 0)
+  {
+    pico_Int16 put = 0;
+    int status = pico_putTextUtf8(engine, p, len, &put);
+    if (status)
+      fail("Put text failed", status);
+    p += put;
+    len -= put;
+    do {
+      int16_t buf[128];
+      pico_Int16 bytes = 0, type = 0;
+      status = pico_getData(engine, buf, sizeof(buf), &bytes, &type);
+      if (bytes > 0)
+        samples += bytes / 2;
+    } while (status == PICO_STEP_BUSY);
+    if (status != PICO_STEP_IDLE)
+      fail("Get data failed", status);
+  }
+  return samples;
+}
+
+
+static int record(const char *corpusFile, const char *out)
+{
+  FILE *corpus = fopen(corpusFile, "r");
+  if (!corpus)
+  {
+    perror(corpusFile);
+    return 1;
+  }
+  for (int i = 0; i < 2; ++i)
+  {
+    resource_t *r = &resource[i];
+    map_file(r, false);
+    r->order = calloc(r->blocks, sizeof(*r->order));
+    r->hits = calloc(r->blocks, sizeof(*r->hits));
+    r->seen = calloc(r->blocks, sizeof(*r->seen));
+    if (!r->order || !r->hits || !r->seen)
+      fail("Out of memory", 0);
+  }
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = on_fault;
+  sa.sa_flags = SA_SIGINFO;
+  sigaction(SIGSEGV, &sa, NULL);
+  sigaction(SIGBUS, &sa, NULL);
+
+  protect();
+  setup();
+  counting = true;
+  uint32_t texts = 0;
+  static char line[MAX_TEXT];
+  while (fgets(line, sizeof(line), corpus))
+  {
+    line[strcspn(line, "\r\n")] = 0;
+    if (!line[0])
+      continue;
+    protect();
+    speak(line);
+    ++texts;
+  }
+  counting = false;
+  fclose(corpus);
+  signal(SIGSEGV, SIG_DFL);
+  signal(SIGBUS, SIG_DFL);
+  for (int i = 0; i < 2; ++i)
+    mprotect(resource[i].base, resource[i].size, PROT_READ);
+
+  size_t size = sizeof(picotts_profile_header_t) +
+    2 * sizeof(picotts_profile_resource_t);
+  for (int i = 0; i < 2; ++i)
+    size += resource[i].used * sizeof(picotts_profile_block_t);
+  uint8_t *prof = calloc(1, size);
+  if (!prof)
+    fail("Out of memory", 0);
+  put_u32(prof, PICOTTS_PROFILE_MAGIC);
+  put_u16(prof + 4, PICOTTS_PROFILE_VERSION);
+  put_u16(prof + 6, pageShift);
+  put_u32(prof + 8, 2);
+  put_u32(prof + 12, texts);
+  put_u32(prof + 16, size);
+  uint8_t *entry = prof + sizeof(picotts_profile_header_t);
+  size_t pos = sizeof(picotts_profile_header_t) +
+    2 * sizeof(picotts_profile_resource_t);
+  for (int i = 0; i < 2; ++i)
+  {
+    resource_t *r = &resource[i];
+    uint32_t common = 0;
+    put_u32(entry, picotts_profile_key(r->base));
+    put_u32(entry + 4, r->size);
+    put_u32(entry + 8, pos);
+    put_u32(entry + 12, r->used);
+    entry += sizeof(picotts_profile_resource_t);
+    for (uint32_t j = 0; j < r->used; ++j)
+    {
+      put_u32(prof + pos, r->order[j]);
+      put_u32(prof + pos + 4, r->hits[r->order[j]]);
+      pos += sizeof(picotts_profile_block_t);
+      if (texts && r->hits[r->order[j]] == texts)
+        ++common;
+    }
+    printf("%s: %u of %u pages read, %u by every text\n",
+      r->file, r->used, r->blocks, common);
+  }
+  printf("%u texts\n", texts);
+
+  FILE *f = fopen(out, "wb");
+  if (!f || fwrite(prof, 1, size, f) != size || fclose(f) != 0)
+  {
+    perror(out);
+    remove(out);
+    return 1;
+  }
+  free(prof);
+  return 0;
+}
+
+
+// Reads the pages of r listed in the profile ahead of their use: queues
+// all of them for reading, then waits for them and maps them where the
+// kernel supports it.
+static void prefetch(const uint8_t *prof, const resource_t *r)
+{
+  const picotts_profile_resource_t *entry = picotts_profile_find(prof, r->base);
+  if (!entry)
+  {
+    fprintf(stderr, "%s: not in the profile\n", r->file);
+    return;
+  }
+  const picotts_profile_block_t *blocks = picotts_profile_blocks(prof, entry);
+  const unsigned shift = ((const picotts_profile_header_t *)prof)->block_shift;
+  for (int advice = 0; advice < 2; ++advice)
+  {
+#if defined(MADV_POPULATE_READ)
+    const int how = advice ? MADV_POPULATE_READ : MADV_WILLNEED;
+#else
+    const int how = MADV_WILLNEED;
+    if (advice)
+      break;
+#endif
+    // runs of consecutive blocks in one call each
+    for (uint32_t i = 0; i < entry->count; )
+    {
+      uint32_t j = i + 1;
+      while (j < entry->count && blocks[j].block == blocks[j - 1].block + 1)
+        ++j;
+      size_t start = (size_t)blocks[i].block << shift;
+      size_t end = (size_t)(blocks[j - 1].block + 1) << shift;
+      start &= ~(pageSize - 1);
+      if (end > r->size)
+        end = r->size;
+      if (start < end)
+        madvise(r->base + start, end - start, how);
+      i = j;
+    }
+  }
+}
+
+
+static long faults(void)
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_minflt + ru.ru_majflt;
+}
+
+
+static int say(const char *profFile, const char *text)
+{
+  struct timeval start;
+  uint8_t *prof = NULL;
+  if (strcmp(profFile, "-") != 0)
+  {
+    FILE *f = fopen(profFile, "rb");
+    if (!f)
+    {
+      perror(profFile);
+      return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    prof = malloc(size);
+    if (!prof || fread(prof, 1, size, f) != (size_t)size)
+      fail("Reading the profile failed", 0);
+    fclose(f);
+  }
+
+  for (int i = 0; i < 2; ++i)
+    map_file(&resource[i], true);
+  if (prof)
+  {
+    gettimeofday(&start, NULL);
+    for (int i = 0; i < 2; ++i)
+      prefetch(prof, &resource[i]);
+    printf("prefetch: %.2f ms\n", ms_since(&start));
+  }
+
+  long before = faults();
+  gettimeofday(&start, NULL);
+  setup();
+  printf("set up: %.2f ms\n", ms_since(&start));
+  for (int n = 1; n <= 2; ++n)
+  {
+    gettimeofday(&start, NULL);
+    unsigned long samples = speak(text);
+    printf("text %i: %.2f ms, %lu samples\n", n, ms_since(&start), samples);
+  }
+  printf("page faults: %ld\n", faults() - before);
+
+  pico_disposeEngine(sys, &engine);
+  pico_releaseVoiceDefinition(sys, voiceName);
+  pico_terminate(&sys);
+  return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+  pageSize = sysconf(_SC_PAGESIZE);
+  while (((size_t)1 << pageShift) < pageSize)
+    ++pageShift;
+  if (argc >= 5)
+  {
+    resource[0].file = argv[1];
+    resource[1].file = argv[2];
+  }
+  if (argc == 6 && strcmp(argv[3], "record") == 0)
+    return record(argv[4], argv[5]);
+  if (argc == 6 && strcmp(argv[3], "say") == 0)
+    return say(argv[4], argv[5]);
+  fprintf(stderr,
+    "usage: %s <ta.bin> <sg.bin> record <corpus.txt> <out.prof>\n"
+    "       %s <ta.bin> <sg.bin> say <in.prof|-> <text>\n",
+    argv[0], argv[0]);
+  return 2;
+}
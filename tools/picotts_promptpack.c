@@ -0,0 +1,286 @@
+/* Renders a list of prompts into a prompt pack for picotts_say().
+ *
+ * Reads one prompt per line (UTF8; empty lines and lines starting with '#'
+ * are skipped), synthesises each with the pico engine and writes the pack
+ * described in src/picotts_pack.h. Prompts which are the same after
+ * normalising are rendered once. Prompts longer than
+ * CONFIG_PICOTTS_PROMPT_MAX_LEN are rejected, as picotts_say() never looks
+ * them up; build with the same -DCONFIG_PICOTTS_PROMPT_MAX_LEN as the
+ * firmware if it sets another one.
+ *
+ * build (add -DPICODSP_NARROWBAND for packs of 8kHz firmware):
+ *   cc -O2 -Isrc -Isrc/pico tools/picotts_promptpack.c src/pico/pico*.c -lm \
+ *      -lpthread -o picotts_promptpack
+ *
+ * usage:
+ *   picotts_promptpack model/en-US_ta.bin model/en-US_lh0_sg.bin \
+ *      prompts.txt prompts.bin
+ *
+ * Flash prompts.bin to the partition named by CONFIG_PICOTTS_PROMPT_PARTITION
+ * (e.g. with parttool.py) and call picotts_map_prompt_pack(NULL) after
+ * picotts_init().
+ */
+#include "picotts.h"
+#include "picotts_pack.h"
+#include "picoapi.h"
+#include "picoos.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef PICODSP_NARROWBAND
+#define SAMPLE_RATE 8000
+#else
+#define SAMPLE_RATE 16000
+#endif
+
+#define MEM_SIZE     4000000
+#define MAX_LINE_LEN 4096
+
+typedef struct
+{
+  uint32_t hash;
+  uint8_t *text;
+  unsigned text_len;
+  int16_t *samples;
+  unsigned count;
+  unsigned max;
+} prompt_t;
+
+static pico_System   picoSystem;
+static pico_Engine   picoEngine;
+
+static const pico_Char voiceName[] = "PromptVoice";
+
+
+picoos_double picoos_quick_exp(const picoos_double y)
+{
+  return exp(y);
+}
+
+
+static void fail(const char *what, int code)
+{
+  pico_Retstring msg;
+  msg[0] = 0;
+  if (picoSystem)
+    pico_getSystemStatusMessage(picoSystem, code, msg);
+  fprintf(stderr, "%s (%i): %s\n", what, code, msg);
+  exit(1);
+}
+
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+}
+
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+  put_u16(p, v);
+  put_u16(p + 2, v >> 16);
+}
+
+
+// Feeds text to the engine, appending the audio produced meanwhile to p.
+static void feed(prompt_t *p, const pico_Char *text, unsigned len)
+{
+  while (len)
+  {
+    pico_Int16 processed = 0;
+    int status = pico_putTextUtf8(picoEngine, text, len, &processed);
+    if (status)
+      fail("Put text failed", status);
+    text += processed;
+    len -= processed;
+    do {
+      int16_t outbuf[128];
+      pico_Int16 bytes = 0, type = 0;
+      status =
+        pico_getData(picoEngine, outbuf, sizeof(outbuf), &bytes, &type);
+      if (bytes > 0)
+      {
+        if (p->count + bytes/2 > p->max)
+        {
+          p->max = p->max ? p->max * 2 : 16384;
+          p->samples = realloc(p->samples, p->max * sizeof(int16_t));
+          if (!p->samples)
+            fail("Out of memory", 0);
+        }
+        memcpy(p->samples + p->count, outbuf, bytes);
+        p->count += bytes/2;
+      }
+    } while (status == PICO_STEP_BUSY);
+    if (status != PICO_STEP_IDLE)
+      fail("Get data failed", status);
+  }
+}
+
+
+static void render(prompt_t *p)
+{
+  static const pico_Char end = 0;
+
+  p->samples = NULL;
+  p->count = p->max = 0;
+  feed(p, p->text, p->text_len);
+  // terminate the prompt, so that it is spoken on its own
+  feed(p, &end, 1);
+  // and start the next one from a clean engine
+  int status = pico_resetEngine(picoEngine, PICO_RESET_SOFT);
+  if (status)
+    fail("Reset failed", status);
+}
+
+
+static int by_hash(const void *a, const void *b)
+{
+  const prompt_t *pa = a, *pb = b;
+  return (pa->hash > pb->hash) - (pa->hash < pb->hash);
+}
+
+
+static void init_engine(const char *ta, const char *sg)
+{
+  pico_Resource res;
+  pico_Retstring name;
+  const char *files[2] = { ta, sg };
+
+  void *mem = malloc(MEM_SIZE);
+  if (!mem)
+    fail("Out of memory", 0);
+  int ret = pico_initialize(mem, MEM_SIZE, &picoSystem);
+  if (ret)
+    fail("Init failed", ret);
+  ret = pico_createVoiceDefinition(picoSystem, voiceName);
+  if (ret)
+    fail("Voice creation failed", ret);
+  for (int i = 0; i < 2; ++i)
+  {
+    ret = pico_loadResource(picoSystem, (const pico_Char *)files[i], &res);
+    if (ret)
+      fail(files[i], ret);
+    ret = pico_getResourceName(picoSystem, res, name);
+    if (!ret)
+      ret = pico_addResourceToVoiceDefinition(
+        picoSystem, voiceName, (const pico_Char *)name);
+    if (ret)
+      fail(files[i], ret);
+  }
+  ret = pico_newEngine(picoSystem, voiceName, &picoEngine);
+  if (ret)
+    fail("Engine creation failed", ret);
+}
+
+
+int main(int argc, char **argv)
+{
+  if (argc != 5)
+  {
+    fprintf(stderr,
+      "usage: %s <ta.bin> <sg.bin> <prompts.txt> <pack.bin>\n", argv[0]);
+    return 2;
+  }
+  init_engine(argv[1], argv[2]);
+
+  FILE *in = fopen(argv[3], "r");
+  if (!in)
+  {
+    perror(argv[3]);
+    return 1;
+  }
+
+  prompt_t *prompts = NULL;
+  unsigned count = 0, max = 0;
+  static char line[MAX_LINE_LEN];
+  unsigned lineno = 0;
+  while (fgets(line, sizeof(line), in))
+  {
+    unsigned len = strcspn(line, "\r\n");
+    ++lineno;
+    uint32_t hash = picotts_pack_key((uint8_t *)line, &len);
+    if (len == 0 || line[0] == '#')
+      continue;
+    if (len > CONFIG_PICOTTS_PROMPT_MAX_LEN)
+    {
+      fprintf(stderr, "%s:%u: prompt longer than %u bytes\n", argv[3], lineno,
+        CONFIG_PICOTTS_PROMPT_MAX_LEN);
+      return 1;
+    }
+
+    unsigned i = 0;
+    while (i < count &&
+           (prompts[i].hash != hash || prompts[i].text_len != len ||
+            memcmp(prompts[i].text, line, len) != 0))
+      ++i;
+    if (i < count)
+      continue;
+
+    if (count == max)
+    {
+      max = max ? max * 2 : 64;
+      prompts = realloc(prompts, max * sizeof(prompt_t));
+      if (!prompts)
+        fail("Out of memory", 0);
+    }
+    prompt_t *p = &prompts[count++];
+    p->hash = hash;
+    p->text_len = len;
+    p->text = malloc(len);
+    if (!p->text)
+      fail("Out of memory", 0);
+    memcpy(p->text, line, len);
+    render(p);
+  }
+  fclose(in);
+
+  qsort(prompts, count, sizeof(prompt_t), by_hash);
+
+  // lay out the header and index, then all texts, then the samples
+  uint32_t offs = sizeof(picotts_pack_header_t) +
+    count * sizeof(picotts_pack_entry_t);
+  uint32_t text_offs = offs;
+  for (unsigned i = 0; i < count; ++i)
+    offs += prompts[i].text_len;
+  offs = (offs + 3) & ~3u;
+  uint32_t sample_offs = offs;
+  for (unsigned i = 0; i < count; ++i)
+    offs += (prompts[i].count * sizeof(int16_t) + 3) & ~3u;
+
+  uint8_t *pack = calloc(1, offs);
+  if (!pack)
+    fail("Out of memory", 0);
+  put_u32(pack, PICOTTS_PACK_MAGIC);
+  put_u16(pack + 4, PICOTTS_PACK_VERSION);
+  put_u16(pack + 6, SAMPLE_RATE);
+  put_u32(pack + 8, count);
+  put_u32(pack + 12, offs);
+  for (unsigned i = 0; i < count; ++i)
+  {
+    const prompt_t *p = &prompts[i];
+    uint8_t *e = pack + sizeof(picotts_pack_header_t) +
+      i * sizeof(picotts_pack_entry_t);
+    put_u32(e, p->hash);
+    put_u32(e + 4, text_offs);
+    put_u32(e + 8, p->text_len);
+    put_u32(e + 12, sample_offs);
+    put_u32(e + 16, p->count);
+    memcpy(pack + text_offs, p->text, p->text_len);
+    text_offs += p->text_len;
+    for (unsigned j = 0; j < p->count; ++j)
+      put_u16(pack + sample_offs + 2 * j, p->samples[j]);
+    sample_offs += (p->count * sizeof(int16_t) + 3) & ~3u;
+  }
+
+  FILE *out = fopen(argv[4], "wb");
+  if (!out || fwrite(pack, 1, offs, out) != offs || fclose(out) != 0)
+  {
+    perror(argv[4]);
+    return 1;
+  }
+  printf("%u prompts, %u bytes\n", count, (unsigned)offs);
+  return 0;
+}
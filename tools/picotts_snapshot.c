@@ -0,0 +1,266 @@
+/* Makes a snapshot of the pico engine after its set up and restores it
+ * (see src/picotts_snapshot.h), e.g. to check that speech from a restored
+ * engine is the same as usual and to time the restore.
+ *
+ * Pointers to code are kept in the snapshot, so it is only valid for the
+ * executable that made it, which has to be built without PIE:
+ *   cc -O2 -no-pie -Isrc -Isrc/pico tools/picotts_snapshot.c \
+ *      src/picotts_snapshot.c src/esp_picorsrc.c src/pico/pico*.c -lm \
+ *      -lpthread -o picotts_snapshot
+ *
+ * usage:
+ *   picotts_snapshot model/en-US_ta.bin model/en-US_lh0_sg.bin \
+ *      make engine.snap
+ *   picotts_snapshot model/en-US_ta.bin model/en-US_lh0_sg.bin \
+ *      say engine.snap "Hello world." [out.raw]
+ *
+ * Say restores the snapshot, or sets up the engine as usual if the
+ * snapshot is given as '-', prints the time taken and speaks the text.
+ */
+#include "picotts_snapshot.h"
+#include "picoapi.h"
+#include "esp_picorsrc.h"
+#include "picoos.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Builds keeping decoded knowledge bases in memory need more
+#if !defined(MEM_SIZE)
+#define MEM_SIZE 2500000
+#endif
+
+enum { ROOT_SYSTEM, ROOT_TA, ROOT_SG, ROOT_ENGINE };
+
+static const pico_Char voiceName[] = "SnapshotVoice";
+
+static void *resource[2];
+static size_t resourceSize[2];
+
+
+picoos_double picoos_quick_exp(const picoos_double y)
+{
+  return exp(y);
+}
+
+
+static void *read_file(const char *name, size_t *size)
+{
+  FILE *f = fopen(name, "rb");
+  if (!f)
+  {
+    perror(name);
+    exit(1);
+  }
+  fseek(f, 0, SEEK_END);
+  *size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  void *data = malloc(*size ? *size : 1);
+  if (!data || fread(data, 1, *size, f) != *size)
+  {
+    fprintf(stderr, "%s: read failed\n", name);
+    exit(1);
+  }
+  fclose(f);
+  return data;
+}
+
+
+static void *copy_of(const void *data, size_t size)
+{
+  void *copy = malloc(size);
+  if (!copy)
+  {
+    fprintf(stderr, "Out of memory\n");
+    exit(1);
+  }
+  return memcpy(copy, data, size);
+}
+
+
+// The set up done by picotts_init(), on the resources in memory. The second
+// pass uses copies of them, so that the pointers to them can be told apart.
+static bool setup(picotts_snapshot_state_t *state, int pass, void *ctx)
+{
+  pico_System sys;
+  pico_Resource res[2];
+  pico_Engine engine;
+  pico_Retstring name;
+  (void)ctx;
+
+  int ret = pico_initialize(state->mem, state->mem_size, &sys);
+  for (int i = 0; i < 2 && !ret; ++i)
+  {
+    state->region[i] = pass ? copy_of(resource[i], resourceSize[i])
+                            : resource[i];
+    state->region_size[i] = resourceSize[i];
+    esp_pico_resource_size(resource[i], &state->region_check_size[i]);
+    ret = esp_pico_loadResource(sys, state->region[i], resourceSize[i], &res[i]);
+  }
+  if (!ret)
+    ret = pico_createVoiceDefinition(sys, voiceName);
+  for (int i = 0; i < 2 && !ret; ++i)
+  {
+    ret = pico_getResourceName(sys, res[i], name);
+    if (!ret)
+      ret = pico_addResourceToVoiceDefinition(
+        sys, voiceName, (const pico_Char *)name);
+  }
+  if (!ret)
+    ret = pico_newEngine(sys, voiceName, &engine);
+  if (ret)
+  {
+    fprintf(stderr, "Set up failed (%i)\n", ret);
+    return false;
+  }
+  state->root[ROOT_SYSTEM] = sys;
+  state->root[ROOT_TA] = res[0];
+  state->root[ROOT_SG] = res[1];
+  state->root[ROOT_ENGINE] = engine;
+  return true;
+}
+
+
+static bool write_file(const void *data, size_t len, size_t offset, void *ctx)
+{
+  FILE *f = ctx;
+  return fseek(f, offset, SEEK_SET) == 0 && fwrite(data, 1, len, f) == len;
+}
+
+
+// Identifies the executable; the code does not move as it is built without
+// PIE.
+static uint32_t build_id(void)
+{
+  return (uint32_t)(uintptr_t)&pico_initialize;
+}
+
+
+static double ms_since(clock_t start)
+{
+  return (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+
+static int make(const char *out)
+{
+  picotts_snapshot_state_t a = { 0 }, b = { 0 };
+  a.mem_size = b.mem_size = MEM_SIZE;
+  a.mem = malloc(MEM_SIZE);
+  b.mem = malloc(MEM_SIZE);
+  FILE *f = fopen(out, "wb");
+  if (!a.mem || !b.mem || !f)
+  {
+    perror(out);
+    return 1;
+  }
+  int ret = picotts_snapshot_make(
+    &a, &b, setup, NULL, build_id(), write_file, f);
+  if (fclose(f) != 0 && ret == PICOTTS_SNAPSHOT_OK)
+    ret = PICOTTS_SNAPSHOT_ERR_WRITE;
+  if (ret != PICOTTS_SNAPSHOT_OK)
+  {
+    fprintf(stderr, "Snapshot failed (%i)\n", ret);
+    remove(out);
+    return 1;
+  }
+  return 0;
+}
+
+
+static int say(const char *snapFile, const char *text, const char *rawFile)
+{
+  picotts_snapshot_state_t state = { 0 };
+  state.mem_size = MEM_SIZE;
+  state.mem = malloc(MEM_SIZE);
+  if (!state.mem)
+    return 1;
+
+  clock_t start = clock();
+  if (strcmp(snapFile, "-") == 0)
+  {
+    if (!setup(&state, 0, NULL))
+      return 1;
+    printf("set up: %.2f ms\n", ms_since(start));
+  }
+  else
+  {
+    size_t size;
+    void *snap = read_file(snapFile, &size);
+    for (int i = 0; i < 2; ++i)
+    {
+      // elsewhere than when the snapshot was made
+      state.region[i] = copy_of(resource[i], resourceSize[i]);
+      state.region_size[i] = resourceSize[i];
+    }
+    start = clock();
+    int ret = picotts_snapshot_restore(snap, size, build_id(), &state);
+    if (ret != PICOTTS_SNAPSHOT_OK)
+    {
+      fprintf(stderr, "Restore failed (%i)\n", ret);
+      return 1;
+    }
+    printf("restore: %.2f ms\n", ms_since(start));
+  }
+
+  pico_System sys = state.root[ROOT_SYSTEM];
+  pico_Engine engine = state.root[ROOT_ENGINE];
+  FILE *raw = rawFile ? fopen(rawFile, "wb") : NULL;
+  unsigned long samples = 0;
+  int len = strlen(text) + 1;
+  const pico_Char *p = (const pico_Char *)text;
+  int status = PICO_STEP_IDLE;
+  while (len > 0 && status == PICO_STEP_IDLE)
+  {
+    pico_Int16 put = 0;
+    if (pico_putTextUtf8(engine, p, len, &put))
+      break;
+    p += put;
+    len -= put;
+    do {
+      int16_t buf[128];
+      pico_Int16 bytes = 0, type = 0;
+      status = pico_getData(engine, buf, sizeof(buf), &bytes, &type);
+      if (bytes > 0)
+      {
+        samples += bytes / 2;
+        if (raw)
+          fwrite(buf, 1, bytes, raw);
+      }
+    } while (status == PICO_STEP_BUSY);
+  }
+  if (raw)
+    fclose(raw);
+  printf("%lu samples\n", samples);
+  if (len > 0 || status != PICO_STEP_IDLE)
+  {
+    fprintf(stderr, "Synthesis failed\n");
+    return 1;
+  }
+
+  pico_disposeEngine(sys, &engine);
+  pico_releaseVoiceDefinition(sys, voiceName);
+  pico_terminate(&sys);
+  return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+  if (argc >= 5)
+  {
+    resource[0] = read_file(argv[1], &resourceSize[0]);
+    resource[1] = read_file(argv[2], &resourceSize[1]);
+  }
+  if (argc == 5 && strcmp(argv[3], "make") == 0)
+    return make(argv[4]);
+  if ((argc == 6 || argc == 7) && strcmp(argv[3], "say") == 0)
+    return say(argv[4], argv[5], argc > 6 ? argv[6] : NULL);
+  fprintf(stderr,
+    "usage: %s <ta.bin> <sg.bin> make <out.snap>\n"
+    "       %s <ta.bin> <sg.bin> say <in.snap|-> <text> [out.raw]\n",
+    argv[0], argv[0]);
+  return 2;
+}